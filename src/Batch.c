@@ -0,0 +1,333 @@
+#include <SDL.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "EdBoy.h"
+
+/*	Batch executor. A pool of worker threads runs many independent systems at once, each for its own number of frames.
+*	Work is split into tasks of running one instance for up to BATCH_TASK_FRAMES frames. A task that leaves frames to run
+*	pushes its instance back onto its worker's deque, so each instance stays on one core's caches while that worker is busy.
+*
+*	Each worker owns a Chase-Lev work-stealing deque of instance indices. The owner pushes and takes at the bottom without locking,
+*	and a worker whose deque is empty steals from the top of a randomly chosen other deque. Instances are only ever in one deque,
+*	so no deque holds more tasks than there are instances, and the deques never grow.
+*/
+
+//Defines the indices of one worker's deque. Its tasks are held in the executor's slots, at the worker's index times the slot capacity.
+struct BatchDeque {
+	atomic_int top; //Index of the oldest task. Advanced by thieves, and by the owner taking the last task.
+	char topPadding[64]; //Keeps top and bottom on separate cache lines
+	atomic_int bottom; //Index one past the newest task. Written only by the owner.
+	char bottomPadding[64];
+};
+
+//Defines the state of one worker thread
+struct BatchWorker {
+	struct BatchExecutor *batch; //Executor the worker belongs to
+	SDL_Thread *thread; //Worker thread. NULL if not started.
+	unsigned index; //Index of worker in executor
+	uint32_t seed; //State of the random number generator choosing which deque to steal from
+	struct BatchDeque deque; //Tasks to be run by this worker, unless stolen
+
+	/* Counted by the worker during a batch, and read once it is done */
+	uint64_t frames; //Number of frames run
+	uint64_t tasks; //Number of tasks run
+	uint64_t steals; //Number of tasks stolen
+	char padding[64]; //Keeps the next worker's deque off this worker's counters
+};
+
+//Defines the state of a pool of worker threads and the batch it is running
+struct BatchExecutor {
+	unsigned workerCount; //Number of worker threads
+	struct BatchWorker *workers; //State of each worker
+	SDL_sem *startBatch; //Posted once per worker when a batch starts, and upon stopping
+	SDL_sem *batchDone; //Posted by each worker once no instance of the batch is left to run
+	atomic_bool isStopping; //Set when the workers should exit
+
+	struct BatchInstance *instances; //Instances of the current batch
+	atomic_uint *slots; //Storage of every deque's tasks, capacity slots per worker
+	unsigned capacity; //Number of slots per deque. A power of two, and at least the number of instances.
+	char padding[64]; //Keeps the counter below off the fields above, which are read-only during a batch
+	atomic_uint remaining; //Number of instances of the current batch yet to finish
+};
+
+/* Returns the next number from the given worker's xorshift generator. */
+static uint32_t Next_Random( struct BatchWorker *worker ) {
+	uint32_t x = worker->seed; //Generator state
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	worker->seed = x;
+
+	return x;
+}//end function Next_Random
+
+/* Returns the slot holding the task at the given index of the given worker's deque. */
+static atomic_uint *Task_Slot( struct BatchWorker *worker, int index ) {
+	struct BatchExecutor *batch = worker->batch; //Executor holding the slots
+
+	return &( batch->slots[(size_t)worker->index * batch->capacity + ( (unsigned)index & ( batch->capacity - 1 ) )] );
+}//end function Task_Slot
+
+/* Pushes the given instance index onto the bottom of the given worker's deque. Called only by the deque's owner, or before the batch starts. */
+static void Push_Task( struct BatchWorker *worker, unsigned task ) {
+	int bottom = atomic_load_explicit( &( worker->deque.bottom ), memory_order_relaxed ); //Index of new task
+
+	atomic_store_explicit( Task_Slot( worker, bottom ), task, memory_order_relaxed );
+	atomic_thread_fence( memory_order_release );
+	atomic_store_explicit( &( worker->deque.bottom ), bottom + 1, memory_order_relaxed );
+
+	return;
+}//end function Push_Task
+
+/* Takes the newest task from the bottom of the given worker's own deque. Returns its instance index, or -1 if the deque is empty. */
+static long Take_Task( struct BatchWorker *worker ) {
+	int bottom = atomic_load_explicit( &( worker->deque.bottom ), memory_order_relaxed ) - 1; //Index of task being taken
+	int top; //Index of oldest task
+	long task = -1; //Task taken
+
+	atomic_store_explicit( &( worker->deque.bottom ), bottom, memory_order_relaxed );
+	atomic_thread_fence( memory_order_seq_cst );
+	top = atomic_load_explicit( &( worker->deque.top ), memory_order_relaxed );
+
+	if ( top <= bottom ) {
+		task = atomic_load_explicit( Task_Slot( worker, bottom ), memory_order_relaxed );
+
+		//The last task may be contended by a thief. Whoever advances top takes it.
+		if ( top == bottom ) {
+			if ( !atomic_compare_exchange_strong_explicit( &( worker->deque.top ), &top, top + 1, memory_order_seq_cst, memory_order_relaxed ) ) task = -1;
+			atomic_store_explicit( &( worker->deque.bottom ), bottom + 1, memory_order_relaxed );
+		}//end if
+	}//end if
+	else atomic_store_explicit( &( worker->deque.bottom ), bottom + 1, memory_order_relaxed );
+
+	return task;
+}//end function Take_Task
+
+/* Steals the oldest task from the top of the given victim's deque. Returns its instance index, or -1 if the deque is empty or another worker took it first. */
+static long Steal_From( struct BatchWorker *victim ) {
+	int top = atomic_load_explicit( &( victim->deque.top ), memory_order_acquire ); //Index of task being stolen
+	int bottom; //Index one past newest task
+	long task; //Task stolen
+
+	atomic_thread_fence( memory_order_seq_cst );
+	bottom = atomic_load_explicit( &( victim->deque.bottom ), memory_order_acquire );
+	if ( top >= bottom ) return -1;
+
+	task = atomic_load_explicit( Task_Slot( victim, top ), memory_order_relaxed );
+	if ( !atomic_compare_exchange_strong_explicit( &( victim->deque.top ), &top, top + 1, memory_order_seq_cst, memory_order_relaxed ) ) return -1;
+
+	return task;
+}//end function Steal_From
+
+/* Steals a task for the given worker, trying every other worker's deque once, starting from a random one. Returns its instance index, or -1 if none was found. */
+static long Steal_Task( struct BatchWorker *worker ) {
+	struct BatchExecutor *batch = worker->batch; //Executor of the workers stolen from
+	unsigned start = Next_Random( worker ) % batch->workerCount; //Index of first worker tried
+
+	for ( unsigned n = 0; n < batch->workerCount; ++n ) {
+		struct BatchWorker *victim = &( batch->workers[( start + n ) % batch->workerCount] ); //Worker being stolen from
+		long task; //Task stolen
+
+		if ( victim == worker ) continue;
+
+		task = Steal_From( victim );
+		if ( task >= 0 ) {
+			worker->steals += 1;
+			return task;
+		}//end if
+	}//end for
+
+	return -1;
+}//end function Steal_Task
+
+/* Runs the given instance for up to BATCH_TASK_FRAMES frames. Returns true if it has finished its run, or quit mid-frame. */
+static bool Run_Task( struct BatchWorker *worker, struct BatchInstance *instance ) {
+	unsigned endFrame = instance->frameCount - instance->framesRun > BATCH_TASK_FRAMES ? instance->framesRun + BATCH_TASK_FRAMES : instance->frameCount; //Frame the task stops before
+
+	while ( instance->framesRun < endFrame ) {
+		if ( GB_Run_Frame( instance->gb, instance->inputs ? instance->inputs[instance->framesRun] : 0 ) ) {
+			instance->didQuit = true;
+			return true;
+		}//end if
+
+		instance->framesRun += 1;
+		worker->frames += 1;
+	}//end while
+
+	return instance->framesRun == instance->frameCount;
+}//end function Run_Task
+
+/*	Runs tasks of each batch until every instance has finished, taking from the worker's own deque first, and stealing once it is empty.
+*	Sleeps between batches, and briefly whenever no task can be found while others are still running.
+*/
+static int Batch_Worker_Thread( void *data ) {
+	struct BatchWorker *worker = data; //Worker being run
+	struct BatchExecutor *batch = worker->batch; //Executor the worker belongs to
+
+	while ( true ) {
+		SDL_SemWait( batch->startBatch );
+		if ( atomic_load( &( batch->isStopping ) ) ) break;
+
+		while ( atomic_load_explicit( &( batch->remaining ), memory_order_acquire ) ) {
+			long task = Take_Task( worker ); //Instance index of task being run
+
+			if ( task < 0 ) task = Steal_Task( worker );
+			if ( task < 0 ) {
+				SDL_Delay( 1 );
+				continue;
+			}//end if
+
+			worker->tasks += 1;
+			if ( Run_Task( worker, &( batch->instances[task] ) ) ) atomic_fetch_sub_explicit( &( batch->remaining ), 1, memory_order_release );
+			else Push_Task( worker, (unsigned)task );
+		}//end while
+
+		SDL_SemPost( batch->batchDone );
+	}//end while
+
+	return 0;
+}//end function Batch_Worker_Thread
+
+/*	Starts a batch executor with the given number of worker threads. If 0, starts one per logical CPU.
+*	Returns the executor, or NULL if it could not be started.
+*/
+struct BatchExecutor *Start_Batch_Executor( unsigned workerCount ) {
+	struct BatchExecutor *batch; //New executor
+
+	if ( !workerCount ) workerCount = SDL_GetCPUCount() > 0 ? (unsigned)SDL_GetCPUCount() : 1;
+
+	batch = calloc( 1, sizeof( struct BatchExecutor ) );
+	if ( !batch ) {
+		eprintf( "Unable to allocate batch executor.\n" );
+		return NULL;
+	}//end if
+
+	batch->workerCount = workerCount;
+	atomic_init( &( batch->isStopping ), false );
+	atomic_init( &( batch->remaining ), 0 );
+
+	batch->workers = calloc( workerCount, sizeof( struct BatchWorker ) );
+	batch->startBatch = SDL_CreateSemaphore( 0 );
+	batch->batchDone = SDL_CreateSemaphore( 0 );
+	if ( !( batch->workers ) || !( batch->startBatch ) || !( batch->batchDone ) ) {
+		eprintf( "Unable to allocate batch executor.\n" );
+
+		Stop_Batch_Executor( batch );
+		return NULL;
+	}//end if
+
+	for ( unsigned i = 0; i < workerCount; ++i ) {
+		struct BatchWorker *worker = &( batch->workers[i] ); //Worker being started
+
+		worker->batch = batch;
+		worker->index = i;
+		worker->seed = 0x9E3779B9u * ( i + 1 );
+		atomic_init( &( worker->deque.top ), 0 );
+		atomic_init( &( worker->deque.bottom ), 0 );
+
+		worker->thread = SDL_CreateThread( Batch_Worker_Thread, "EdBoy Batch Worker", worker );
+		if ( !( worker->thread ) ) {
+			eprintf( "Unable to start batch worker thread: %s\n", SDL_GetError() );
+
+			Stop_Batch_Executor( batch );
+			return NULL;
+		}//end if
+	}//end for
+
+	dprintf( "Batch executor started with %u workers.\n", workerCount );
+
+	return batch;
+}//end function Start_Batch_Executor
+
+/* Stops the given batch executor's worker threads, then frees it. Must not be called while a batch is running. */
+void Stop_Batch_Executor( struct BatchExecutor *batch ) {
+	if ( !batch ) return;
+
+	atomic_store( &( batch->isStopping ), true );
+	if ( batch->workers ) {
+		for ( unsigned i = 0; i < batch->workerCount; ++i )
+			if ( batch->workers[i].thread ) SDL_SemPost( batch->startBatch );
+		for ( unsigned i = 0; i < batch->workerCount; ++i )
+			if ( batch->workers[i].thread ) SDL_WaitThread( batch->workers[i].thread, NULL );
+	}//end if
+
+	if ( batch->startBatch ) SDL_DestroySemaphore( batch->startBatch );
+	if ( batch->batchDone ) SDL_DestroySemaphore( batch->batchDone );
+	free( batch->slots );
+	free( batch->workers );
+	free( batch );
+
+	return;
+}//end function Stop_Batch_Executor
+
+/*	Runs each of the given instances for its number of frames on the given executor's workers, and returns once all have finished.
+*	Instances are dealt out across the workers' deques in turn, and rebalanced by stealing. Each instance's progress is written back to it,
+*	and aggregate statistics to stats. Instances must not share a system, and may be run on any worker, so their callbacks must not assume a thread.
+*	Returns 0 if successful. Else, returns 1 if unable to allocate the deques, in which case no instance is run.
+*/
+int Run_Batch( struct BatchExecutor *batch, struct BatchInstance *instances, unsigned count, struct BatchStats *stats ) {
+	uint64_t startTicks; //Performance counter value when the batch started
+	unsigned capacity = 1; //Number of slots needed per deque
+	unsigned runCount = 0; //Number of instances with frames to run
+
+	while ( capacity < count )
+		capacity <<= 1;
+
+	//Grow the deques, if needed. They are only touched by the workers during a batch.
+	if ( capacity > batch->capacity ) {
+		atomic_uint *slots = realloc( batch->slots, (size_t)capacity * batch->workerCount * sizeof( atomic_uint ) ); //Grown storage
+
+		if ( !slots ) {
+			eprintf( "Unable to allocate batch deques.\n" );
+			return 1;
+		}//end if
+
+		batch->slots = slots;
+		batch->capacity = capacity;
+	}//end if
+
+	memset( stats, 0, sizeof( struct BatchStats ) );
+	for ( unsigned i = 0; i < batch->workerCount; ++i ) {
+		struct BatchWorker *worker = &( batch->workers[i] ); //Worker being reset
+
+		atomic_store( &( worker->deque.top ), 0 );
+		atomic_store( &( worker->deque.bottom ), 0 );
+		worker->frames = 0;
+		worker->tasks = 0;
+		worker->steals = 0;
+	}//end for
+
+	//Deal instances out to the workers in turn. The workers are asleep, so this thread may push onto their deques.
+	batch->instances = instances;
+	for ( unsigned i = 0; i < count; ++i ) {
+		instances[i].framesRun = 0;
+		instances[i].didQuit = false;
+		if ( !( instances[i].frameCount ) ) continue;
+
+		Push_Task( &( batch->workers[runCount % batch->workerCount] ), i );
+		++runCount;
+	}//end for
+	atomic_store( &( batch->remaining ), runCount );
+
+	//Wake every worker, and wait for each to run out of work
+	startTicks = SDL_GetPerformanceCounter();
+	for ( unsigned i = 0; i < batch->workerCount; ++i )
+		SDL_SemPost( batch->startBatch );
+	for ( unsigned i = 0; i < batch->workerCount; ++i )
+		SDL_SemWait( batch->batchDone );
+	stats->seconds = (double)( SDL_GetPerformanceCounter() - startTicks ) / (double)SDL_GetPerformanceFrequency();
+
+	for ( unsigned i = 0; i < batch->workerCount; ++i ) {
+		stats->frames += batch->workers[i].frames;
+		stats->tasks += batch->workers[i].tasks;
+		stats->steals += batch->workers[i].steals;
+	}//end for
+	stats->framesPerSecond = stats->seconds > 0.0 ? stats->frames / stats->seconds : 0.0;
+	batch->instances = NULL;
+
+	return 0;
+}//end function Run_Batch
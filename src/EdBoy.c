@@ -1,5 +1,7 @@
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <SDL.h>
 
 #include "EdBoy.h"
@@ -21,8 +23,9 @@ int main( int argc, char *argv[] ) {
 	char *romPath; //File system path to the Game Boy ROM to be loaded
 	char *bootromPath; //File system path to the Game Boy Boot ROM to be used
 	SDL_Window *windows[2]; //Stores ptrs to SDL window structures. [0] = main emulator, [1] = VRAM BG Tiles
-	SDL_Surface *surfaces[2]; //Stores ptrs to final SDL window surfaces.
+	struct EmulatorScreen screen; //Renderer and streaming texture presenting the LCD in the main emulator window
 	SDL_Event event; //SDL Event handler for closing windows and keyboard input
+	bool hasEvent; //Whether event holds an unhandled event
 	const uint8_t *currKeyStates; //Stores current states of keyboard keys
 	bool doFrameStep = true; //Toggles whether emulator is run in real time or frame step mode.
 	bool isPressedFrameStep[8]; //Stores toggles for whether a given button on the Game Boy is to be press during a frame of frame-step mode
@@ -30,11 +33,65 @@ int main( int argc, char *argv[] ) {
 	bool fsJustPressed = false; //Used for debouncing frame-step toggle
 	bool faJustPressed = false; //Used for debouncing frame-advance button
 	bool didQuit = false; //Stores whether user wishes to close the emulator
+	struct GB_TraceLogger *traceLogger; //Decodes trace records into text on stdout. NULL if not tracing.
+	struct SaveFlusher *saveFlusher; //Periodically writes back the save file. NULL if the cartridge has no battery.
+	struct EmulatorThread *emulator; //Runs the Game Boy system on its own thread, apart from event handling and presentation
+	struct EmulatorInput input; //Input snapshot for the emulation thread, built each pass of the main loop
+	struct EmulatorInput sentInput = { 0, true, false, false, 0, false, 0 }; //Input snapshot last sent to the emulation thread
+	uint8_t speed = 1; //Frame rate multiplier of full-speed mode. 0 if unlimited.
+	uint8_t runAhead = 0; //Number of frames full-speed mode runs ahead of the displayed frame
+	bool raJustPressed = false; //Used for debouncing run-ahead toggle
+	const uint8_t *frame; //Newest complete LCD frame from the emulation thread. NULL if none since last presented.
+
+	//Run headless if requested: EdBoy --headless <ROM path> <Boot ROM path> <frame count>
+	if ( argc > 1 && !strcmp( argv[1], "--headless" ) ) {
+		char *countEnd; //End of parsed frame count argument
+		unsigned long frameCount; //Number of frames to run headless
+
+		if ( argc != 5 ) {
+			eprintf( "Usage: %s --headless <ROM path> <Boot ROM path> <frame count>\n", argv[0] );
+			return 1;
+		}//end if
+
+		frameCount = strtoul( argv[4], &countEnd, 10 );
+		if ( *countEnd != '\0' || countEnd == argv[4] ) {
+			eprintf( "Invalid frame count \"%s\"\n", argv[4] );
+			return 1;
+		}//end if
+
+		return Run_Headless( argv[2], argv[3], frameCount );
+	}//end if
 
-	//Get ROM and Boot ROM paths
-	//TODO: Hardcoded for now
-	romPath = "./roms/tetris.gb";
-	bootromPath = "./roms/dmg_boot.bin";
+	//Run a headless batch if requested: EdBoy --batch <ROM path> <Boot ROM path> <instance count> <frame count>
+	if ( argc > 1 && !strcmp( argv[1], "--batch" ) ) {
+		char *instancesEnd; //End of parsed instance count argument
+		char *countEnd; //End of parsed frame count argument
+		unsigned long instanceCount; //Number of instances to run
+		unsigned long frameCount; //Number of frames to run each instance for
+
+		if ( argc != 6 ) {
+			eprintf( "Usage: %s --batch <ROM path> <Boot ROM path> <instance count> <frame count>\n", argv[0] );
+			return 1;
+		}//end if
+
+		instanceCount = strtoul( argv[4], &instancesEnd, 10 );
+		if ( *instancesEnd != '\0' || instancesEnd == argv[4] || instanceCount == 0 || instanceCount > UINT_MAX ) {
+			eprintf( "Invalid instance count \"%s\"\n", argv[4] );
+			return 1;
+		}//end if
+
+		frameCount = strtoul( argv[5], &countEnd, 10 );
+		if ( *countEnd != '\0' || countEnd == argv[5] || frameCount > UINT_MAX ) {
+			eprintf( "Invalid frame count \"%s\"\n", argv[5] );
+			return 1;
+		}//end if
+
+		return Run_Headless_Batch( argv[2], argv[3], (unsigned)instanceCount, frameCount );
+	}//end if
+
+	//Get ROM and Boot ROM paths, defaulting to the bundled test ROMs
+	romPath = argc > 1 ? argv[1] : "./roms/tetris.gb";
+	bootromPath = argc > 2 ? argv[2] : "./roms/dmg_boot.bin";
 
 	//Initialize SDL
 	if ( SDL_Init( SDL_INIT_VIDEO ) ) {
@@ -50,15 +107,22 @@ int main( int argc, char *argv[] ) {
 		return 1;
 	}//end if
 
-	//Get surfaces
-	surfaces[0] = SDL_GetWindowSurface( windows[0] );
-	surfaces[1] = SDL_GetWindowSurface( windows[1] );
+	//Initialize LCD presentation
+	if ( Init_Emulator_Screen( windows[0], &screen ) ) {
+		eprintf( "Unable to initialize emulator screen: %s\n", SDL_GetError() );
+
+		Deinit_Emulator_Screen( &screen );
+		Deinit_Emulator_Windows( windows );
+		SDL_Quit();
+		return 1;
+	}//end if
 
 	//Initialize Game Boy system
 	if ( GB_Init( &gb ) ) {
 		eprintf( "An error occurred during emulated Game Boy system initialization.\n" );
 
 		GB_Deinit( &gb );
+		Deinit_Emulator_Screen( &screen );
 		Deinit_Emulator_Windows( windows );
 		SDL_Quit();
 		return 1;
@@ -72,6 +136,34 @@ int main( int argc, char *argv[] ) {
 		eprintf( "An error occurred while loading the game ROM file.\n" );
 
 		GB_Deinit( &gb );
+		Deinit_Emulator_Screen( &screen );
+		Deinit_Emulator_Windows( windows );
+		SDL_Quit();
+		return 1;
+	}//end if
+
+	//Boot through snapshot cache, if one is named by EDBOY_BOOT_CACHE. Must come before attaching the save file.
+	if ( getenv( "EDBOY_BOOT_CACHE" ) ) GB_Boot( &gb, getenv( "EDBOY_BOOT_CACHE" ) );
+
+	//Keep battery-backed RAM in the save file beside the game, and write it back periodically
+	Attach_Save_File( &gb, romPath );
+	saveFlusher = Start_Save_Flusher( &gb );
+
+	//Record rewind history of loaded game
+	if ( GB_Rewind_Init( &gb, REWIND_BUFFER_SIZE ) ) eprintf( "Continuing without rewind.\n" );
+
+	//Start decoding trace records, if tracing
+	traceLogger = Start_Trace_Logger( &gb, stdout );
+
+	//Start running Game Boy system. It is owned by the emulation thread until stopped.
+	emulator = Start_Emulator_Thread( &gb );
+	if ( !emulator ) {
+		eprintf( "An error occurred while starting emulation.\n" );
+
+		Stop_Trace_Logger( traceLogger );
+		Stop_Save_Flusher( saveFlusher );
+		GB_Deinit( &gb );
+		Deinit_Emulator_Screen( &screen );
 		Deinit_Emulator_Windows( windows );
 		SDL_Quit();
 		return 1;
@@ -86,11 +178,15 @@ int main( int argc, char *argv[] ) {
 	//Main loop
 	while ( !didQuit ) {
 
-		//Poll for quit events until event queue is empty
-		while ( SDL_PollEvent( &event ) && !didQuit )
+		//Wait for input, window, or new frame events, then handle quit events until event queue is empty
+		hasEvent = SDL_WaitEventTimeout( &event, EVENT_WAIT_TIMEOUT );
+		while ( hasEvent && !didQuit ) {
 			if ( event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_CLOSE  )
 				didQuit = true;
 
+			hasEvent = SDL_PollEvent( &event );
+		}//end while
+
 		currKeyStates = SDL_GetKeyboardState( NULL );
 
 		//Toggle frame-step mode, if needed
@@ -110,28 +206,33 @@ int main( int argc, char *argv[] ) {
 		}//end if
 		else fsJustPressed = false;
 
-		//Perform frame as appropriate, check for mid-frame request for quit
-		if ( doFrameStep ) {
-			if ( Do_FrameStep_Frame( &gb, currKeyStates, isPressedFrameStep, justPressedFrameStep, &faJustPressed ) ) didQuit = true;
-		}//end if
-		else {
-			if ( Do_FullSpeed_Frame( &gb, currKeyStates ) ) didQuit = true;
-		}//end if-else
+		//Get input as appropriate, and send it to the emulation thread if changed or requesting a frame
+		if ( doFrameStep ) Get_FrameStep_Input( currKeyStates, isPressedFrameStep, justPressedFrameStep, &faJustPressed, &input );
+		else Get_FullSpeed_Input( currKeyStates, &speed, &runAhead, &raJustPressed, &input );
 
-		//Update emulator surface contents
+		if ( input.doAdvance || memcmp( &input, &sentInput, sizeof( struct EmulatorInput ) ) ) {
+			if ( Send_Emulator_Input( emulator, &input ) ) sentInput = input;
+		}//end if
 
-		//Update VRAM surface contents
+		//Check for mid-frame request for quit
+		if ( Has_Emulator_Quit( emulator ) ) didQuit = true;
 
-		//Blit surfaces
+		//Present newest complete LCD frame, if any
+		frame = Take_Emulator_Frame( emulator );
+		if ( frame ) Present_Emulator_Screen( &screen, frame );
 
-		//Update windows
+		//Update VRAM window contents
 
 	}//end while
 
-	//Deinitialize Game Boy system and loaded game
+	//Stop emulation, then deinitialize Game Boy system and loaded game, writing back its save file
+	Stop_Emulator_Thread( emulator );
+	Stop_Trace_Logger( traceLogger );
+	Stop_Save_Flusher( saveFlusher );
 	GB_Deinit( &gb );
 
-	//Deinit windows and quit SDL
+	//Deinit screen and windows, and quit SDL
+	Deinit_Emulator_Screen( &screen );
 	Deinit_Emulator_Windows( windows );
 	SDL_Quit();
 
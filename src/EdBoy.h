@@ -2,160 +2,153 @@
 
 #include <SDL.h>
 #include <stdbool.h>
+#include <limits.h>
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdio.h>
 
-/*	Game Boy Constants	*/
-#define GB_LCD_HEIGHT 144 //Game Boy LCD screen pixel height
-#define GB_LCD_WIDTH 160 //Game Boy LCD screen pixel width
-#define GB_DOTS_PER_SCANLINE 456 //Number of PPU dots per Game Boy LCD scanline
-#define GB_CYCLES_PER_FRAME 70224 //Number of CPU cycles and PPU dots in one DMG Game Boy frame
-#define GB_SCANLINES_PER_FRAME 154 //Number of scanlines in one frame, including non-rendering VBlank scanlines
+#include "GameBoy/GameBoy.h"
 
 /*	Emulator Constants	*/
 #define VRAM_WINDOW_HEIGHT 128 //Unscaled VRAM display window pixel width (24 tiles wide * 8 px per tile)
 #define VRAM_WINDOW_WIDTH 192 //Unscaled VRAM display window pixel hight (16 tiles high * 8 px per tile)
+#define EVENT_WAIT_TIMEOUT 100 //Milliseconds the main loop waits for an SDL event before checking on the emulation thread
+#define RUNAHEAD_MAX_FRAMES 3 //Maximum number of frames full-speed mode may run ahead of the displayed frame
+#define REWIND_BUFFER_SIZE ( 16 << 20 ) //Bytes of rewind history kept while running in a window. Several minutes of typical play.
+#define SAVE_FLUSH_INTERVAL 5000 //Milliseconds between write backs of a battery-backed cartridge's save file, bounding how much saving a host crash may lose
+#define BATCH_TASK_FRAMES 16 //Number of frames a batch worker runs an instance for per task, before its remaining frames become a new task
 
 /* Emulator Controls */
 #define CTRL_FRAMESTEP_TOGGLE SDL_SCANCODE_K //Toggles frame-step/full-speed modes
 #define CTRL_FRAMESTEP_ADVANCE SDL_SCANCODE_SPACE //Advances one frame in frame-step mode
+#define CTRL_SPEED_1X SDL_SCANCODE_1 //Runs full-speed mode at the DMG's frame rate
+#define CTRL_SPEED_2X SDL_SCANCODE_2 //Runs full-speed mode at twice the DMG's frame rate
+#define CTRL_SPEED_4X SDL_SCANCODE_3 //Runs full-speed mode at four times the DMG's frame rate
+#define CTRL_SPEED_UNLIMITED SDL_SCANCODE_4 //Runs full-speed mode as fast as possible
+#define CTRL_REWIND SDL_SCANCODE_R //Steps backwards through rewind history while held in full-speed mode
+#define CTRL_RUNAHEAD SDL_SCANCODE_L //Cycles the number of frames full-speed mode runs ahead, from 0 to RUNAHEAD_MAX_FRAMES
 
 /*	Debug	*/
-#define DEBUG 1 //Debug logging signifier constant
+//Debug logging is enabled by defining DEBUG at compile time (e.g. -DDEBUG). Release builds compile it to nothing.
 #ifdef DEBUG
-#define dprintf(...) printf(__VA_ARGS__) //Debug print function
+#define dprintf(...) printf(__VA_ARGS__) //Debug print function. For infrequent events only.
 #else
-#define dprintf(...) 
+#define dprintf(...) do { } while ( 0 )
 #endif
 
 /*	Shorthand	*/
 #define eprintf(...) fprintf( stderr, __VA_ARGS__ ) //stderr print function shorthand
 
 /*	Definitions	*/
-//Defines the attributes of a pixel currently in one of the PPU's Pixel FIFOs
-struct GB_FIFOPixel {
-	uint8_t colorIndex; //Pixel color as an index into the appropriate Palette register
-	uint8_t palette; //Value of Palette Number bit. For sprites only.
-	uint8_t priority; //Value of OBJ-to-BG Priority bit. For sprites only.
+//Defines a lookup table converting LCD shades into the 32-bit pixels of one display pixel format
+struct LCDPalette {
+	_Alignas( 32 ) uint8_t bytes[4][32]; //Byte b of each shade's pixel in memory order, at index shade of each 16-byte lane. Used as shuffle tables.
+	uint32_t pixels[4]; //Pixel for each shade 0 (white) ~ 3 (black)
 };
 
-//Defines the state of the emulated Game Boy's PPU (Picture Processing Unit)
-struct GB_PictureProcessor {
-	uint8_t *oam; //160 B Object Attribute Memory
-	bool isOAMBlocked; //Whether OAM access is currently blocked
-
-	uint8_t fetcherX; //X-Coordinate of PPU Pixel Fetcher
-	uint8_t fetcherY; //Y-Coordinate of PPU Pixel Fetcher
-
-	struct GB_FIFOPixel bgFIFO[16]; //Contents of BG Pixel FIFO
-	struct GB_FIFOPixel oamFIFO[16]; //Contents of sprite/OAM Pixel FIFO
-
-	uint8_t bgFIFOTail; //First free index of BG Pixel FIFO
-	uint8_t oamFIFOTail; //First free index of OAM Pixel FIFO
-
-	uint8_t *oamScanResults[10]; //Pointers to sprites in OAM found during Mode 2 for the current scanline
+//Defines the SDL objects used to present the emulated LCD in the emulator window
+struct EmulatorScreen {
+	SDL_Renderer *renderer; //Renderer of the emulator window
+	SDL_Texture *texture; //160 x 144 streaming texture, updated with each displayed frame
+	struct LCDPalette palette; //Converts LCD shades into the texture's pixel format
 };
 
-//Defines the state of the emulated Game Boy's CPU/System on a Chip
-struct GB_Processor {
-	uint8_t regs[8]; //Stores raw 8-bit register pairs
-
-	uint8_t *a; //8-bit accumulator register A
-	uint8_t *f; //8-bit flag register F
-	uint8_t *b; //8-bit register B
-	uint8_t *c; //8-bit register C
-	uint8_t *d; //8-bit register D
-	uint8_t *e; //8-bit register E
-	uint8_t *h; //8-bit register H
-	uint8_t *l; //8-bit register L
-
-	uint16_t *af; //16-bit register pair AF
-	uint16_t *bc; //16-bit register pair BC
-	uint16_t *de; //16-bit register pair DE
-	uint16_t *hl; //16-bit register pair HL
-
-	uint16_t sp; //16-bit stack pointer register SP
-	uint16_t pc; //16-bit program counter register PC
-
-	struct GB_PictureProcessor ppu; //Picture Processing Unit
+//Defines one snapshot of emulator input, sent from the SDL thread to the emulation thread
+struct EmulatorInput {
+	uint8_t buttons; //Bit mask of Game Boy buttons pressed for the next frame, indexed by GameBoyButtonID
+	bool isFrameStep; //Whether frames are run only upon frame-advance requests, rather than back-to-back
+	bool doAdvance; //Whether to run one frame-stepped frame
+	bool isAdvanceHeld; //Whether the frame-advance key is held. Resumes execution paused on an unknown opcode when newly pressed.
+	uint8_t speed; //Frame rate multiplier of full-speed mode. 0 if unlimited.
+	bool isRewinding; //Whether full-speed frames step backwards through rewind history, rather than being run
+	uint8_t runAhead; //Number of frames full-speed mode runs ahead of each displayed frame, hiding that many frames of the game's input lag
+};
 
-	uint8_t *boot; //256 B Boot ROM
+//Defines counters of frame-time jitter, the difference between each interval between paced frames and the frame period, and of frame production time
+struct FramePacerStats {
+	uint64_t frames; //Number of frame intervals measured
+	uint64_t lateFrames; //Number of frames whose deadline had already passed when paced
+	uint64_t resyncs; //Number of times the pacer fell too far behind, and restarted its schedule
+	uint64_t totalJitter; //Sum of jitter of every interval, in microseconds
+	uint64_t maxJitter; //Largest jitter of any interval, in microseconds
+	uint64_t totalBusy; //Sum of time spent producing each frame before it was paced, in microseconds
+	uint64_t maxBusy; //Longest time spent producing any frame, in microseconds
+};
 
-	uint8_t *hram; //128 B High RAM
+//Defines the state of a frame pacer, which releases frames on a fixed schedule at a multiple of the DMG's frame rate
+struct FramePacer {
+	unsigned speed; //Frame rate multiplier. 0 if unlimited.
+	uint64_t periodTicks; //Whole performance counter ticks per frame period
+	uint64_t periodRemainder; //Fraction of a tick per frame period, in units of 1 / periodDenominator
+	uint64_t periodDenominator; //Denominator of periodRemainder and deadlineRemainder
+	uint64_t deadline; //Performance counter value at which the last scheduled frame was due
+	uint64_t deadlineRemainder; //Fraction of a tick of deadline, in units of 1 / periodDenominator
+	uint64_t lastRelease; //Performance counter value at which the last frame was released. 0 if none since the schedule restarted.
+	struct FramePacerStats stats; //Jitter counters
+};
 
-	uint8_t ime; //Interrupt Master Enable Flag IME
+//Defines one instance run by a batch executor, and its progress through the batch
+struct BatchInstance {
+	GameBoy *gb; //System to run. Must be loaded, and not accessed elsewhere until the batch finishes.
+	const uint8_t *inputs; //Buttons pressed during each frame, as bit masks indexed by GameBoyButtonID. NULL if no buttons are ever pressed.
+	unsigned frameCount; //Number of frames to run. inputs, if given, holds this many masks.
+	unsigned framesRun; //Number of frames run so far. Set by the executor.
+	bool didQuit; //Whether the instance quit mid-frame through its unknown-opcode callback, ending its run early. Set by the executor.
 };
 
-//Defines the state of the contents of the emulated Game Boy's cartridge slot
-struct GB_GamePak {
-	uint8_t *rom0; //16 KB lower addressable ROM Bank (Bank 00)
-	bool isROM0Blocked; //Whether lower ROM bank is currently blocked
+//Defines aggregate statistics of one batch
+struct BatchStats {
+	uint64_t frames; //Number of frames run by all instances
+	uint64_t tasks; //Number of tasks run by all workers
+	uint64_t steals; //Number of tasks taken from another worker's deque
+	double seconds; //Host wall-clock time spent running the batch
+	double framesPerSecond; //Aggregate frames run per second
+};
 
-	uint8_t *rom1; //16 KB upper addressable ROM Bank (Bank 00 ~ NN)
-	bool isROM1Blocked; //Whether upper ROM bank is currently blocked
+struct BatchExecutor; //Pool of worker threads running instances in batches. Defined in Batch.c.
 
-	uint8_t *extram; //8 KB addressable external RAM Bank
-	bool isExtRAMBlocked; //Whether external RAM bank is currently blocked
-};
+struct EmulatorThread; //Thread running an emulated system, and the queues between it and the SDL thread. Defined in EmuThread.c.
 
-//Defines the total state of the emulated Game Boy system
-typedef struct GB_System {
-	/* Game Boy components */
-	struct GB_Processor cpu; //Game Boy SoC ("DMG-CPU")
-	struct GB_GamePak cart; //Game Boy cartridge slot contents
-
-	uint8_t *vram; //8 KB Video RAM
-	uint8_t *wram; //8 KB Work RAM
-	uint8_t *io[0x80]; //Game Boy memory-mapped I/O registers
-
-	uint8_t *lcd[GB_LCD_HEIGHT]; //160 x 144 LCD screen. Contains pointers to scanlines.
-
-	/* Helper flags and variables */
-	bool isWRAMBlocked; //Whether WRAM access is currently blocked
-	bool isVRAMBlocked; //Whether VRAM access is currently blocked
-
-	bool lcdBlankThisFrame; //Whether LCD should not render drawn pixels during this frame
-
-	unsigned cyclesNextDIV; //Cycle count upon next increment of DIV register
-	unsigned cyclesNextTIMA; //Cycle count upon next increment of TIMA register
-
-	unsigned cycles; //Cycle count into current frame
-	bool isFrameOver; //Whether current frame has met or exceeded 70224 cycles
-} GameBoy;
-
-//Defines button IDs used for Game Boy buttons. Used as indices into isPressed, CTRL_SCANCODES, etc.
-enum GameBoyButtonID {
-	GB_UP, //D-Pad Up
-	GB_DOWN, //D-Pad Down
-	GB_LEFT, //D-Pad Left
-	GB_RIGHT, //D-Pad Right
-	GB_A, //A Button
-	GB_B, //B Button
-	GB_START, //Start Button
-	GB_SELECT //Select Button
-};
+struct SaveFlusher; //Background thread which periodically writes back an instance's save file. Defined in SaveFlush.c.
 
+struct GB_TraceLogger; //Background thread which decodes an instance's trace records into text. Defined in TraceLog.c.
 /*	Externs	*/
 extern const int CTRL_SCANCODES[]; //EdBoy.c
 
 /*	Function Prototypes	*/
 int Init_Emulator_Windows( SDL_Window **windows ); //Window.c
 void Deinit_Emulator_Windows( SDL_Window **windows ); //Window.c
+int Init_Emulator_Screen( SDL_Window *window, struct EmulatorScreen *screen ); //Window.c
+void Deinit_Emulator_Screen( struct EmulatorScreen *screen ); //Window.c
+void Present_Emulator_Screen( struct EmulatorScreen *screen, const uint8_t *frame ); //Window.c
+
+void Get_FrameStep_Input( const uint8_t *keyStates, bool *isPressed, bool *justPressed, bool *faJustPressed, struct EmulatorInput *input ); //Run.c
+void Get_FullSpeed_Input( const uint8_t *keyStates, uint8_t *speed, uint8_t *runAhead, bool *raJustPressed, struct EmulatorInput *input ); //Run.c
+
+void Reset_Frame_Pacer( struct FramePacer *pacer, unsigned speed ); //Pacer.c
+void Reset_Frame_Pacer_Stats( struct FramePacer *pacer ); //Pacer.c
+void Pace_Frame( struct FramePacer *pacer ); //Pacer.c
+void Print_Frame_Pacer_Stats( const struct FramePacer *pacer, FILE *out ); //Pacer.c
 
-bool Do_FrameStep_Frame( GameBoy *gb, const uint8_t *keyStates, bool *isPressed, bool *justPressed, bool *faJustPressed ); //Run.c
-bool Do_FullSpeed_Frame( GameBoy *gb, const uint8_t *keyStates ); //Run.c
-bool Pause_On_Unknown_Opcode(); //Run.c
+struct EmulatorThread *Start_Emulator_Thread( GameBoy *gb ); //EmuThread.c
+void Stop_Emulator_Thread( struct EmulatorThread *emu ); //EmuThread.c
+bool Send_Emulator_Input( struct EmulatorThread *emu, const struct EmulatorInput *input ); //EmuThread.c
+const uint8_t *Take_Emulator_Frame( struct EmulatorThread *emu ); //EmuThread.c
+bool Has_Emulator_Quit( struct EmulatorThread *emu ); //EmuThread.c
 
-int GB_Init( GameBoy *gb ); //GameBoy/Init.c
-void GB_Deinit( GameBoy *gb ); //GameBoy/Init.c
+int Build_LCD_Palette( struct LCDPalette *palette, uint32_t format ); //Palette.c
+void Convert_LCD_Frame( const struct LCDPalette *palette, const uint8_t *frame, void *pixels, int pitch ); //Palette.c
 
-void GB_Load_BootROM( GameBoy *gb, char *path ); //GameBoy/Load.c
-int GB_Load_Game( GameBoy *gb, char *path ); //GameBoy/Load.c
+struct BatchExecutor *Start_Batch_Executor( unsigned workerCount ); //Batch.c
+void Stop_Batch_Executor( struct BatchExecutor *batch ); //Batch.c
+int Run_Batch( struct BatchExecutor *batch, struct BatchInstance *instances, unsigned count, struct BatchStats *stats ); //Batch.c
 
-bool GB_Run_Frame( GameBoy *gb, bool *isPressed ); //GameBoy/Cycle.c
-void GB_Cycle_T_States( GameBoy *gb, unsigned cyclesIncrement ); //GameBoy/Cycle.c
+int Run_Headless( char *romPath, char *bootromPath, unsigned long frameCount ); //Headless.c
+int Run_Headless_Batch( char *romPath, char *bootromPath, unsigned instanceCount, unsigned long frameCount ); //Headless.c
 
-bool GB_Decode_Execute( GameBoy *gb, bool *isPressed ); //GameBoy/Decode.c
+int Attach_Save_File( GameBoy *gb, const char *romPath ); //SaveFlush.c
+struct SaveFlusher *Start_Save_Flusher( const GameBoy *gb ); //SaveFlush.c
+void Stop_Save_Flusher( struct SaveFlusher *flusher ); //SaveFlush.c
 
-uint8_t GB_Read( GameBoy *gb, uint16_t addr ); //GameBoy/Read.c
-uint8_t GB_Get_Next_Byte( GameBoy *gb ); //GameBoy/Read.c
\ No newline at end of file
+struct GB_TraceLogger *Start_Trace_Logger( GameBoy *gb, FILE *out ); //TraceLog.c
+void Stop_Trace_Logger( struct GB_TraceLogger *logger ); //TraceLog.c
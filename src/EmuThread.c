@@ -0,0 +1,371 @@
+#include <SDL.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "EdBoy.h"
+
+/*	Emulation thread. The emulated system is run on its own thread, so presentation stalls on the SDL thread never stall emulation.
+*	Finished frames are passed to the SDL thread through a lock-free queue of framebuffers, and input snapshots are passed back through a lock-free ring.
+*
+*	Framebuffers move in a cycle: the emulation thread fills its own buffer and publishes it to the frame queue,
+*	the SDL thread takes the newest published buffer and returns the one it was presenting to the free ring, and the emulation thread refills from there.
+*	If the frame queue is full, the emulation thread drops the oldest queued frame and reuses its buffer, so it never waits on presentation.
+*
+*	Neither thread polls while idle. The emulation thread blocks on a semaphore posted with each input snapshot, and
+*	pushes an SDL event when it publishes a frame, so the SDL thread can block in SDL_WaitEventTimeout.
+*/
+
+#define EMU_FRAME_QUEUE_SIZE 4 //Maximum number of frames waiting to be presented. Must be a power of two.
+#define EMU_FRAME_BUFFERS ( EMU_FRAME_QUEUE_SIZE + 3 ) //Number of framebuffers. One filling, up to one presenting and one being taken, and the rest queued or free.
+#define EMU_FREE_RING_SIZE 8 //Capacity of the ring of free framebuffers. Must be a power of two, and at least EMU_FRAME_BUFFERS.
+#define EMU_INPUT_QUEUE_SIZE 16 //Maximum number of input snapshots waiting to be handled. Must be a power of two.
+
+//Defines the state of the emulation thread and the queues between it and the SDL thread
+struct EmulatorThread {
+	GameBoy *gb; //Emulated system. Owned by the emulation thread until stopped.
+	SDL_Thread *thread; //Emulation thread
+	SDL_sem *inputReady; //Posted once per input snapshot sent, and upon stopping. Waited on while idle or paused.
+	atomic_bool isStopping; //Set when the emulation thread should exit
+	atomic_bool didQuit; //Set by the emulation thread when the user quit mid-frame
+	uint32_t frameEventType; //Type of SDL event pushed to wake the SDL thread when a frame is published
+	atomic_bool isFrameEventPending; //Whether a frame event has been pushed since the SDL thread last took frames
+
+	/* Frame queue. Both threads may advance frameTail: the SDL thread to take a frame, the emulation thread to drop one. */
+	char framePadding[64]; //Keeps each index below on its own cache line
+	atomic_uint frameHead; //Total number of frames published. Written only by the emulation thread.
+	char frameHeadPadding[64];
+	atomic_uint frameTail; //Total number of frames taken or dropped
+	char frameTailPadding[64];
+	_Atomic uint8_t frameQueue[EMU_FRAME_QUEUE_SIZE]; //Buffer index of each published frame
+
+	/* Free ring. Buffers returned by the SDL thread to the emulation thread. Never fills, as it can hold every buffer. */
+	atomic_uint freeHead; //Total number of buffers returned. Written only by the SDL thread.
+	char freeHeadPadding[64];
+	atomic_uint freeTail; //Total number of buffers reused. Written only by the emulation thread.
+	char freeTailPadding[64];
+	_Atomic uint8_t freeRing[EMU_FREE_RING_SIZE]; //Index of each returned buffer
+
+	/* Input ring */
+	atomic_uint inputHead; //Total number of input snapshots sent. Written only by the SDL thread.
+	char inputHeadPadding[64];
+	atomic_uint inputTail; //Total number of input snapshots handled. Written only by the emulation thread.
+	char inputTailPadding[64];
+	struct EmulatorInput inputs[EMU_INPUT_QUEUE_SIZE]; //Input snapshot storage
+
+	/* Emulation thread only */
+	uint8_t fillBuffer; //Index of buffer the next frame is copied into
+	struct EmulatorInput input; //Last input snapshot handled
+	bool wasAdvanceHeld; //Whether the frame-advance key was held in the input snapshot before last
+	struct FramePacer pacer; //Paces full-speed frames
+	uint8_t *aheadState; //Snapshot of the system restored after running frames ahead
+	uint8_t aheadFrame[GB_LCD_HEIGHT * GB_LCD_PITCH]; //LCD frame of the last frame run ahead
+
+	/* SDL thread only */
+	int presentBuffer; //Index of buffer last taken for presentation. -1 if none.
+
+	uint8_t buffers[EMU_FRAME_BUFFERS][GB_LCD_HEIGHT * GB_LCD_PITCH]; //Framebuffer storage
+};
+
+/* Returns the frame queue slot of the frame with the given index. */
+static unsigned Frame_Slot( unsigned index ) {
+	return index & ( EMU_FRAME_QUEUE_SIZE - 1 );
+}//end function Frame_Slot
+
+/*	Takes the next input snapshot sent by the SDL thread into the thread's current input, if any.
+*	Returns true if a snapshot was taken. Otherwise, returns false.
+*/
+static bool Take_Input( struct EmulatorThread *emu ) {
+	unsigned tail = atomic_load_explicit( &( emu->inputTail ), memory_order_relaxed ); //Index of next snapshot
+
+	if ( tail == atomic_load_explicit( &( emu->inputHead ), memory_order_acquire ) ) return false;
+
+	emu->wasAdvanceHeld = emu->input.isAdvanceHeld;
+	emu->input = emu->inputs[tail & ( EMU_INPUT_QUEUE_SIZE - 1 )];
+	atomic_store_explicit( &( emu->inputTail ), tail + 1, memory_order_release );
+
+	return true;
+}//end function Take_Input
+
+/* Copies the given complete frame into the fill buffer and publishes it, dropping the oldest queued frame if the queue is full. */
+static void Publish_Frame( struct EmulatorThread *emu, const uint8_t *frame ) {
+	unsigned head = atomic_load_explicit( &( emu->frameHead ), memory_order_relaxed ); //Index of frame being published
+	unsigned tail = atomic_load_explicit( &( emu->frameTail ), memory_order_acquire ); //Index of oldest queued frame
+	int dropped = -1; //Buffer index of the frame dropped to make room, if any
+
+	memcpy( emu->buffers[emu->fillBuffer], frame, GB_LCD_HEIGHT * GB_LCD_PITCH );
+
+	//Drop oldest frame if full. The SDL thread may take it first, in which case the queue is no longer full.
+	while ( head - tail >= EMU_FRAME_QUEUE_SIZE ) {
+		uint8_t oldest = atomic_load_explicit( &( emu->frameQueue[Frame_Slot( tail )] ), memory_order_relaxed ); //Buffer of oldest frame
+
+		if ( atomic_compare_exchange_weak_explicit( &( emu->frameTail ), &tail, tail + 1, memory_order_acq_rel, memory_order_acquire ) ) {
+			dropped = oldest;
+			break;
+		}//end if
+	}//end while
+
+	atomic_store_explicit( &( emu->frameQueue[Frame_Slot( head )] ), emu->fillBuffer, memory_order_relaxed );
+	atomic_store_explicit( &( emu->frameHead ), head + 1, memory_order_release );
+
+	//Wake the SDL thread, unless already woken for a frame it has not yet taken
+	if ( !atomic_exchange( &( emu->isFrameEventPending ), true ) ) {
+		SDL_Event event; //Frame event
+
+		SDL_memset( &event, 0, sizeof( SDL_Event ) );
+		event.type = emu->frameEventType;
+		SDL_PushEvent( &event );
+	}//end if
+
+	//Refill the dropped frame's buffer, or else a buffer returned by the SDL thread
+	if ( dropped >= 0 ) emu->fillBuffer = (uint8_t)dropped;
+	else {
+		unsigned freeTail = atomic_load_explicit( &( emu->freeTail ), memory_order_relaxed ); //Index of next returned buffer
+
+		//Only read the slot once its return is visible. There are enough buffers that one is always returned or being returned.
+		while ( atomic_load_explicit( &( emu->freeHead ), memory_order_acquire ) == freeTail );
+
+		emu->fillBuffer = atomic_load_explicit( &( emu->freeRing[freeTail & ( EMU_FREE_RING_SIZE - 1 )] ), memory_order_relaxed );
+		atomic_store_explicit( &( emu->freeTail ), freeTail + 1, memory_order_release );
+	}//end if-else
+
+	return;
+}//end function Publish_Frame
+
+/*	Pauses mid-frame on the emulation thread, and waits for the frame-advance key to be pressed on the SDL thread.
+*	Other input is not handled while paused. Meant for temporary testing only. Set as the system's unknown-opcode callback while the thread runs.
+*	Returns true if the emulation thread is being stopped, such as by closing the emulator window mid-pause. Otherwise, returns false.
+*/
+static bool Pause_On_Unknown_Opcode( void *data ) {
+	struct EmulatorThread *emu = data; //Emulation thread being paused
+
+	while ( !atomic_load( &( emu->isStopping ) ) ) {
+		if ( !Take_Input( emu ) ) {
+			SDL_SemWait( emu->inputReady );
+			continue;
+		}//end if
+
+		if ( emu->input.isAdvanceHeld && !( emu->wasAdvanceHeld ) ) {
+			emu->input.doAdvance = false;
+			return false;
+		}//end if
+	}//end while
+
+	return true;
+}//end function Pause_On_Unknown_Opcode
+
+/*	Runs frames until told to stop, or until the user quits mid-frame.
+*	At full speed, frames are run with the buttons of the latest input snapshot, paced at the snapshot's speed, and run ahead by the snapshot's count.
+*	While rewinding, frames are stepped back through instead.
+*	In frame-step mode, one frame is run per frame-advance request, with the buttons toggled at the time of the request.
+*/
+static int Emulator_Thread( void *data ) {
+	struct EmulatorThread *emu = data; //Emulation thread being run
+	int pacedSpeed = -1; //Speed the pacer's schedule was started at. -1 if not running at full speed.
+
+	while ( !atomic_load( &( emu->isStopping ) ) ) {
+		bool didRunFrame = false; //Whether a frame was run for this batch of input
+
+		while ( Take_Input( emu ) ) {
+			if ( !( emu->input.isFrameStep ) || !( emu->input.doAdvance ) ) continue;
+
+			dprintf( "\nDoing frame-stepped frame:\n" );
+			if ( GB_Run_Frame( emu->gb, emu->input.buttons ) ) {
+				atomic_store( &( emu->didQuit ), true );
+				return 0;
+			}//end if
+
+			Publish_Frame( emu, emu->gb->frame );
+			didRunFrame = true;
+		}//end while
+
+		if ( !( emu->input.isFrameStep ) ) {
+			//Restart the schedule upon entering full-speed mode or changing speed
+			if ( pacedSpeed != emu->input.speed ) {
+				Reset_Frame_Pacer( &( emu->pacer ), emu->input.speed );
+				pacedSpeed = emu->input.speed;
+			}//end if
+
+			//Step back one frame while rewinding, until history runs out
+			if ( emu->input.isRewinding ) {
+				if ( emu->gb->rewind && GB_Rewind_Step( emu->gb ) ) Publish_Frame( emu, emu->gb->frame );
+			}//end if
+			//Run ahead, displaying a frame from the future
+			else if ( emu->input.runAhead ) {
+				if ( GB_Run_Frame_Ahead( emu->gb, emu->input.buttons, emu->input.runAhead, emu->aheadState, emu->aheadFrame ) ) {
+					atomic_store( &( emu->didQuit ), true );
+					return 0;
+				}//end if
+
+				Publish_Frame( emu, emu->aheadFrame );
+			}//end if
+			else {
+				if ( GB_Run_Frame( emu->gb, emu->input.buttons ) ) {
+					atomic_store( &( emu->didQuit ), true );
+					return 0;
+				}//end if
+
+				Publish_Frame( emu, emu->gb->frame );
+			}//end if-else
+			Pace_Frame( &( emu->pacer ) );
+		}//end if
+		else {
+			pacedSpeed = -1;
+			if ( !didRunFrame ) SDL_SemWait( emu->inputReady );
+		}//end if-else
+	}//end while
+
+	return 0;
+}//end function Emulator_Thread
+
+/*	Starts running the given system on a new emulation thread, initially in frame-step mode with no buttons pressed.
+*	The system must not be accessed by the caller until the thread is stopped.
+*	Returns the emulation thread, or NULL if it could not be started.
+*/
+struct EmulatorThread *Start_Emulator_Thread( GameBoy *gb ) {
+	struct EmulatorThread *emu; //New emulation thread
+
+	emu = malloc( sizeof( struct EmulatorThread ) );
+	if ( !emu ) {
+		eprintf( "Unable to allocate emulation thread.\n" );
+		return NULL;
+	}//end if
+
+	memset( emu, 0, sizeof( struct EmulatorThread ) );
+	emu->gb = gb;
+	emu->input.isFrameStep = true;
+	emu->presentBuffer = -1;
+	atomic_init( &( emu->isStopping ), false );
+	atomic_init( &( emu->didQuit ), false );
+	atomic_init( &( emu->frameHead ), 0 );
+	atomic_init( &( emu->frameTail ), 0 );
+	atomic_init( &( emu->inputHead ), 0 );
+	atomic_init( &( emu->inputTail ), 0 );
+	atomic_init( &( emu->isFrameEventPending ), false );
+
+	//Buffer 0 is filled first. The rest start free.
+	emu->fillBuffer = 0;
+	for ( int i = 1; i < EMU_FRAME_BUFFERS; ++i )
+		atomic_init( &( emu->freeRing[i - 1] ), (uint8_t)i );
+	atomic_init( &( emu->freeHead ), EMU_FRAME_BUFFERS - 1 );
+	atomic_init( &( emu->freeTail ), 0 );
+
+	emu->aheadState = malloc( GB_State_Size( gb ) );
+	if ( !( emu->aheadState ) ) {
+		eprintf( "Unable to allocate run-ahead state.\n" );
+
+		free( emu );
+		return NULL;
+	}//end if
+
+	emu->frameEventType = SDL_RegisterEvents( 1 );
+	if ( emu->frameEventType == (uint32_t)-1 ) {
+		eprintf( "Unable to register frame event: %s\n", SDL_GetError() );
+
+		free( emu->aheadState );
+		free( emu );
+		return NULL;
+	}//end if
+
+	emu->inputReady = SDL_CreateSemaphore( 0 );
+	if ( !( emu->inputReady ) ) {
+		eprintf( "Unable to create emulation input semaphore: %s\n", SDL_GetError() );
+
+		free( emu->aheadState );
+		free( emu );
+		return NULL;
+	}//end if
+
+	gb->callbacks.pauseOnUnknownOpcode = Pause_On_Unknown_Opcode;
+	gb->callbacks.userData = emu;
+	emu->thread = SDL_CreateThread( Emulator_Thread, "EdBoy Emulation", emu );
+	if ( !( emu->thread ) ) {
+		eprintf( "Unable to start emulation thread: %s\n", SDL_GetError() );
+
+		gb->callbacks.pauseOnUnknownOpcode = NULL;
+		gb->callbacks.userData = NULL;
+		SDL_DestroySemaphore( emu->inputReady );
+		free( emu->aheadState );
+		free( emu );
+		return NULL;
+	}//end if
+
+	dprintf( "Emulation thread started.\n" );
+
+	return emu;
+}//end function Start_Emulator_Thread
+
+/* Stops the given emulation thread after its current frame, then frees it. The system it ran may be accessed again afterwards. */
+void Stop_Emulator_Thread( struct EmulatorThread *emu ) {
+	if ( !emu ) return;
+
+	atomic_store( &( emu->isStopping ), true );
+	SDL_SemPost( emu->inputReady );
+	SDL_WaitThread( emu->thread, NULL );
+	Print_Frame_Pacer_Stats( &( emu->pacer ), stdout );
+
+	emu->gb->callbacks.pauseOnUnknownOpcode = NULL;
+	emu->gb->callbacks.userData = NULL;
+	SDL_DestroySemaphore( emu->inputReady );
+	free( emu->aheadState );
+	free( emu );
+	dprintf( "Emulation thread stopped.\n" );
+
+	return;
+}//end function Stop_Emulator_Thread
+
+/*	Sends the given input snapshot to the given emulation thread. Called from the SDL thread only.
+*	Returns true if sent. Otherwise, returns false if the emulation thread has too many snapshots waiting, in which case it should be sent again later.
+*/
+bool Send_Emulator_Input( struct EmulatorThread *emu, const struct EmulatorInput *input ) {
+	unsigned head = atomic_load_explicit( &( emu->inputHead ), memory_order_relaxed ); //Index of snapshot being sent
+
+	if ( head - atomic_load_explicit( &( emu->inputTail ), memory_order_acquire ) >= EMU_INPUT_QUEUE_SIZE ) return false;
+
+	emu->inputs[head & ( EMU_INPUT_QUEUE_SIZE - 1 )] = *input;
+	atomic_store_explicit( &( emu->inputHead ), head + 1, memory_order_release );
+	SDL_SemPost( emu->inputReady );
+
+	return true;
+}//end function Send_Emulator_Input
+
+/*	Takes the newest frame published by the given emulation thread, dropping any older ones. Called from the SDL thread only.
+*	The previously taken frame is returned to the emulation thread, so must no longer be used.
+*	Returns the frame, or NULL if no frame has been published since the last call.
+*/
+const uint8_t *Take_Emulator_Frame( struct EmulatorThread *emu ) {
+	unsigned tail = atomic_load_explicit( &( emu->frameTail ), memory_order_acquire ); //Index of oldest queued frame
+	bool didTake = false; //Whether any frame was taken
+
+	//Exchanged rather than stored, so frames published before the last frame event are seen below
+	atomic_exchange( &( emu->isFrameEventPending ), false );
+
+	while ( tail != atomic_load_explicit( &( emu->frameHead ), memory_order_acquire ) ) {
+		uint8_t buffer = atomic_load_explicit( &( emu->frameQueue[Frame_Slot( tail )] ), memory_order_relaxed ); //Buffer of oldest frame
+		unsigned freeHead; //Index buffers are returned at
+
+		//The emulation thread may drop this frame first, in which case try the next
+		if ( !atomic_compare_exchange_weak_explicit( &( emu->frameTail ), &tail, tail + 1, memory_order_acq_rel, memory_order_acquire ) ) continue;
+		++tail;
+
+		//Return the buffer presented before
+		if ( emu->presentBuffer >= 0 ) {
+			freeHead = atomic_load_explicit( &( emu->freeHead ), memory_order_relaxed );
+			atomic_store_explicit( &( emu->freeRing[freeHead & ( EMU_FREE_RING_SIZE - 1 )] ), (uint8_t)emu->presentBuffer, memory_order_relaxed );
+			atomic_store_explicit( &( emu->freeHead ), freeHead + 1, memory_order_release );
+		}//end if
+
+		emu->presentBuffer = buffer;
+		didTake = true;
+	}//end while
+
+	if ( !didTake ) return NULL;
+
+	return emu->buffers[emu->presentBuffer];
+}//end function Take_Emulator_Frame
+
+/* Returns whether the user quit mid-frame on the given emulation thread, in which case it has exited. */
+bool Has_Emulator_Quit( struct EmulatorThread *emu ) {
+	return atomic_load( &( emu->didQuit ) );
+}//end function Has_Emulator_Quit
@@ -0,0 +1,84 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "GameBoy.h"
+
+/*	Allocates and initializes a new system, set up as if its boot ROM had already run, with an empty cartridge slot.
+*	The system is aligned as its definition requires. Returns the system, or NULL if unable to allocate or initialize it.
+*/
+GameBoy *GB_Create( void ) {
+	GameBoy *gb = aligned_alloc( _Alignof( GameBoy ), sizeof( GameBoy ) ); //New system. Its size is a multiple of its alignment.
+
+	if ( !gb ) return NULL;
+
+	if ( GB_Init( gb ) ) {
+		GB_Deinit( gb );
+		free( gb );
+		return NULL;
+	}//end if
+
+	GB_Load_BootROM_Buffer( gb, NULL, 0 );
+
+	return gb;
+}//end function GB_Create
+
+/* Deinitializes and frees a system created by GB_Create(). Does nothing if gb is NULL. */
+void GB_Destroy( GameBoy *gb ) {
+	if ( !gb ) return;
+
+	GB_Deinit( gb );
+	free( gb );
+
+	return;
+}//end function GB_Destroy
+
+/* Replaces the given system's callbacks with a copy of the given set. */
+void GB_Set_Callbacks( GameBoy *gb, const struct GB_Callbacks *callbacks ) {
+	gb->callbacks = *callbacks;
+
+	return;
+}//end function GB_Set_Callbacks
+
+/*	Chooses how finely the given system's CPU ticks the rest of the system. May be changed between frames.
+*	GB_TIMING_PER_ACCESS, the default, ticks every memory access as it happens. GB_TIMING_PER_INSTRUCTION ticks once per instruction,
+*	which is faster, but lets hardware see an instruction's accesses early, so suits only games that do not race the PPU or timer mid-instruction.
+*	Systems running through the recompiler keep its own timing, which is per access.
+*/
+void GB_Set_Timing( GameBoy *gb, enum GB_Timing timing ) {
+	gb->core = timing == GB_TIMING_PER_INSTRUCTION ? &GB_CORE_PER_INSTRUCTION : &GB_CORE_PER_ACCESS;
+
+	return;
+}//end function GB_Set_Timing
+
+/*	Runs the given system for the given number of frames, with the given bit mask of buttons, indexed by GameBoyButtonID, pressed throughout.
+*	Returns true if the system's unknown-opcode callback quit mid-frame, in which case fewer frames may have run.
+*/
+bool GB_Step_Frames( GameBoy *gb, unsigned frames, uint8_t buttons ) {
+	for ( unsigned i = 0; i < frames; ++i )
+		if ( GB_Run_Frame( gb, buttons ) ) return true;
+
+	return false;
+}//end function GB_Step_Frames
+
+/*	Returns the LCD frame last completed by the given system: GB_LCD_HEIGHT rows of GB_LCD_WIDTH shades 0 (white) ~ 3 (black), GB_LCD_PITCH bytes apart.
+*	The frame is held in the system itself, which alternates between two buffers, so the pointer is only valid until the system is next stepped.
+*/
+const uint8_t *GB_Get_Frame( const GameBoy *gb ) {
+	return gb->frame;
+}//end function GB_Get_Frame
+
+/* Returns the given system's GB_WRAM_SIZE bytes of Work RAM. The pointer is valid, and reflects every step, until the system is destroyed. */
+const uint8_t *GB_Get_WRAM( const GameBoy *gb ) {
+	return gb->wram;
+}//end function GB_Get_WRAM
+
+/* Returns the given system's GB_HRAM_SIZE bytes of High RAM, whose last byte is the IE register. The pointer is valid, and reflects every step, until the system is destroyed. */
+const uint8_t *GB_Get_HRAM( const GameBoy *gb ) {
+	return gb->cpu.hram;
+}//end function GB_Get_HRAM
+
+/* Returns the number of frames the given system has completed since it was created. */
+uint32_t GB_Get_Frame_Count( const GameBoy *gb ) {
+	return gb->frameCount;
+}//end function GB_Get_Frame_Count
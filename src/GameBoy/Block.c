@@ -0,0 +1,91 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "GameBoy.h"
+#include "Opcodes.h"
+
+/*	Returns whether the given base opcode must be the last instruction in a block.
+*	Blocks end at any instruction that may change PC other than by falling through, or that changes the CPU's interrupt or halt state.
+*/
+static bool Is_Block_End( uint8_t opcode ) {
+	switch ( GB_BASE_OPERATIONS[opcode] ) {
+	case GB_OP_JR: case GB_OP_JR_CC: case GB_OP_JP: case GB_OP_JP_CC: case GB_OP_JP_HL:
+	case GB_OP_CALL: case GB_OP_CALL_CC: case GB_OP_RET: case GB_OP_RET_CC: case GB_OP_RETI: case GB_OP_RST:
+	case GB_OP_STOP: case GB_OP_HALT: case GB_OP_EI:
+		return true;
+	default:
+		return false;
+	}//end switch
+}//end function Is_Block_End
+
+/*	Decodes the straight-line run of instructions starting at the given page offset of the given host page into the given block.
+*	Decoding stops after the first branch, before any illegal opcode, or before any instruction extending past the end of the page,
+*	so every instruction of a block is read from the same ROM bank as its first.
+*/
+void GB_Build_Block( struct GB_Block *block, const uint8_t *page, uint8_t offset ) {
+	unsigned addr = offset; //Page offset of next instruction
+
+	block->tag = page + offset;
+	block->count = 0;
+
+	while ( block->count < GB_BLOCK_MAX_OPS && addr < 0x100 ) {
+		struct GB_MicroOp *op = &( block->ops[block->count] ); //Next decoded instruction
+		uint8_t opcode = page[addr]; //Opcode of next instruction
+		uint8_t length = opcode == 0xCB ? 2 : GB_OPCODE_LENGTHS[opcode]; //Length of next instruction
+
+		if ( GB_BASE_OPERATIONS[opcode] == GB_OP_ILLEGAL || addr + length > 0x100 ) break;
+
+		op->opcode = opcode;
+		op->operands[0] = length > 1 ? page[addr + 1] : 0;
+		op->operands[1] = length > 2 ? page[addr + 2] : 0;
+		op->length = length;
+		block->count += 1;
+
+		addr += length;
+		if ( Is_Block_End( opcode ) ) break;
+	}//end while
+
+	return;
+}//end function GB_Build_Block
+
+/*	Allocates the system's block cache, empty, with a block for every 4 bytes of the loaded cartridge's fixed and switchable ROM banks, up to GB_BLOCK_CACHE_SIZE.
+*	The cache is allocated zeroed, so memory for blocks that are never run is never touched, and need never be made resident.
+*	Returns 0 if successful. Else, returns 1 if unable to allocate.
+*/
+int GB_Block_Cache_Init( GameBoy *gb ) {
+	size_t romSize = gb->cart.romSize < 0x8000 ? gb->cart.romSize : 0x8000; //Bytes of ROM addressable at once
+	unsigned size = GB_BLOCK_CACHE_MIN_SIZE; //Number of blocks
+
+	while ( size < GB_BLOCK_CACHE_SIZE && size < romSize / 4 )
+		size <<= 1;
+
+	gb->blockCache = calloc( 1, sizeof( struct GB_BlockCache ) + size * sizeof( struct GB_Block ) );
+	if ( !( gb->blockCache ) ) {
+		GB_ERROR( gb, "Unable to allocate block cache.\n" );
+		return 1;
+	}//end if
+	gb->blockCache->mask = size - 1;
+
+	GB_DEBUG( gb, "Block cache allocated (%u blocks).\n", size );
+
+	return 0;
+}//end function GB_Block_Cache_Init
+
+/* Frees the system's block cache, if allocated. */
+void GB_Block_Cache_Deinit( GameBoy *gb ) {
+	if ( gb->blockCache ) free( gb->blockCache );
+	gb->blockCache = NULL;
+
+	return;
+}//end function GB_Block_Cache_Deinit
+
+/*	Empties the system's block cache, reallocating it sized to the loaded ROM. Without one, all code is run through the plain interpreter.
+*	Must be called whenever ROM memory is loaded or freed, as blocks are identified by host address.
+*/
+void GB_Block_Cache_Flush( GameBoy *gb ) {
+	GB_Block_Cache_Deinit( gb );
+	if ( GB_Block_Cache_Init( gb ) ) GB_ERROR( gb, "Continuing without block cache.\n" );
+
+	return;
+}//end function GB_Block_Cache_Flush
@@ -0,0 +1,128 @@
+#define _DEFAULT_SOURCE //Exposes mkstemp() when compiling as strict ISO C
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined( _WIN32 )
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+#include "GameBoy.h"
+
+/*	Boot snapshots. Running the boot ROM takes about 2.5 s of emulated time, and always ends in the same state for the same boot ROM, cartridge ROM, and CPU timing.
+*	The boot ROM itself only reads the cartridge header, but the snapshot is taken at the end of the frame it finishes in, by which time the game's own code has run.
+*	So the state it ends in is saved once, in a cache directory, keyed by a hash of all of them and the state layout version, and restored on every later boot.
+*/
+
+/* Returns the cache key of the given system's boot: a hash of its boot ROM, entire cartridge ROM, CPU timing, and the state layout version. */
+static uint64_t Get_Boot_Key( const GameBoy *gb ) {
+	uint8_t mode[4] = { //Everything besides memory that decides the state booting ends in
+		gb->core == &GB_CORE_PER_INSTRUCTION, //Timing variant
+		gb->jit != NULL, //Whether run through the recompiler
+		GB_STATE_VERSION & 0xFF, GB_STATE_VERSION >> 8 //State layout version, little-endian
+	};
+	uint64_t hash = GB_Hash_Bytes( GB_HASH_SEED, gb->cpu.boot, 0x100 ); //Running hash
+
+	if ( gb->cart.romImage ) hash = GB_Hash_Bytes( hash, gb->cart.romImage, gb->cart.romSize );
+
+	return GB_Hash_Bytes( hash, mode, sizeof( mode ) );
+}//end function Get_Boot_Key
+
+/*	Creates a new, empty file with a unique name at the given path template, which must end in "XXXXXX", replacing those characters by the name chosen.
+*	Each boot writing a snapshot writes its own file, so concurrent boots never write into one another's. Returns 0 if successful. Else, returns 1 if unable.
+*/
+static int Create_Temp_File( char *pathTemplate ) {
+#if !defined( _WIN32 )
+	int fd = mkstemp( pathTemplate ); //Descriptor of new file
+
+	if ( fd < 0 ) return 1;
+	close( fd );
+
+	return 0;
+#else
+	return _mktemp_s( pathTemplate, strlen( pathTemplate ) + 1 ) ? 1 : 0;
+#endif
+}//end function Create_Temp_File
+
+/*	Runs the given system's boot ROM to completion, through to the end of the frame in which it unmaps itself.
+*	If given a cache directory, which must already exist, a snapshot of the system is restored from it instead, if one is cached for the same boot ROM, game, and CPU timing.
+*	Otherwise, the boot ROM is run, then a snapshot is saved in the directory for later boots. Either way, the system ends up in the same state.
+*	Must be called after the boot ROM and game are loaded and the timing or recompiler selected, and before external RAM is attached to a save file or any frame is run.
+*	Does nothing if no boot ROM is loaded. Returns 0 if booted. Else, returns 1 if the boot ROM did not finish within GB_BOOT_MAX_FRAMES, or quit mid-frame.
+*/
+int GB_Boot( GameBoy *gb, const char *cacheDir ) {
+	char *path = NULL; //Path of cached snapshot. NULL if not caching.
+	char *tempPath = NULL; //Path of unique file snapshot is written to, then renamed from, so it is never seen half-written
+	FILE *snapshotFile; //Cached snapshot, if any
+	unsigned frames = 0; //Number of frames run booting
+
+	if ( !( gb->cpu.boot ) || gb->io[0x50] ) return 0;
+
+	//Restore cached snapshot, if any
+	if ( cacheDir ) {
+		size_t pathSize = strlen( cacheDir ) + sizeof( "/0123456789ABCDEF.boot.state.XXXXXX" ); //Size of either path, including terminator
+
+		path = malloc( pathSize );
+		tempPath = malloc( pathSize );
+		if ( !path || !tempPath ) {
+			GB_ERROR( gb, "Unable to allocate boot snapshot path. Booting without snapshot.\n" );
+
+			free( path );
+			free( tempPath );
+			path = NULL;
+			tempPath = NULL;
+		}//end if
+		else {
+			snprintf( path, pathSize, "%s/%016" PRIX64 ".boot.state", cacheDir, Get_Boot_Key( gb ) );
+			snprintf( tempPath, pathSize, "%s.XXXXXX", path );
+
+			snapshotFile = fopen( path, "rb" );
+			if ( snapshotFile ) {
+				fclose( snapshotFile );
+
+				if ( !GB_Load_State_File( gb, path ) ) {
+					GB_DEBUG( gb, "Restored boot snapshot %s.\n", path );
+
+					free( path );
+					free( tempPath );
+					return 0;
+				}//end if
+			}//end if
+		}//end if-else
+	}//end if
+
+	//Run boot ROM
+	while ( !( gb->io[0x50] ) && frames < GB_BOOT_MAX_FRAMES ) {
+		if ( GB_Run_Frame( gb, 0 ) ) break;
+		++frames;
+	}//end while
+
+	if ( !( gb->io[0x50] ) || !( gb->isFrameOver ) ) {
+		GB_ERROR( gb, "Boot ROM did not finish (%u frames run).\n", frames );
+
+		free( path );
+		free( tempPath );
+		return 1;
+	}//end if
+	GB_DEBUG( gb, "Boot ROM finished after %u frames.\n", frames );
+
+	//Save snapshot for later boots
+	if ( path ) {
+		if ( Create_Temp_File( tempPath ) ) GB_ERROR( gb, "Unable to create boot snapshot in %s.\n", cacheDir );
+		else if ( GB_Save_State_File( gb, tempPath ) || rename( tempPath, path ) ) {
+			GB_ERROR( gb, "Unable to save boot snapshot %s.\n", path );
+			remove( tempPath );
+		}//end if-else
+	}//end if
+
+	free( path );
+	free( tempPath );
+
+	return 0;
+}//end function GB_Boot
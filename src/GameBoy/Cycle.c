@@ -1,106 +1,374 @@
 #include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
 
-#include "../EdBoy.h"
+#include "GameBoy.h"
 
-/* Runs the emulated Game Boy system for one frame. Returns true if user quit application prematurely via mid-frame pause on unknown opcode. */
-bool GB_Run_Frame( GameBoy *gb, bool *isPressed ) {
+/*	Runs the emulated Game Boy system for one frame. Returns true if user quit application prematurely via mid-frame pause on unknown opcode.
+*	Joypad buttons pressed this frame, given as a bit mask indexed by GameBoyButtonID, are latched for the P1/JOYP register. Newly pressed buttons request the Joypad interrupt.
+*	Unless run ahead, each completed frame is pushed to the rewind history if rewinding is enabled, and committed to the save file if one is attached.
+*/
+bool GB_Run_Frame( GameBoy *gb, uint8_t buttons ) {
+	if ( buttons & ~( gb->buttons ) ) {
+		gb->io[0x0F] |= GB_INT_JOYPAD;
+		GB_TRACE( gb, GB_TRACE_INTERRUPT, 0xFF0F, GB_INT_JOYPAD );
+	}//end if
+	gb->buttons = buttons;
 
 	gb->isFrameOver = false;
 
 	//Enter main ~70224 T-State cycle
 	while ( !gb->isFrameOver ) {
+		bool wasIMEPending; //Whether an EI instruction preceded this instruction
+		bool didQuitMidPause; //Whether user requested quit during unknown-opcode-pause
 
 		//Handle next unhandled interrupt, if one exists
+		gb->core->handleInterrupts( gb );
+
+		//While halted, skip ahead to the next event that could raise an interrupt, or to the end of the frame
+		if ( gb->cpu.isHalted ) {
+			unsigned target = gb->scheduler.nextDeadline < GB_CYCLES_PER_FRAME ? gb->scheduler.nextDeadline : GB_CYCLES_PER_FRAME; //Cycle count to skip to
+			unsigned skipped = target > gb->cycles ? ( ( target - gb->cycles + 3 ) & ~3u ) : 4; //Whole M-Cycles to skip
+
+			GB_Cycle_T_States( gb, skipped );
+			continue;
+		}//end if
 
 		//Decode and run the next instruction, and quit prematurely if user requested quit during unknown-opcode-pause.
-		if ( GB_Decode_Execute( gb, isPressed ) ) return true;
+		wasIMEPending = gb->cpu.isIMEPending;
+		if ( gb->jit ) didQuitMidPause = GB_JIT_Execute( gb );
+		else if ( gb->blockCache ) didQuitMidPause = gb->core->executeBlock( gb );
+		else didQuitMidPause = gb->core->decodeExecute( gb );
+		if ( didQuitMidPause ) return true;
+
+		//EI takes effect after the instruction following it, unless cancelled by DI
+		if ( wasIMEPending && gb->cpu.isIMEPending ) {
+			gb->cpu.ime = 1;
+			gb->cpu.isIMEPending = false;
+		}//end if
 
 	}//end for
 
+	//Record completed frame for rewinding, and commit its external RAM to the save file, unless it will be undone
+	if ( !( gb->isRunningAhead ) ) {
+		if ( gb->rewind ) GB_Rewind_Push( gb );
+		if ( gb->cart.save ) GB_Commit_Save( gb );
+	}//end if
+
 	return false;
 }//end function GB_Run_Frame
 
-/*	Increments the count of T-State cycles performed this frame and performs behaviors that occur every X T-State(s), such as:
+/*	Runs one frame, then runs the given number of frames further ahead with the same buttons pressed, and copies the LCD frame of the last into frame.
+*	The system is then restored to the end of the first frame from a snapshot taken into state, which must hold GB_State_Size() bytes,
+*	so the displayed frame reflects input that many frames sooner, while the frames run ahead leave no trace. Only the last of them is rendered.
+*	Returns true if user quit application prematurely via mid-frame pause on unknown opcode.
+*/
+bool GB_Run_Frame_Ahead( GameBoy *gb, uint8_t buttons, unsigned frames, uint8_t *state, uint8_t *frame ) {
+	bool didQuitMidPause = false; //Whether user requested quit during unknown-opcode-pause
+
+	if ( GB_Run_Frame( gb, buttons ) ) return true;
+
+	GB_Save_State( gb, state, GB_State_Size( gb ) );
+	gb->isRunningAhead = true;
+
+	//A frame need not start on a new LCD frame, so LCD frames are suppressed rather than runs. Each run has one VBlank, except while the LCD is off.
+	gb->suppressedFrames = UINT_MAX;
+	for ( unsigned i = 0; i < frames && !didQuitMidPause; ++i ) {
+		if ( gb->suppressedFrames > frames - 1 - i ) gb->suppressedFrames = frames - 1 - i;
+		didQuitMidPause = GB_Run_Frame( gb, buttons );
+	}//end for
+	gb->suppressedFrames = 0;
+
+	memcpy( frame, gb->frame, GB_LCD_HEIGHT * GB_LCD_PITCH );
+
+	GB_Load_State( gb, state, GB_State_Size( gb ) );
+	gb->isRunningAhead = false;
+
+	return didQuitMidPause;
+}//end function GB_Run_Frame_Ahead
+
+/* Returns the number of cycles between increments of the TIMA register, as selected by the TAC register. */
+static unsigned Get_TIMA_Period( GameBoy *gb ) {
+	switch ( gb->io[0x07] & 0x03 ) {
+	case 00: return 1024;
+	case 01: return 16;
+	case 02: return 64;
+	default: return 256;
+	}//end switch
+}//end function Get_TIMA_Period
+
+/* Sets the current PPU mode in the STAT register and blocks VRAM/OAM access accordingly. Requests LCD STAT interrupt if enabled for the new mode. */
+static void Set_PPU_Mode( GameBoy *gb, uint8_t mode ) {
+	gb->io[0x41] = ( gb->io[0x41] & ~0x03 ) | mode;
+
+	if ( gb->isVRAMBlocked != ( mode == 3 ) ) {
+		gb->isVRAMBlocked = ( mode == 3 );
+		GB_Map_VRAM( gb );
+	}//end if
+	gb->cpu.ppu.isOAMBlocked = ( mode == 2 || mode == 3 || gb->scheduler.deadlines[GB_EVENT_DMA] != GB_EVENT_NEVER );
+
+	GB_TRACE( gb, GB_TRACE_PPU_MODE, 0xFF44, mode );
+
+	//Modes 0-2 each have a STAT interrupt source bit, at bits 3-5
+	if ( mode != 3 && ( gb->io[0x41] & ( 0x08 << mode ) ) ) {
+		gb->io[0x0F] |= GB_INT_STAT;
+		GB_TRACE( gb, GB_TRACE_INTERRUPT, 0xFF0F, GB_INT_STAT );
+	}//end if
+
+	return;
+}//end function Set_PPU_Mode
+
+/*	Handles the end of a scanline.
+*	Increments the LY register and compares it with the LYC register, unless the LCD is disabled.
+*	Enters Mode 2 for rendering scanlines, or Mode 1 (VBlank) upon the first non-rendering scanline.
+*/
+static void Handle_Scanline_Event( GameBoy *gb, unsigned deadline ) {
+	uint8_t ly; //New value of LY register
+
+	//LY is held at 0 while the LCD is disabled
+	if ( !( gb->io[0x40] & 0x80 ) ) {
+		GB_Schedule_Event( gb, GB_EVENT_SCANLINE, deadline + GB_DOTS_PER_SCANLINE );
+		return;
+	}//end if
+
+	ly = ( gb->io[0x44] + 1 ) % GB_SCANLINES_PER_FRAME;
+	gb->io[0x44] = ly;
+	GB_TRACE( gb, GB_TRACE_REGISTER, 0xFF44, ly );
+
+	GB_Compare_LY_LYC( gb );
+
+	//Change PPU mode
+	if ( ly < GB_VISIBLE_SCANLINES ) {
+		Set_PPU_Mode( gb, 2 );
+		GB_Schedule_Event( gb, GB_EVENT_PPU_MODE, deadline + GB_MODE2_DOTS );
+	}//end if
+	else if ( ly == GB_VISIBLE_SCANLINES ) {
+		Set_PPU_Mode( gb, 1 );
+		GB_PPU_End_Frame( gb );
+		gb->io[0x0F] |= GB_INT_VBLANK;
+		GB_TRACE( gb, GB_TRACE_INTERRUPT, 0xFF0F, GB_INT_VBLANK );
+	}//end else-if
+
+	GB_Schedule_Event( gb, GB_EVENT_SCANLINE, deadline + GB_DOTS_PER_SCANLINE );
+
+	return;
+}//end function Handle_Scanline_Event
+
+/* Handles a mid-scanline PPU mode change from Mode 2 to Mode 3, or from Mode 3 to Mode 0. */
+static void Handle_PPU_Mode_Event( GameBoy *gb, unsigned deadline ) {
+
+	//Disabling the LCD cancels pending mode changes
+	if ( !( gb->io[0x40] & 0x80 ) ) {
+		Set_PPU_Mode( gb, 0 );
+		GB_Schedule_Event( gb, GB_EVENT_PPU_MODE, GB_EVENT_NEVER );
+	}//end if
+
+	//Mode 2 -> Mode 3
+	else if ( ( gb->io[0x41] & 0x03 ) == 2 ) {
+		Set_PPU_Mode( gb, 3 );
+		GB_Schedule_Event( gb, GB_EVENT_PPU_MODE, deadline + GB_MODE3_DOTS );
+		GB_PPU_Start_Line( gb, deadline );
+	}//end else-if
+
+	//Mode 3 -> Mode 0 (HBlank)
+	else {
+		GB_PPU_End_Line( gb );
+		Set_PPU_Mode( gb, 0 );
+		GB_Schedule_Event( gb, GB_EVENT_PPU_MODE, GB_EVENT_NEVER );
+	}//end if-else
+
+	return;
+}//end function Handle_PPU_Mode_Event
+
+/* Handles an increment of the DIV register every 256 cycles. */
+static void Handle_DIV_Event( GameBoy *gb, unsigned deadline ) {
+	gb->io[0x04] += 1;
+	GB_TRACE( gb, GB_TRACE_REGISTER, 0xFF04, gb->io[0x04] );
+
+	GB_Schedule_Event( gb, GB_EVENT_DIV, deadline + 256 );
+
+	return;
+}//end function Handle_DIV_Event
+
+/* Handles an increment of the TIMA register. Upon overflow, resets TIMA to TMA and requests the Timer interrupt. */
+static void Handle_TIMA_Event( GameBoy *gb, unsigned deadline ) {
+	gb->io[0x05] += 1;
+
+	//If TIMA overflow, reset to TMA and request Timer interrupt
+	if ( gb->io[0x05] == 0 ) {
+		gb->io[0x0F] |= GB_INT_TIMER;
+		GB_TRACE( gb, GB_TRACE_INTERRUPT, 0xFF0F, GB_INT_TIMER );
+
+		//Reset TIMA to TMA value
+		gb->io[0x05] = gb->io[0x06];
+	}//end if
+	GB_TRACE( gb, GB_TRACE_REGISTER, 0xFF05, gb->io[0x05] );
+
+	GB_Schedule_Event( gb, GB_EVENT_TIMA, deadline + Get_TIMA_Period( gb ) );
+
+	return;
+}//end function Handle_TIMA_Event
+
+/* Handles the completion of an OAM DMA transfer by copying 160 bytes from the source address into OAM and unblocking OAM. */
+static void Handle_DMA_Event( GameBoy *gb ) {
+	GB_PPU_Render_Pending( gb );
+	for ( uint16_t i = 0; i < 0xA0; ++i )
+		gb->cpu.ppu.oam[i] = GB_Read_Untimed( gb, gb->scheduler.dmaSource + i );
+	GB_TRACE( gb, GB_TRACE_DMA, gb->scheduler.dmaSource, 0 );
+
+	GB_Schedule_Event( gb, GB_EVENT_DMA, GB_EVENT_NEVER );
+	gb->cpu.ppu.isOAMBlocked = ( ( gb->io[0x41] & 0x03 ) >= 2 && ( gb->io[0x40] & 0x80 ) );
+
+	return;
+}//end function Handle_DMA_Event
+
+/*	Increments the count of T-State cycles performed this frame and dispatches every scheduled event whose deadline has passed, in timestamp order:
 *		Incrementing the LY register,
 *		Comparing the LY and LYC registers,
+*		Changing PPU modes,
 *		Incrementing the DIV register,
 *		Incrementing the TIMA register,
-*		Progressing on an in-progress DMA Transfer
-*		Initiating the PPU to tick for 1 dot every 1 T-State.
+*		Completing an in-progress DMA Transfer
+*	Work is only done when the earliest deadline has passed, rather than once per T-State.
 */
 void GB_Cycle_T_States( GameBoy *gb, unsigned cyclesIncrement ) {
 
-	//For every T-State to progress by:
-	for ( unsigned i = 0; i < cyclesIncrement; ++i ) {
+	gb->cycles += cyclesIncrement;
 
-		//Increment LY register every 456 cycles
-		if ( gb->cycles / GB_DOTS_PER_SCANLINE > *( gb->io[0x44] ) ) {
-			*( gb->io[0x44] ) = ( *( gb->io[0x44] ) + 1 ) % GB_SCANLINES_PER_FRAME;
-			dprintf( "LY register now %d\n", *( gb->io[0x44] ) );
-		}//end if
+	//Dispatch events in timestamp order until none are due
+	while ( gb->cycles >= gb->scheduler.nextDeadline ) {
+		enum GB_EventID id = GB_EVENT_SCANLINE; //ID of earliest due event
+		unsigned deadline; //Deadline of earliest due event
 
-		//Compare LY and LYC registers. If equal and enabled, request LCD STAT interrupt
-		if ( *( gb->io[0x44] ) == *( gb->io[0x45] ) ) {
-			dprintf( "LY and LYC equal at %d. Requesting LCD STAT interrupt\n", *( gb->io[0x44] ) );
-			//TODO Request LCD STAT interrupt
-		}//end if
+		for ( int i = GB_EVENT_SCANLINE + 1; i < GB_EVENT_COUNT; ++i )
+			if ( gb->scheduler.deadlines[i] < gb->scheduler.deadlines[id] ) id = i;
+		deadline = gb->scheduler.deadlines[id];
 
-		//Increment DIV register every 256 cycles
-		if ( gb->cycles == gb->cyclesNextDIV ) {
-			*( gb->io[0x04] ) += 1;
-			gb->cyclesNextDIV = ( gb->cycles + 256 ) % GB_CYCLES_PER_FRAME;
-			dprintf( "DIV register now %d\n", *( gb->io[0x04] ) );
-		}//end if
+		switch ( id ) {
+		case GB_EVENT_SCANLINE:
+			Handle_Scanline_Event( gb, deadline );
+			break;
+		case GB_EVENT_PPU_MODE:
+			Handle_PPU_Mode_Event( gb, deadline );
+			break;
+		case GB_EVENT_DIV:
+			Handle_DIV_Event( gb, deadline );
+			break;
+		case GB_EVENT_TIMA:
+			Handle_TIMA_Event( gb, deadline );
+			break;
+		case GB_EVENT_DMA:
+			Handle_DMA_Event( gb );
+			break;
+		default:
+			break;
+		}//end switch
+	}//end while
 
-		//Increment TIMA register according to TAC register
-		if ( ( *( gb->io[0x07] ) & 0x04 ) && ( gb->cycles == gb->cyclesNextTIMA ) ) {
-			*( gb->io[0x05] ) += 1;
-			dprintf( "TIMA register now %d\n", *( gb->io[0x05] ) );
-
-			//If TIMA overflow, reset to TMA and request Timer interrupt
-			if ( *( gb->io[0x05] ) == 0 ) {
-				dprintf( "TIMA overflow. Requesting Timer interrupt\n" );
-				//TODO Request Timer interrupt
-
-				//Reset TIMA to TMA value
-				*( gb->io[0x05] ) = *( gb->io[0x06] );
-				dprintf( "TIMA reset to %d\n", *( gb->io[0x05] ) );
-			}//end if
-
-			//Update cyclesNextTIMA to know when to increment next
-			gb->cyclesNextTIMA = gb->cycles;
-			switch ( *( gb->io[0x07] ) & 0x03 ) {
-			case 00: //In 1024 cycles
-				gb->cyclesNextTIMA += 1024;
-				break;
-			case 01: //In 16 cycles
-				gb->cyclesNextTIMA += 16;
-				break;
-			case 02: //In 64 cycles
-				gb->cyclesNextTIMA += 64;
-				break;
-			case 03: //In 256 cycles
-				gb->cyclesNextTIMA += 256;
-				break;
-			}//end switch
-			gb->cyclesNextTIMA %= GB_CYCLES_PER_FRAME;
+	//Check for whether next instruction is part of this frame. If not, rebase event deadlines onto the next frame.
+	if ( gb->cycles >= GB_CYCLES_PER_FRAME ) {
+		gb->isFrameOver = true;
+		gb->cycles -= GB_CYCLES_PER_FRAME;
+		gb->frameCount += 1;
 
-		}//end if
+		for ( int i = 0; i < GB_EVENT_COUNT; ++i )
+			if ( gb->scheduler.deadlines[i] != GB_EVENT_NEVER ) gb->scheduler.deadlines[i] -= GB_CYCLES_PER_FRAME;
+		if ( gb->scheduler.nextDeadline != GB_EVENT_NEVER ) gb->scheduler.nextDeadline -= GB_CYCLES_PER_FRAME;
+		gb->cpu.ppu.lineStart -= GB_CYCLES_PER_FRAME; //May wrap, as only its distance from the cycle count is used
 
-		//TODO Tick PPU
+		//TODO Clear OAM Search results on end of frame
+	}//end if
 
+	return;
+}//end function GB_Cycle_T_States
 
-		//Increment cycles this frame
-		gb->cycles += 1;
-	}//end for
+/* Sets the deadline of the given event, or unschedules it if given GB_EVENT_NEVER, and updates the earliest deadline of all events. */
+void GB_Schedule_Event( GameBoy *gb, enum GB_EventID id, unsigned deadline ) {
+	gb->scheduler.deadlines[id] = deadline;
 
-	//Check for whether next instruction is part of this frame
-	if ( gb->cycles >= GB_CYCLES_PER_FRAME ) {
-		gb->isFrameOver = true;
-		gb->cycles %= GB_CYCLES_PER_FRAME;
+	gb->scheduler.nextDeadline = gb->scheduler.deadlines[0];
+	for ( int i = 1; i < GB_EVENT_COUNT; ++i )
+		if ( gb->scheduler.deadlines[i] < gb->scheduler.nextDeadline ) gb->scheduler.nextDeadline = gb->scheduler.deadlines[i];
 
-		//TODO Clear OAM Search results on end of frame
+	return;
+}//end function GB_Schedule_Event
+
+/* Schedules the initial events of a powered-on system at the start of a frame. */
+void GB_Reset_Scheduler( GameBoy *gb ) {
+	for ( int i = 0; i < GB_EVENT_COUNT; ++i )
+		gb->scheduler.deadlines[i] = GB_EVENT_NEVER;
+	gb->scheduler.dmaSource = 0x0000;
+
+	GB_Schedule_Event( gb, GB_EVENT_SCANLINE, GB_DOTS_PER_SCANLINE );
+	GB_Schedule_Event( gb, GB_EVENT_DIV, 256 );
+	GB_Update_Timer( gb );
+
+	return;
+}//end function GB_Reset_Scheduler
+
+/* Reschedules the next TIMA increment according to the TAC register. Must be called whenever TAC is written. */
+void GB_Update_Timer( GameBoy *gb ) {
+	if ( gb->io[0x07] & 0x04 ) GB_Schedule_Event( gb, GB_EVENT_TIMA, gb->cycles + Get_TIMA_Period( gb ) );
+	else GB_Schedule_Event( gb, GB_EVENT_TIMA, GB_EVENT_NEVER );
+
+	return;
+}//end function GB_Update_Timer
+
+/* Begins an OAM DMA transfer from the given source address high byte. OAM is blocked until the transfer completes. */
+void GB_Start_DMA( GameBoy *gb, uint8_t sourceHigh ) {
+	gb->scheduler.dmaSource = (uint16_t)sourceHigh << 8;
+	gb->cpu.ppu.isOAMBlocked = true;
+	GB_Schedule_Event( gb, GB_EVENT_DMA, gb->cycles + GB_DMA_CYCLES );
+
+	GB_TRACE( gb, GB_TRACE_DMA, gb->scheduler.dmaSource, 1 );
+
+	return;
+}//end function GB_Start_DMA
+
+/* Resets the DIV register to 0 and restarts its 256-cycle increment period. Must be called whenever DIV is written. */
+void GB_Reset_DIV( GameBoy *gb ) {
+	gb->io[0x04] = 0x00;
+	GB_TRACE( gb, GB_TRACE_REGISTER, 0xFF04, 0x00 );
+
+	GB_Schedule_Event( gb, GB_EVENT_DIV, gb->cycles + 256 );
+
+	return;
+}//end function GB_Reset_DIV
+
+/* Compares the LY and LYC registers, updating the STAT coincidence flag. If equal and enabled, requests LCD STAT interrupt. */
+void GB_Compare_LY_LYC( GameBoy *gb ) {
+	if ( gb->io[0x44] == gb->io[0x45] ) {
+		gb->io[0x41] |= 0x04;
+		if ( gb->io[0x41] & 0x40 ) {
+			gb->io[0x0F] |= GB_INT_STAT;
+			GB_TRACE( gb, GB_TRACE_INTERRUPT, 0xFF0F, GB_INT_STAT );
+		}//end if
+	}//end if
+	else gb->io[0x41] &= ~0x04;
+
+	return;
+}//end function GB_Compare_LY_LYC
+
+/*	Turns the LCD and PPU on or off. Must be called whenever bit 7 of the LCDC register changes.
+*	Turning the LCD off resets LY to 0 and holds the PPU in Mode 0. Turning it on restarts the first scanline from Mode 2.
+*/
+void GB_Set_LCD_Enabled( GameBoy *gb, bool isEnabled ) {
+	gb->io[0x44] = 0x00;
+
+	if ( isEnabled ) {
+		GB_Compare_LY_LYC( gb );
+		Set_PPU_Mode( gb, 2 );
+		GB_Schedule_Event( gb, GB_EVENT_SCANLINE, gb->cycles + GB_DOTS_PER_SCANLINE );
+		GB_Schedule_Event( gb, GB_EVENT_PPU_MODE, gb->cycles + GB_MODE2_DOTS );
 	}//end if
+	else {
+		Set_PPU_Mode( gb, 0 );
+		GB_Schedule_Event( gb, GB_EVENT_PPU_MODE, GB_EVENT_NEVER );
+		gb->lcdBlankThisFrame = true;
+		memset( gb->frame, 0, GB_LCD_HEIGHT * GB_LCD_PITCH ); //The LCD shows white while off
+	}//end if-else
+
+	GB_DEBUG( gb, "LCD turned %s.\n", isEnabled ? "on" : "off" );
 
 	return;
-}//end function GB_Increment_Cycles_This_Frame
\ No newline at end of file
+}//end function GB_Set_LCD_Enabled
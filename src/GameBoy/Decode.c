@@ -1,38 +1,113 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-#include "../EdBoy.h"
+#include "GameBoy.h"
+#include "Opcodes.h"
 
-/*	Decodes the next instruction at the current PC and calls the appropriate instruction function.
-*	Passes Game Boy joypad buttons pressed this frame to children functions that could write to I/O registers for potential JOYP register update.
-*	Notifies user via console and temporarily pauses execution upon encountering unknown or unimplemented opcode.
-*	Returns true if unknown opcode encountered and user quits mid-pause by closing emulator window. Otherwise, returns false.
+/*	Reports an illegal opcode through the system's log callback, then lets its host pause execution, if it has a callback to.
+*	Returns true if the host requests a quit mid-pause, such as by closing emulator window. Otherwise, returns false.
 */
-bool GB_Decode_Execute( GameBoy *gb, bool *isPressed ) {
-	bool didQuitMidPause = false; //Whether user requested to quit mid-pause upon pausing execution for unknown opcode.
-	uint8_t opcode; //The opcode of the encoded instruction
-
-	opcode = GB_Get_Next_Byte( gb );
-
-	//If first byte not 0xCB, decode opcode as normal
-	if ( opcode != 0xCB ) {
-		switch ( opcode ) {
-		default:
-			eprintf( "Unknown or unimplemented opcode 0x%02X\n", opcode );
-			didQuitMidPause = Pause_On_Unknown_Opcode();
-		}//end switch
-	}//end if
-
-	//If first byte 0xCB, decode as 0xCB-prefixed opcode
-	else {
-		opcode = GB_Get_Next_Byte( gb );
-
-		switch ( opcode ) {
-		default:
-			eprintf( "Unknown or unimplemented opcode 0xCB%02X\n", opcode );
-			didQuitMidPause = Pause_On_Unknown_Opcode();
-		}//end switch
-	}//end if-else
-
-	return didQuitMidPause;
-}//end function GB_Decode_Execute
\ No newline at end of file
+static bool Handle_Illegal_Opcode( GameBoy *gb, uint8_t opcode ) {
+	GB_ERROR( gb, "Illegal opcode 0x%02X at 0x%04X\n", opcode, (uint16_t)( gb->cpu.pc - 1 ) );
+
+	if ( gb->callbacks.pauseOnUnknownOpcode ) return gb->callbacks.pauseOnUnknownOpcode( gb->callbacks.userData );
+
+	return false;
+}//end function Handle_Illegal_Opcode
+
+#ifdef DEBUG
+/* Reports an instruction whose T-States match neither the not-taken nor the taken path listed by the opcode table. */
+static void Check_Cycles( const GameBoy *gb, const char *mnemonic, unsigned spent, unsigned cycles, unsigned takenCycles ) {
+	if ( spent != cycles && !( takenCycles && spent == cycles + takenCycles ) )
+		GB_ERROR( gb, "%s spent %u T-States, but the opcode table lists %u.\n", mnemonic, spent, cycles );
+
+	return;
+}//end function Check_Cycles
+#endif
+
+/* Reads the byte at the given address as GB_Read() does, but adds its 4 T-States to the given count instead of spending them. */
+static inline uint8_t Read_Deferred( GameBoy *gb, uint16_t addr, unsigned *pendingCycles ) {
+	uint8_t byte = GB_Read_Untimed( gb, addr ); //The byte read by this operation
+
+	GB_TRACE( gb, GB_TRACE_READ, addr, byte );
+	*pendingCycles += 4;
+
+	return byte;
+}//end function Read_Deferred
+
+/* Writes the given byte to the given address as GB_Write() does, but adds its 4 T-States to the given count instead of spending them. */
+static inline void Write_Deferred( GameBoy *gb, uint16_t addr, uint8_t value, unsigned *pendingCycles ) {
+	GB_Write_Untimed( gb, addr, value );
+	GB_TRACE( gb, GB_TRACE_WRITE, addr, value );
+	*pendingCycles += 4;
+
+	return;
+}//end function Write_Deferred
+
+/*	Per-access timing: Every memory access and internal delay ticks the system as it happens, so hardware sees each access on its exact T-State.	*/
+#define GB_CORE_NAME( name ) name##_Per_Access
+#define GB_CORE_LOCALS
+#define GB_CORE_FETCH() GB_Get_Next_Byte( gb )
+#define GB_CORE_READ( addr ) GB_Read( gb, ( addr ) )
+#define GB_CORE_WRITE( addr, value ) GB_Write( gb, ( addr ), ( value ) )
+#define GB_CORE_TICK( cycles ) GB_Cycle_T_States( gb, ( cycles ) )
+#define GB_CORE_FLUSH()
+#define GB_CORE_PENDING() 0u
+
+#include "Interpreter.h"
+
+#undef GB_CORE_NAME
+#undef GB_CORE_LOCALS
+#undef GB_CORE_FETCH
+#undef GB_CORE_READ
+#undef GB_CORE_WRITE
+#undef GB_CORE_TICK
+#undef GB_CORE_FLUSH
+#undef GB_CORE_PENDING
+
+/*	Per-instruction timing: Cycles are summed over the instruction, and ticked at once when it completes.
+*	Saves a pass through the scheduler per access, at the cost of hardware seeing every access at the instruction's first T-State.
+*/
+#define GB_CORE_NAME( name ) name##_Per_Instruction
+#define GB_CORE_LOCALS unsigned pendingCycles = 0; //T-States spent by the current instruction, but not yet ticked
+#define GB_CORE_FETCH() Read_Deferred( gb, gb->cpu.pc++, &pendingCycles )
+#define GB_CORE_READ( addr ) Read_Deferred( gb, ( addr ), &pendingCycles )
+#define GB_CORE_WRITE( addr, value ) Write_Deferred( gb, ( addr ), ( value ), &pendingCycles )
+#define GB_CORE_TICK( cycles ) ( pendingCycles += ( cycles ) )
+#define GB_CORE_FLUSH() do { GB_Cycle_T_States( gb, pendingCycles ); pendingCycles = 0; } while ( 0 )
+#define GB_CORE_PENDING() pendingCycles
+
+#include "Interpreter.h"
+
+#undef GB_CORE_NAME
+#undef GB_CORE_LOCALS
+#undef GB_CORE_FETCH
+#undef GB_CORE_READ
+#undef GB_CORE_WRITE
+#undef GB_CORE_TICK
+#undef GB_CORE_FLUSH
+#undef GB_CORE_PENDING
+
+//Interpreter whose memory accesses each tick the system as they happen
+const struct GB_CPUCore GB_CORE_PER_ACCESS = {
+	Decode_Execute_Per_Access,
+	Execute_Block_Per_Access,
+	Handle_Interrupts_Per_Access
+};
+
+//Interpreter which ticks the system once per instruction
+const struct GB_CPUCore GB_CORE_PER_INSTRUCTION = {
+	Decode_Execute_Per_Instruction,
+	Execute_Block_Per_Instruction,
+	Handle_Interrupts_Per_Instruction
+};
+
+/*	Halts the CPU until an interrupt is both requested and enabled.
+*	If IME is clear and an interrupt is already pending, the CPU does not halt, and instead fails to increment PC after the next opcode fetch.
+*/
+void GB_Halt( GameBoy *gb ) {
+	if ( !( gb->cpu.ime ) && ( gb->io[0x0F] & gb->cpu.hram[0x7F] & 0x1F ) ) gb->cpu.isHaltBug = true;
+	else gb->cpu.isHalted = true;
+
+	return;
+}//end function GB_Halt
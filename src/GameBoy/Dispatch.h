@@ -0,0 +1,58 @@
+/*	Instruction dispatch shared by the interpreter tiers. Deliberately has no include guard, and may be included once per function.
+*	Expands the opcode table from Opcodes.h into instruction handlers and runs the handler for the local uint8_t opcode.
+*	Execution then continues at the GB_Dispatch_End label, which users must place directly after including this file.
+*	Users must include Opcodes.h first, and define OP_ILLEGAL. All handlers expect a local GameBoy *gb.
+*	Users must also define GB_CHECK_CYCLES( mnemonic, operation, cycles ), expanded after each handler with its opcode table entry, to check the T-States it spent.
+*/
+
+#if GB_USE_COMPUTED_GOTO
+{
+	//Jump tables of handler labels, indexed by opcode
+#define GB_OPCODE( code, mnemonic, operation, operand1, operand2, cycles ) &&base_##code,
+	static const void *const baseHandlers[0x100] = { GB_BASE_OPCODES };
+#undef GB_OPCODE
+#define GB_OPCODE( code, mnemonic, operation, operand1, operand2, cycles ) &&cb_##code,
+	static const void *const cbHandlers[0x100] = { GB_CB_OPCODES };
+#undef GB_OPCODE
+
+#define OP_PREFIX_CB( o1, o2 ) { opcode = FETCH8(); goto *cbHandlers[opcode]; }
+
+	goto *baseHandlers[opcode];
+
+	//Instruction handlers
+#define GB_OPCODE( code, mnemonic, operation, operand1, operand2, cycles ) base_##code: OP_##operation( operand1, operand2 ) GB_CHECK_CYCLES( mnemonic, GB_OP_##operation, cycles ) goto GB_Dispatch_End;
+	GB_BASE_OPCODES
+#undef GB_OPCODE
+#define GB_OPCODE( code, mnemonic, operation, operand1, operand2, cycles ) cb_##code: OP_##operation( operand1, operand2 ) GB_CHECK_CYCLES( mnemonic, GB_OP_##operation, cycles ) goto GB_Dispatch_End;
+	GB_CB_OPCODES
+#undef GB_OPCODE
+
+#undef OP_PREFIX_CB
+}
+#else
+{
+	bool isPrefixed = false; //Whether the opcode is 0xCB, prefixing an opcode from the second table
+
+#define OP_PREFIX_CB( o1, o2 ) isPrefixed = true;
+
+	//If first byte not 0xCB, decode opcode as normal
+#define GB_OPCODE( code, mnemonic, operation, operand1, operand2, cycles ) case code: OP_##operation( operand1, operand2 ) GB_CHECK_CYCLES( mnemonic, GB_OP_##operation, cycles ) break;
+	switch ( opcode ) {
+	GB_BASE_OPCODES
+	}//end switch
+
+	//If first byte 0xCB, decode as 0xCB-prefixed opcode
+	if ( isPrefixed ) {
+		opcode = FETCH8();
+
+		switch ( opcode ) {
+		GB_CB_OPCODES
+		}//end switch
+	}//end if
+#undef GB_OPCODE
+
+#undef OP_PREFIX_CB
+
+	goto GB_Dispatch_End;
+}
+#endif
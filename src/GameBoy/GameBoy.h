@@ -0,0 +1,401 @@
+#pragma once
+
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "LibEdBoy.h"
+
+/*	Internal definitions of the emulator core, shared by every file of the core and by front ends which need more than LibEdBoy.h offers.
+*	Must not depend on SDL or any other part of a front end.
+*/
+
+/*	Game Boy Constants	*/
+#define GB_DOTS_PER_SCANLINE 456 //Number of PPU dots per Game Boy LCD scanline
+#define GB_CYCLES_PER_FRAME 70224 //Number of CPU cycles and PPU dots in one DMG Game Boy frame
+#define GB_SCANLINES_PER_FRAME 154 //Number of scanlines in one frame, including non-rendering VBlank scanlines
+#define GB_CLOCK_RATE 4194304 //Number of CPU cycles per second on the DMG Game Boy
+#define GB_VISIBLE_SCANLINES 144 //Number of rendering scanlines in one frame, before VBlank begins
+#define GB_MODE2_DOTS 80 //Number of PPU dots spent in Mode 2 (OAM Scan) per rendering scanline
+#define GB_MODE3_DOTS 172 //Number of PPU dots spent in Mode 3 (Drawing Pixels) per rendering scanline, without penalties
+#define GB_DMA_CYCLES 640 //Number of CPU cycles taken by an OAM DMA transfer
+
+/*	Interrupt Flags	*/
+#define GB_INT_VBLANK 0x01 //VBlank interrupt bit of IF/IE registers
+#define GB_INT_STAT 0x02 //LCD STAT interrupt bit of IF/IE registers
+#define GB_INT_TIMER 0x04 //Timer interrupt bit of IF/IE registers
+#define GB_INT_SERIAL 0x08 //Serial interrupt bit of IF/IE registers
+#define GB_INT_JOYPAD 0x10 //Joypad interrupt bit of IF/IE registers
+
+/*	Debug	*/
+//Tracing and debug messages are enabled by defining DEBUG at compile time (e.g. -DDEBUG). Release builds compile both to nothing.
+#ifdef DEBUG
+#define GB_TRACE( gb, kind, addr, value ) do { \
+	if ( ( gb )->trace && ( ( gb )->trace->mask & ( 1u << ( kind ) ) ) ) GB_Trace_Record( ( gb ), ( kind ), ( addr ), ( value ) ); \
+} while ( 0 ) //Records a trace event if tracing is enabled for its category
+#else
+#define GB_TRACE( gb, kind, addr, value ) do { } while ( 0 )
+#endif
+
+//The core reports errors and debug messages through each instance's log callback, rather than stdio, via these. Debug messages compile to nothing without DEBUG.
+#define GB_ERROR( gb, ... ) GB_Log( ( gb ), GB_LOG_ERROR, __VA_ARGS__ ) //Reports an error of the given instance
+#ifdef DEBUG
+#define GB_DEBUG( gb, ... ) GB_Log( ( gb ), GB_LOG_DEBUG, __VA_ARGS__ ) //Reports a debug message of the given instance. For infrequent events only.
+#else
+#define GB_DEBUG( gb, ... ) do { } while ( 0 )
+#endif
+
+#define GB_TRACE_CAPACITY 0x10000 //Number of records held by a trace ring buffer. Must be a power of two.
+
+/*	Block Cache	*/
+#define GB_BLOCK_CACHE_SIZE 0x2000 //Maximum number of pre-decoded blocks held by a block cache. Must be a power of two.
+#define GB_BLOCK_CACHE_MIN_SIZE 0x40 //Number of pre-decoded blocks held by a block cache with no cartridge ROM, for the boot ROM. Must be a power of two.
+#define GB_BLOCK_MAX_OPS 16 //Maximum number of instructions in one pre-decoded block
+
+/*	Image Cache	*/
+#define GB_HASH_SEED 0xCBF29CE484222325 //Initial value of a hash taken with GB_Hash_Bytes()
+
+/*	Save States	*/
+#define GB_STATE_VERSION 2 //Layout version of states written by this build. States of any other version are rejected.
+
+/*	Boot	*/
+#define GB_BOOT_MAX_FRAMES 600 //Maximum number of frames the boot ROM is run for, about 10 s. It locks up on a bad cartridge header.
+
+/*	Rewind	*/
+#define GB_REWIND_MAX_FRAMES 0x10000 //Maximum number of frames held by a rewind history, about 18 minutes. Must be a power of two.
+
+/*	Definitions	*/
+//Defines the attributes of a pixel currently in one of the PPU's Pixel FIFOs
+struct GB_FIFOPixel {
+	uint8_t colorIndex; //Pixel color as an index into the appropriate Palette register
+	uint8_t palette; //Value of Palette Number bit. For sprites only.
+	uint8_t priority; //Value of OBJ-to-BG Priority bit. For sprites only.
+};
+
+//Defines the state of the emulated Game Boy's PPU (Picture Processing Unit)
+struct GB_PictureProcessor {
+	bool isOAMBlocked; //Whether OAM access is currently blocked
+
+	uint8_t fetcherX; //X-Coordinate of PPU Pixel Fetcher
+	uint8_t fetcherY; //Y-Coordinate of PPU Pixel Fetcher
+
+	struct GB_FIFOPixel bgFIFO[16]; //Contents of BG Pixel FIFO
+	struct GB_FIFOPixel oamFIFO[16]; //Contents of sprite/OAM Pixel FIFO
+
+	uint8_t bgFIFOTail; //First free index of BG Pixel FIFO
+	uint8_t oamFIFOTail; //First free index of OAM Pixel FIFO
+
+	uint8_t oamScanResults[10]; //Indices of sprites in OAM found during Mode 2 for the scanline being rendered, in drawing priority
+	uint8_t oamScanCount; //Number of sprites found during Mode 2 for the scanline being rendered
+
+	uint8_t completedLines; //Number of scanlines of the current LCD frame which have completed Mode 3
+	uint8_t renderedLines; //Number of scanlines of the current LCD frame rendered into the LCD. Lags completedLines until a catch-up.
+	uint8_t line; //Scanline being rendered. Equals LY in the Pixel FIFO, but may be an earlier line in the fast path.
+
+	unsigned lineStart; //Cycle count at which Mode 3 began on the current scanline
+	bool isLineInFIFO; //Whether the current scanline is being rendered through the Pixel FIFO rather than the fast path
+	uint8_t lcdX; //X-Coordinate of next pixel pushed to the LCD by the Pixel FIFO
+	uint8_t discardCount; //Number of fetched pixels still to be discarded by the Pixel FIFO for fine scrolling
+	uint8_t nextSprite; //Index into oamScanResults of next sprite to be fetched by the Pixel FIFO
+	bool isFetchingWindow; //Whether the Pixel Fetcher has switched to the window on the current scanline
+
+	uint8_t windowLine; //Window's internal line counter. Counts scanlines on which the window was drawn this frame.
+	bool isWindowYTriggered; //Whether LY has matched WY this frame, enabling the window
+
+	uint8_t oam[0xA0]; //160 B Object Attribute Memory
+};
+
+//Defines categories of traced events. Used as bit indices into trace category masks.
+enum GB_TraceKind {
+	GB_TRACE_READ, //CPU memory read. Address and value read.
+	GB_TRACE_WRITE, //CPU memory write. Address and value written.
+	GB_TRACE_INVALID, //Access to the Unusable Area or an unused I/O register. Address accessed.
+	GB_TRACE_REGISTER, //Timed update of an I/O register, such as LY, DIV or TIMA. Register address and new value.
+	GB_TRACE_INTERRUPT, //Interrupt request. IF register address and requested interrupt bit.
+	GB_TRACE_PPU_MODE, //PPU mode change. LY register address and new mode.
+	GB_TRACE_DMA, //OAM DMA transfer start (value 1) or completion (value 0). Source address.
+	GB_TRACE_OPCODE, //Instruction execution. Opcode address and opcode.
+	GB_TRACE_KIND_COUNT //Number of trace categories
+};
+
+#define GB_TRACE_MASK_ALL ( ( 1u << GB_TRACE_KIND_COUNT ) - 1 ) //Trace category mask enabling every category
+
+//Defines one fixed-size binary trace record
+struct GB_TraceRecord {
+	uint32_t frame; //Frame count at time of event
+	uint32_t cycles; //Cycle count into frame at time of event
+	uint16_t pc; //Program counter at time of event
+	uint16_t addr; //Address associated with event
+	uint8_t value; //Value associated with event
+	uint8_t kind; //Category of event, as a GB_TraceKind
+};
+
+//Defines a lock-free single-producer, single-consumer ring buffer of trace records.
+//The emulation thread is the only producer, and never blocks: records are dropped if the buffer is full.
+struct GB_Trace {
+	atomic_uint head; //Total number of records written. Written only by the producer.
+	char headPadding[64]; //Keeps producer and consumer indices on separate cache lines
+	atomic_uint tail; //Total number of records read. Written only by the consumer.
+	char tailPadding[64]; //Keeps consumer index and producer-owned fields on separate cache lines
+
+	unsigned dropped; //Total number of records dropped because the buffer was full. Written only by the producer.
+	uint32_t mask; //Bit mask of enabled trace categories, indexed by GB_TraceKind
+
+	struct GB_TraceRecord records[GB_TRACE_CAPACITY]; //Record storage
+};
+
+//Defines IDs of timed events handled by the event scheduler. Used as indices into GB_Scheduler deadlines. Simultaneous events are handled in this order.
+enum GB_EventID {
+	GB_EVENT_SCANLINE, //End of scanline: increments LY, compares LY and LYC, and enters Mode 2 or Mode 1
+	GB_EVENT_PPU_MODE, //Mid-scanline PPU mode change: Mode 2 to Mode 3, or Mode 3 to Mode 0
+	GB_EVENT_DIV, //Increment of DIV register
+	GB_EVENT_TIMA, //Increment and potential overflow of TIMA register
+	GB_EVENT_DMA, //Completion of an in-progress OAM DMA transfer
+	GB_EVENT_COUNT //Number of event IDs
+};
+
+#define GB_EVENT_NEVER UINT_MAX //Deadline of an event that is not currently scheduled
+
+//Defines the state of the timestamp-ordered event scheduler which drives all timed behavior between CPU instructions
+struct GB_Scheduler {
+	unsigned deadlines[GB_EVENT_COUNT]; //Cycle count into current frame at which each event next occurs
+	unsigned nextDeadline; //Earliest of all event deadlines
+	uint16_t dmaSource; //Source address of in-progress OAM DMA transfer
+};
+
+//Defines one pre-decoded instruction of a cached block
+struct GB_MicroOp {
+	uint8_t opcode; //First opcode byte
+	uint8_t operands[2]; //Immediate operand bytes, or the second opcode byte of 0xCB-prefixed instructions
+	uint8_t length; //Length of instruction in bytes
+};
+
+//Defines a straight-line run of ROM instructions, ending at the first branch or at the end of its memory page
+struct GB_Block {
+	const uint8_t *tag; //Host address of first instruction, identifying both its ROM bank and address. NULL if empty.
+	uint8_t count; //Number of instructions in block. 0 if the first instruction cannot be cached.
+	struct GB_MicroOp ops[GB_BLOCK_MAX_OPS]; //Decoded instructions
+};
+
+//Defines a direct-mapped cache of pre-decoded ROM blocks, indexed by address of first instruction
+struct GB_BlockCache {
+	unsigned mask; //Number of blocks less one. The number of blocks is a power of two.
+	struct GB_Block blocks[]; //Blocks, sized to the loaded ROM
+};
+
+//Defines one variant of the interpreter, all compiled from GameBoy/Interpreter.h, differing only in how finely they tick the system
+struct GB_CPUCore {
+	bool ( *decodeExecute )( GameBoy *gb ); //Decodes and runs the next instruction. Returns true if the host quits mid-pause upon an illegal opcode.
+	bool ( *executeBlock )( GameBoy *gb ); //Runs the cached block at PC, or the next instruction if uncacheable. Requires a block cache. Returns as decodeExecute.
+	void ( *handleInterrupts )( GameBoy *gb ); //Services the highest-priority pending interrupt, if any
+};
+
+struct GB_JIT; //Dynamic recompiler state. Defined in GameBoy/JIT.c.
+
+struct GB_Rewind; //Rewind history of delta-compressed per-frame states. Defined in GameBoy/Rewind.c.
+
+struct GB_Save; //Save file attached to battery-backed external RAM. Defined in GameBoy/Save.c.
+
+//Defines how accesses to one 256-byte page of the 16-bit address bus are performed
+struct GB_MemoryPage {
+	uint8_t *readMemory; //Host pointer to the start of the page for direct reads, or NULL if reads go through the read handler
+	uint8_t ( *read )( GameBoy *gb, uint16_t addr ); //Read handler for I/O, OAM, blocked and unmapped pages
+
+	uint8_t *writeMemory; //Host pointer to the start of the page for direct writes, or NULL if writes go through the write handler
+	void ( *write )( GameBoy *gb, uint16_t addr, uint8_t value ); //Write handler for ROM, I/O, OAM, blocked and unmapped pages
+};
+
+//Declares an 8-bit register pair which can also be accessed as one 16-bit register, laid out for the host byte order
+#if defined( __BYTE_ORDER__ ) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define GB_REGISTER_PAIR( pair, high, low ) union { uint16_t pair; struct { uint8_t high; uint8_t low; }; }
+#else
+#define GB_REGISTER_PAIR( pair, high, low ) union { uint16_t pair; struct { uint8_t low; uint8_t high; }; }
+#endif
+
+//Defines the state of the emulated Game Boy's CPU/System on a Chip
+struct GB_Processor {
+	GB_REGISTER_PAIR( af, a, f ); //16-bit register pair AF. 8-bit accumulator register A and 8-bit flag register F
+	GB_REGISTER_PAIR( bc, b, c ); //16-bit register pair BC. 8-bit registers B and C
+	GB_REGISTER_PAIR( de, d, e ); //16-bit register pair DE. 8-bit registers D and E
+	GB_REGISTER_PAIR( hl, h, l ); //16-bit register pair HL. 8-bit registers H and L
+
+	uint16_t sp; //16-bit stack pointer register SP
+	uint16_t pc; //16-bit program counter register PC
+
+	uint8_t ime; //Interrupt Master Enable Flag IME
+	bool isIMEPending; //Whether IME is to be set after the next instruction, as requested by EI
+	bool isHalted; //Whether the CPU is halted until an interrupt is pending
+	bool isHaltBug; //Whether the next opcode fetch fails to increment PC, due to HALT while IME is clear and an interrupt is pending
+
+	uint8_t *boot; //256 B Boot ROM, shared through the image cache. Never written.
+
+	uint8_t hram[GB_HRAM_SIZE]; //128 B High RAM
+
+	struct GB_PictureProcessor ppu; //Picture Processing Unit
+};
+
+//Defines where the bytes given to GB_Acquire_Image() come from, and so whether the image cache takes ownership of them
+enum GB_ImageSource {
+	GB_IMAGE_BORROWED, //Owned by the caller. Copied if not already cached.
+	GB_IMAGE_ALLOCATED, //Allocated with malloc(). Owned by the cache.
+	GB_IMAGE_MAPPED //Read-only file mapping. Owned by the cache.
+};
+
+//Defines types of cartridge memory bank controller, as identified by the cartridge header
+enum GB_MBCType {
+	GB_MBC_NONE, //No MBC. 32 KB of ROM, and optionally 8 KB of RAM, always mapped.
+	GB_MBC1, //MBC1. Up to 2 MB of ROM and 32 KB of RAM.
+	GB_MBC3, //MBC3. Up to 2 MB of ROM and 32 KB of RAM. Its real-time clock is not emulated.
+	GB_MBC5 //MBC5. Up to 8 MB of ROM and 128 KB of RAM.
+};
+
+//Defines the state of the contents of the emulated Game Boy's cartridge slot
+struct GB_GamePak {
+	uint8_t *rom0; //16 KB lower addressable ROM Bank (Bank 00, or a higher bank in MBC1 mode 1). Points into romImage.
+	bool isROM0Blocked; //Whether lower ROM bank is currently blocked
+
+	uint8_t *rom1; //16 KB upper addressable ROM Bank (Bank 01 ~ NN). Points into romImage.
+	bool isROM1Blocked; //Whether upper ROM bank is currently blocked
+
+	uint8_t *extram; //8 KB addressable external RAM Bank. Points into extramImage. NULL if absent, disabled, or an MBC3 clock register is selected.
+	bool isExtRAMBlocked; //Whether external RAM bank is currently blocked
+	size_t extramSize; //Total size of external RAM in bytes. 0 if the cartridge has none.
+
+	uint8_t *romImage; //Entire cartridge ROM, shared through the image cache with every system running the same game. Never written. NULL if the cartridge slot is empty.
+	size_t romSize; //Size of romImage in bytes. A whole number of 16 KB banks, and at least two.
+	uint8_t *extramImage; //Entire external RAM. Always allocated, and private to the system. NULL if the cartridge has none.
+	bool hasBattery; //Whether the cartridge's external RAM is battery-backed, and so may be attached to a save file
+	struct GB_Save *save; //Attached save file, committed to at the end of every frame played. NULL unless attached with GB_Attach_Save().
+	bool isSaveStale; //Whether external RAM may differ from the attached save file, having been accessible or restored since last committed
+
+	/* Memory bank controller */
+	enum GB_MBCType mbc; //Type of memory bank controller
+	uint16_t romBank; //ROM bank number register, as written. Selects the upper ROM bank.
+	uint8_t ramBank; //RAM bank number register, as written. Selects the RAM bank, the MBC1 upper ROM bank bits, or an MBC3 clock register.
+	uint8_t bankMode; //MBC1 banking mode select register. In mode 1, the RAM bank number register also banks the lower ROM bank and RAM.
+	bool isExtRAMEnabled; //Whether external RAM is enabled by the RAM enable register. Always true without an MBC.
+};
+
+//Defines the total state of the emulated Game Boy system.
+//All emulated memory is held by value, so the whole system is one contiguous, cache-line-aligned block with frequently accessed state at its start.
+struct GB_System {
+	/* Game Boy components */
+	_Alignas( 64 ) struct GB_Processor cpu; //Game Boy SoC ("DMG-CPU")
+	uint8_t io[0x80]; //Game Boy memory-mapped I/O registers
+	uint8_t buttons; //Bit mask of joypad buttons pressed this frame, indexed by GameBoyButtonID
+
+	/* Timing */
+	struct GB_Scheduler scheduler; //Pending timed events, including DIV and TIMA increments
+	unsigned cycles; //Cycle count into current frame
+	bool isFrameOver; //Whether current frame has met or exceeded 70224 cycles
+	uint32_t frameCount; //Number of frames completed since initialization
+
+	/* Helper flags and variables */
+	bool isWRAMBlocked; //Whether WRAM access is currently blocked
+	bool isVRAMBlocked; //Whether VRAM access is currently blocked
+
+	bool lcdBlankThisFrame; //Whether LCD should not render drawn pixels during this frame
+	uint8_t *lcd; //LCD framebuffer being drawn by the PPU. One of lcdBuffers.
+	uint8_t *frame; //LCD framebuffer of the last complete frame, for display. The other of lcdBuffers, swapped with lcd upon VBlank.
+	unsigned suppressedFrames; //Number of upcoming LCD frames neither rendered nor displayed, such as frames run ahead of the displayed one. Counts down upon VBlank.
+	bool isRunningAhead; //Whether frames being run are run ahead, and will be undone. Such frames are neither recorded for rewinding nor committed to the save file.
+	bool doRenderPerDot; //Whether every scanline is rendered through the Pixel FIFO, rather than only those with mid-line register writes
+
+	struct GB_Callbacks callbacks; //Host program's callbacks. Cleared by GB_Init(), so set afterwards.
+
+	struct GB_GamePak cart; //Game Boy cartridge slot contents
+
+	struct GB_Trace *trace; //Trace ring buffer. NULL unless built with DEBUG.
+
+	const struct GB_CPUCore *core; //Interpreter variant running the CPU. Per-access timing unless changed with GB_Set_Timing().
+
+	struct GB_BlockCache *blockCache; //Pre-decoded ROM blocks, allocated when ROM is loaded. NULL if ROM code is run through the plain interpreter.
+	unsigned romMapCount; //Number of times ROM has been remapped. Ends a running cached or compiled block if changed mid-block.
+
+	struct GB_JIT *jit; //Dynamic recompiler state. NULL unless enabled with GB_JIT_Init().
+
+	struct GB_Rewind *rewind; //Rewind history, pushed to at the end of every frame. NULL unless enabled with GB_Rewind_Init().
+
+	/* Memory map and bulk memory */
+	_Alignas( 64 ) struct GB_MemoryPage memoryMap[0x100]; //Page table of the 16-bit address bus, indexed by the high byte of an address
+
+	_Alignas( 64 ) uint8_t wram[GB_WRAM_SIZE]; //8 KB Work RAM
+	_Alignas( 64 ) uint8_t vram[0x2000]; //8 KB Video RAM
+	_Alignas( 64 ) uint8_t lcdBuffers[2][GB_LCD_HEIGHT * GB_LCD_PITCH]; //Double-buffered 160 x 144 LCD screen, each stored contiguously by scanline
+};
+/*	Function Prototypes	*/
+void GB_Log( const GameBoy *gb, enum GB_LogLevel level, const char *format, ... ); //Log.c
+
+int GB_Init( GameBoy *gb ); //Init.c
+void GB_Deinit( GameBoy *gb ); //Init.c
+
+void GB_Load_BootROM( GameBoy *gb, char *path ); //Load.c
+int GB_Load_Game( GameBoy *gb, char *path ); //Load.c
+void GB_Unload_Game( GameBoy *gb ); //Load.c
+
+int GB_Attach_Save( GameBoy *gb, const char *path ); //Save.c
+void GB_Commit_Save( GameBoy *gb ); //Save.c
+int GB_Flush_Save( const GameBoy *gb ); //Save.c
+void GB_Detach_Save( GameBoy *gb ); //Save.c
+
+uint64_t GB_Hash_Bytes( uint64_t hash, const uint8_t *bytes, size_t size ); //Image.c
+uint8_t *GB_Acquire_Image( const GameBoy *gb, const uint8_t *bytes, size_t size, size_t imageSize, enum GB_ImageSource source ); //Image.c
+void GB_Release_Image( uint8_t *data ); //Image.c
+
+bool GB_Run_Frame( GameBoy *gb, uint8_t buttons ); //Cycle.c
+bool GB_Run_Frame_Ahead( GameBoy *gb, uint8_t buttons, unsigned frames, uint8_t *state, uint8_t *frame ); //Cycle.c
+void GB_Cycle_T_States( GameBoy *gb, unsigned cyclesIncrement ); //Cycle.c
+void GB_Reset_Scheduler( GameBoy *gb ); //Cycle.c
+void GB_Schedule_Event( GameBoy *gb, enum GB_EventID id, unsigned deadline ); //Cycle.c
+void GB_Update_Timer( GameBoy *gb ); //Cycle.c
+void GB_Start_DMA( GameBoy *gb, uint8_t sourceHigh ); //Cycle.c
+void GB_Reset_DIV( GameBoy *gb ); //Cycle.c
+void GB_Compare_LY_LYC( GameBoy *gb ); //Cycle.c
+void GB_Set_LCD_Enabled( GameBoy *gb, bool isEnabled ); //Cycle.c
+
+extern const struct GB_CPUCore GB_CORE_PER_ACCESS; //Decode.c
+extern const struct GB_CPUCore GB_CORE_PER_INSTRUCTION; //Decode.c
+void GB_Halt( GameBoy *gb ); //Decode.c
+
+int GB_Block_Cache_Init( GameBoy *gb ); //Block.c
+void GB_Block_Cache_Deinit( GameBoy *gb ); //Block.c
+void GB_Block_Cache_Flush( GameBoy *gb ); //Block.c
+void GB_Build_Block( struct GB_Block *block, const uint8_t *page, uint8_t offset ); //Block.c
+
+int GB_JIT_Init( GameBoy *gb, bool isChecked ); //JIT.c
+void GB_JIT_Deinit( GameBoy *gb ); //JIT.c
+void GB_JIT_Flush( GameBoy *gb ); //JIT.c
+bool GB_JIT_Execute( GameBoy *gb ); //JIT.c
+
+uint8_t GB_Read( GameBoy *gb, uint16_t addr ); //Read.c
+uint8_t GB_Read_Untimed( GameBoy *gb, uint16_t addr ); //Read.c
+uint8_t GB_Get_Next_Byte( GameBoy *gb ); //Read.c
+
+void GB_Write( GameBoy *gb, uint16_t addr, uint8_t value ); //Write.c
+void GB_Write_Untimed( GameBoy *gb, uint16_t addr, uint8_t value ); //Write.c
+
+void GB_Map_Memory( GameBoy *gb ); //Map.c
+void GB_Map_Cartridge( GameBoy *gb ); //Map.c
+void GB_Map_ROM( GameBoy *gb ); //Map.c
+void GB_Map_VRAM( GameBoy *gb ); //Map.c
+
+void GB_PPU_Render_Pending( GameBoy *gb ); //PPU.c
+void GB_PPU_Start_Line( GameBoy *gb, unsigned cycles ); //PPU.c
+void GB_PPU_End_Line( GameBoy *gb ); //PPU.c
+void GB_PPU_Catch_Up( GameBoy *gb ); //PPU.c
+void GB_PPU_End_Frame( GameBoy *gb ); //PPU.c
+
+int GB_Rewind_Init( GameBoy *gb, size_t capacity ); //Rewind.c
+void GB_Rewind_Deinit( GameBoy *gb ); //Rewind.c
+void GB_Rewind_Push( GameBoy *gb ); //Rewind.c
+bool GB_Rewind_Step( GameBoy *gb ); //Rewind.c
+void GB_Rewind_Print_Stats( const GameBoy *gb, FILE *out ); //Rewind.c
+
+int GB_Trace_Init( GameBoy *gb, uint32_t mask ); //Trace.c
+void GB_Trace_Deinit( GameBoy *gb ); //Trace.c
+void GB_Trace_Record( GameBoy *gb, enum GB_TraceKind kind, uint16_t addr, uint8_t value ); //Trace.c
+size_t GB_Trace_Drain( struct GB_Trace *trace, struct GB_TraceRecord *records, size_t maxRecords ); //Trace.c
+int GB_Trace_Format( const struct GB_TraceRecord *record, char *buffer, size_t size ); //Trace.c
\ No newline at end of file
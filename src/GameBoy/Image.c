@@ -0,0 +1,174 @@
+#define _DEFAULT_SOURCE //Exposes munmap() when compiling as strict ISO C
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined( _WIN32 )
+#include <sys/mman.h>
+#endif
+
+#include "GameBoy.h"
+
+/*	Process-wide cache of read-only ROM images, shared by every system in the process.
+*	Images are keyed by a hash of their contents, so systems loading the same cartridge or boot ROM, from any file or buffer,
+*	all point into one immutable copy of it. Each image is reference counted, and freed or unmapped when its last user releases it.
+*	The cache is guarded by a spin lock, as it is only touched while loading and unloading.
+*/
+
+//Defines one shared image in the cache
+struct GB_Image {
+	struct GB_Image *next; //Next image in the cache. NULL if last.
+	uint64_t hash; //Hash of the image's contents
+	size_t size; //Size of the contents in bytes, before padding
+	size_t imageSize; //Size of the image in bytes, including zero padding
+	uint8_t *data; //The image itself
+	bool isMapped; //Whether data is a read-only file mapping, rather than allocated
+	unsigned users; //Number of acquisitions not yet released
+};
+
+static struct GB_Image *imageCache = NULL; //All shared images, most recently added first
+static atomic_flag imageCacheLock = ATOMIC_FLAG_INIT; //Held while the cache is read or changed
+
+/* Acquires the cache lock, spinning until it is free. */
+static inline void Lock_Cache( void ) {
+	while ( atomic_flag_test_and_set_explicit( &imageCacheLock, memory_order_acquire ) );
+
+	return;
+}//end function Lock_Cache
+
+/* Releases the cache lock. */
+static inline void Unlock_Cache( void ) {
+	atomic_flag_clear_explicit( &imageCacheLock, memory_order_release );
+
+	return;
+}//end function Unlock_Cache
+
+/*	Continues the given 64-bit FNV-1a hash, taken a word at a time, over the given bytes. Start from GB_HASH_SEED.
+*	Not for adversarial input. Used to key cached images and boot snapshots.
+*/
+uint64_t GB_Hash_Bytes( uint64_t hash, const uint8_t *bytes, size_t size ) {
+	size_t i = 0; //Index of next byte to be hashed
+
+	for ( ; i + 8 <= size; i += 8 ) {
+		uint64_t word; //Next 8 bytes
+
+		memcpy( &word, bytes + i, 8 );
+		hash = ( hash ^ word ) * 0x100000001B3;
+	}//end for
+
+	for ( ; i < size; ++i )
+		hash = ( hash ^ bytes[i] ) * 0x100000001B3;
+
+	return hash;
+}//end function GB_Hash_Bytes
+
+/* Frees or unmaps an image's data, as it was obtained. */
+static void Free_Image_Data( uint8_t *data, size_t imageSize, bool isMapped ) {
+#if !defined( _WIN32 )
+	if ( isMapped ) munmap( data, imageSize );
+	else free( data );
+#else
+	(void)imageSize;
+	(void)isMapped;
+
+	free( data );
+#endif
+
+	return;
+}//end function Free_Image_Data
+
+/*	Returns a shared read-only image of imageSize bytes, holding the given size bytes of contents followed by zero padding.
+*	If an identical image is already cached, it is shared. Otherwise, a new one is added to the cache:
+*		GB_IMAGE_BORROWED: The contents are copied into a new image. The caller keeps the given bytes.
+*		GB_IMAGE_ALLOCATED: The given bytes, allocated with malloc() and already padded to imageSize, become the image.
+*		GB_IMAGE_MAPPED: The given bytes, a read-only mapping of imageSize bytes, become the image.
+*	Allocated and mapped bytes are owned by the cache from the call on, and are freed or unmapped at once if an identical image is shared instead.
+*	Every image returned must be released with GB_Release_Image(). Returns NULL if unable to allocate.
+*/
+uint8_t *GB_Acquire_Image( const GameBoy *gb, const uint8_t *bytes, size_t size, size_t imageSize, enum GB_ImageSource source ) {
+	uint64_t hash = GB_Hash_Bytes( GB_HASH_SEED, bytes, size ); //Hash of contents. Taken outside the lock.
+	struct GB_Image *image; //Cached image
+
+	Lock_Cache();
+
+	//Share an identical cached image, if any
+	for ( image = imageCache; image; image = image->next ) {
+		if ( image->hash == hash && image->size == size && image->imageSize == imageSize && !memcmp( image->data, bytes, size ) ) {
+			image->users += 1;
+			Unlock_Cache();
+
+			if ( source != GB_IMAGE_BORROWED ) Free_Image_Data( (uint8_t *)bytes, imageSize, source == GB_IMAGE_MAPPED );
+			GB_DEBUG( gb, "Sharing cached image (%zu bytes).\n", imageSize );
+
+			return image->data;
+		}//end if
+	}//end for
+
+	//Otherwise, add a new image
+	image = malloc( sizeof( struct GB_Image ) );
+	if ( image ) {
+		image->data = (uint8_t *)bytes;
+		if ( source == GB_IMAGE_BORROWED ) {
+			image->data = calloc( 1, imageSize );
+			if ( image->data ) memcpy( image->data, bytes, size );
+		}//end if
+	}//end if
+
+	if ( !image || !( image->data ) ) {
+		Unlock_Cache();
+
+		if ( source != GB_IMAGE_BORROWED ) Free_Image_Data( (uint8_t *)bytes, imageSize, source == GB_IMAGE_MAPPED );
+		free( image );
+		GB_ERROR( gb, "Unable to allocate memory for image.\n" );
+
+		return NULL;
+	}//end if
+
+	image->hash = hash;
+	image->size = size;
+	image->imageSize = imageSize;
+	image->isMapped = source == GB_IMAGE_MAPPED;
+	image->users = 1;
+	image->next = imageCache;
+	imageCache = image;
+
+	Unlock_Cache();
+
+	GB_DEBUG( gb, "Cached new image (%zu bytes).\n", imageSize );
+
+	return image->data;
+}//end function GB_Acquire_Image
+
+/* Releases an image returned by GB_Acquire_Image(), freeing or unmapping it if no other acquisition remains. Does nothing if data is NULL. */
+void GB_Release_Image( uint8_t *data ) {
+	struct GB_Image **link; //Link to the image being examined
+	struct GB_Image *image = NULL; //Image to be freed, if any
+
+	if ( !data ) return;
+
+	Lock_Cache();
+
+	for ( link = &imageCache; *link; link = &( ( *link )->next ) ) {
+		if ( ( *link )->data == data ) {
+			( *link )->users -= 1;
+			if ( !( ( *link )->users ) ) {
+				image = *link;
+				*link = image->next;
+			}//end if
+			break;
+		}//end if
+	}//end for
+
+	Unlock_Cache();
+
+	if ( image ) {
+		Free_Image_Data( image->data, image->imageSize, image->isMapped );
+		free( image );
+	}//end if
+
+	return;
+}//end function GB_Release_Image
@@ -2,234 +2,114 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
-#include <SDL_endian.h>
 
-#include "../Edboy.h"
+#include "GameBoy.h"
 
-/*	Initializes the emulated Game Boy system and allocates space for its memory.
+/*	Initializes the emulated Game Boy system.
+*	All emulated memory is held by value within the system, so no allocation takes place and the system may live in any suitably aligned storage.
 *	ROM Banks and external RAM for inserted cartridge is allocated in GB_Load_Game()
 *	Boot ROM memory is allocated in GB_Load_BootROM()
-*	Returns 0 if all memory allocation successful. Else, returns 1 if unable.
+*	Returns 0 if initialization successful. Else, returns 1 if unable.
 */
 int GB_Init( GameBoy *gb ) {
-	bool ableToAllocateIO = true; //Whether all I/O registers were able to be allocated.
-	bool ableToAllocateLCD = true; //Whether all LCD scanlines were able to be allocated.
 
-	//Allocate and configure WRAM
-	gb->wram = malloc( 0x2000 );
-	gb->isWRAMBlocked = false;
-
-	if( gb->wram ) dprintf( "WRAM allocated.\n" );
-	else {
-		eprintf( "Unable to allocate WRAM.\n" );
-		return 1;
-	}//end if-else
+	//Clear the entire system, including WRAM, VRAM, OAM, HRAM, I/O registers, and LCD
+	memset( gb, 0, sizeof( GameBoy ) );
+	GB_DEBUG( gb, "System memory cleared (%zu bytes).\n", sizeof( GameBoy ) );
 
-	//Allocate and configure VRAM
-	gb->vram = malloc( 0x2000 );
+	//Configure memory blocks
+	gb->isWRAMBlocked = false;
 	gb->isVRAMBlocked = false;
-	if ( gb->vram ) dprintf( "VRAM allocated.\n" );
-	else {
-		eprintf( "Unable to allocate VRAM.\n" );
-		return 1;
-	}//end if-else
-
-	//Allocate and configure OAM
-	gb->cpu.ppu.oam = malloc( 0xA0 );
 	gb->cpu.ppu.isOAMBlocked = false;
-	if ( gb->cpu.ppu.oam ) dprintf( "OAM allocated.\n" );
-	else {
-		eprintf( "Unable to allocate OAM.\n" );
-		return 1;
-	}//end if-else
 
 	//Configure cartridge ROM/RAM blocks
 	gb->cart.isROM0Blocked = false;
 	gb->cart.isROM1Blocked = false;
 	gb->cart.isExtRAMBlocked = false;
 
-	//Allocate and configure I/O registers
-	memset( gb->io, 0, 0x80 * sizeof( uint8_t * ) );
-
-	for ( int i = 0x00; i < 0x03; ++i ) {
-		gb->io[i] = malloc( 1 ); //0xFF00 - 0xFF02
-		if ( !( gb->io[i] ) ) {
-			ableToAllocateIO = false;
-			break;
-		}//end if
-	}//end for
-
-	for ( int i = 0x04; i < 0x08 && ableToAllocateIO; ++i ) {
-		gb->io[i] = malloc( 1 ); //0xFF04 - 0xFF07
-		if ( !( gb->io[i] ) ) {
-			ableToAllocateIO = false;
-			break;
-		}//end if
-	}//end for
-
-	for ( int i = 0x0F; i < 0x15 && ableToAllocateIO; ++i ) {
-		gb->io[i] = malloc( 1 ); //0xFF10 - 0xFF14
-		if ( !( gb->io[i] ) ) {
-			ableToAllocateIO = false;
-			break;
-		}//end if
-	}//end for
-
-	for ( int i = 0x16; i < 0x27 && ableToAllocateIO; ++i ) {
-		gb->io[i] = malloc( 1 ); //0xFF16 - 0xFF26
-		if ( !( gb->io[i] ) ) {
-			ableToAllocateIO = false;
-			break;
-		}//end if
-	}//end for
-
-	for ( int i = 0x30; i < 0x4C && ableToAllocateIO; ++i ) {
-		gb->io[i] = malloc( 1 ); //0xFF30 - 0xFF4B
-		if ( !( gb->io[i] ) ) {
-			ableToAllocateIO = false;
-			break;
-		}//end if
-	}//end for
-
-	gb->io[0x50] = malloc( 1 );	//0xFF50
-	if ( !( gb->io[0x50] ) ) ableToAllocateIO = false;
-
-	if( ableToAllocateIO ) dprintf( "I/O Registers allocated.\n" );
-	else {
-		eprintf( "Unable to allocate I/O Registers.\n" );
-		return 1;
-	}//end if-else
-
-	//Allocate and configure LCD
-	memset( gb->lcd, 0, GB_LCD_HEIGHT * sizeof( uint8_t * ) );
-	for ( int i = 0; i < GB_LCD_HEIGHT; ++i ) {
-		gb->lcd[i] = malloc( GB_LCD_WIDTH );
-		if ( !( gb->lcd[i] ) ) {
-			ableToAllocateLCD = false;
-			break;
-		}//end if
-	}//end for
+	//Configure LCD, drawing into the first framebuffer while displaying the second
 	gb->lcdBlankThisFrame = true;
-
-	if( ableToAllocateLCD ) dprintf( "LCD buffer allocated.\n" );
-	else {
-		eprintf( "Unable to allocate LCD scanlines.\n" );
-		return 1;
-	}//end if-else
-
-	//Allocate HRAM
-	gb->cpu.hram = malloc( 0x80 );
-	if ( gb->cpu.hram ) dprintf( "HRAM allocated.\n" );
-	else {
-		eprintf( "Unable to allocate HRAM.\n" );
-		return 1;
-	}//end if-else
-
-	//Configure CPU registers
-	gb->cpu.af = (uint16_t *)&( gb->cpu.regs[0] );
-	gb->cpu.bc = (uint16_t *)&( gb->cpu.regs[2] );
-	gb->cpu.de = (uint16_t *)&( gb->cpu.regs[4] );
-	gb->cpu.hl = (uint16_t *)&( gb->cpu.regs[6] );
-	dprintf( "CPU 16b register pair references set.\n" );
-
-	if ( SDL_BYTEORDER == SDL_BIG_ENDIAN ) {
-		gb->cpu.a = &( gb->cpu.regs[0] );
-		gb->cpu.f = &( gb->cpu.regs[1] );
-		gb->cpu.b = &( gb->cpu.regs[2] );
-		gb->cpu.c = &( gb->cpu.regs[3] );
-		gb->cpu.d = &( gb->cpu.regs[4] );
-		gb->cpu.e = &( gb->cpu.regs[5] );
-		gb->cpu.h = &( gb->cpu.regs[6] );
-		gb->cpu.l = &( gb->cpu.regs[7] );
-		dprintf( "CPU 8b register references set for Big Endian.\n" );
-	}//end if
-	else {
-		gb->cpu.a = &( gb->cpu.regs[1] );
-		gb->cpu.f = &( gb->cpu.regs[0] );
-		gb->cpu.b = &( gb->cpu.regs[3] );
-		gb->cpu.c = &( gb->cpu.regs[2] );
-		gb->cpu.d = &( gb->cpu.regs[5] );
-		gb->cpu.e = &( gb->cpu.regs[4] );
-		gb->cpu.h = &( gb->cpu.regs[7] );
-		gb->cpu.l = &( gb->cpu.regs[6] );
-		dprintf( "CPU 8b register references set for Little Endian.\n" );
-	}//end if-else
+	gb->lcd = gb->lcdBuffers[0];
+	gb->frame = gb->lcdBuffers[1];
 
 	//Configure PPU fetcher
 	gb->cpu.ppu.fetcherX = 0;
 	gb->cpu.ppu.fetcherY = 0;
 	gb->cpu.ppu.bgFIFOTail = 0;
-	gb->cpu.ppu.bgFIFOTail = 0;
-	dprintf( "PPU fetcher and FIFO indices initialized.\n" );
-
-	//Configure PPU OAM scan results buffer
-	memset( gb->cpu.ppu.oamScanResults, 0, 10 * sizeof( uint8_t * ) );
-	dprintf( "PPU OAM Scan results buffer initialized.\n" );
+	gb->cpu.ppu.oamFIFOTail = 0;
+	GB_DEBUG( gb, "PPU fetcher and FIFO indices initialized.\n" );
 
 	//Configure I/O Registers
-	*( gb->io[0x04] ) = 0x00; //DIV
-	*( gb->io[0x05] ) = 0x00; //TIMA
-	*( gb->io[0x07] ) = 0x00; //TAC
-	*( gb->io[0x44] ) = 0x00; //LY
+	gb->io[0x04] = 0x00; //DIV
+	gb->io[0x05] = 0x00; //TIMA
+	gb->io[0x07] = 0x00; //TAC
+	gb->io[0x0F] = 0x00; //IF
+	gb->io[0x40] = 0x00; //LCDC
+	gb->io[0x41] = 0x00; //STAT
+	gb->io[0x44] = 0x00; //LY
+	gb->io[0x45] = 0x00; //LYC
 	gb->cpu.hram[0x7F] = 0x00; //IE
 
-	//Configure I/O Register helper values
-	gb->cyclesNextDIV = 255;
-	gb->cyclesNextTIMA = 0;
-
-	//Set unloaded cartridge ROM/RAM banks to NULL
+	//Set unloaded cartridge ROM/RAM images, banks and boot ROM to NULL
 	gb->cart.rom0 = NULL;
 	gb->cart.rom1 = NULL;
 	gb->cart.extram = NULL;
-
-	//Initialize cycle count into current frame
+	gb->cart.extramSize = 0;
+	gb->cart.romImage = NULL;
+	gb->cart.romSize = 0;
+	gb->cart.extramImage = NULL;
+	gb->cart.hasBattery = false;
+	gb->cart.save = NULL;
+	gb->cart.isSaveStale = false;
+	gb->cart.mbc = GB_MBC_NONE;
+	gb->cart.romBank = 1;
+	gb->cart.ramBank = 0;
+	gb->cart.bankMode = 0;
+	gb->cart.isExtRAMEnabled = false;
+	gb->cpu.boot = NULL;
+	gb->io[0x50] = 0x01; //BANK
+
+	//Build memory map for empty cartridge slot
+	GB_Map_Memory( gb );
+
+	//Initialize cycle count into current frame and schedule initial timed events
 	gb->cycles = 0;
+	GB_Reset_Scheduler( gb );
 
-	return 0;
-}//end function GB_Init
-
-/* Frees memory allocated for the emulated Game Boy system and the loaded game. */
-void GB_Deinit( GameBoy *gb ) {
-	//Free WRAM
-	free( gb->wram );
-	dprintf( "Freed WRAM.\n" );
+	//Run the CPU with per-access timing, until a host chooses otherwise
+	gb->core = &GB_CORE_PER_ACCESS;
 
-	//Free VRAM
-	free( gb->vram );
-	dprintf( "Freed VRAM.\n" );
+	//Block cache is allocated when ROM is loaded, sized to it
+	gb->blockCache = NULL;
 
-	//Free OAM
-	free( gb->cpu.ppu.oam );
-	dprintf( "Freed OAM.\n" );
+	//Allocate trace buffer with all categories enabled, if built for debugging
+#ifdef DEBUG
+	if ( GB_Trace_Init( gb, GB_TRACE_MASK_ALL ) ) return 1;
+#endif
 
-	//Free IO Registers
-	for ( int i = 0; i < 0x80; ++i )
-		if ( gb->io[i] ) free( gb->io[i] );
-	dprintf( "Freed IO Registers, if allocated.\n" );
-
-	//Free LCD
-	for ( int i = 0; i < GB_LCD_HEIGHT; ++i )
-		if ( gb->lcd[i] ) free( gb->lcd[i] );
-	dprintf( "Freed LCD scanlines, if allocated.\n" );
+	return 0;
+}//end function GB_Init
 
-	//Free HRAM
-	free( gb->cpu.hram );
-	dprintf( "Freed HRAM.\n" );
+/* Frees memory allocated for the loaded game, boot ROM, recompiler, block cache, rewind history, and trace buffer. */
+void GB_Deinit( GameBoy *gb ) {
+	//Free recompiler and block cache
+	GB_JIT_Deinit( gb );
+	GB_Block_Cache_Deinit( gb );
 
-	//Free Boot ROM
-	if ( gb->cpu.boot ) free( gb->cpu.boot );
-	dprintf( "Freed Boot ROM, if allocated.\n" );
+	//Free rewind history
+	GB_Rewind_Deinit( gb );
 
-	//Free ROM banks
-	if ( gb->cart.rom0 ) free( gb->cart.rom0 );
-	dprintf( "Freed lower ROM bank, if allocated.\n" );
+	//Free trace buffer
+	GB_Trace_Deinit( gb );
 
-	if ( gb->cart.rom1 ) free( gb->cart.rom1 );
-	dprintf( "Freed upper ROM bank, if allocated.\n" );
+	//Release Boot ROM
+	GB_Release_Image( gb->cpu.boot );
+	gb->cpu.boot = NULL;
+	GB_DEBUG( gb, "Released Boot ROM, if loaded.\n" );
 
-	//Free external RAM
-	if ( gb->cart.extram ) free( gb->cart.extram );
-	dprintf( "Freed external RAM, if allocated.\n" );
+	//Release cartridge ROM, and free external RAM
+	GB_Unload_Game( gb );
+	GB_DEBUG( gb, "Unloaded game, if loaded.\n" );
 
 	return;
-}//end function GB_Deinit
\ No newline at end of file
+}//end function GB_Deinit
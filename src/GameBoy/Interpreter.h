@@ -0,0 +1,165 @@
+/*	Interpreter tiers, compiled once per timing granularity. Deliberately has no include guard, and is included once per variant.
+*	Defines a static decoder, block runner, and interrupt handler, named by GB_CORE_NAME, which users gather into a struct GB_CPUCore.
+*	Users must include Opcodes.h first, and define the following before including this file:
+*		GB_CORE_NAME( name ) - Names a function of this variant.
+*		GB_CORE_LOCALS - Declares any locals the macros below need. Expanded once at the top of each function.
+*		GB_CORE_FETCH() - Performs a timed read of the byte at PC, then increments PC.
+*		GB_CORE_READ( addr ) / GB_CORE_WRITE( addr, value ) - Performs a timed memory access.
+*		GB_CORE_TICK( cycles ) - Spends internal CPU cycles.
+*		GB_CORE_FLUSH() - Completes the timing of the instruction or interrupt just run. Expanded after each one.
+*		GB_CORE_PENDING() - T-States spent by the running instruction, but not yet ticked.
+*	A static Handle_Illegal_Opcode( gb, opcode ) must also be defined, returning true if the host requests a quit,
+*	and in DEBUG builds, a static Check_Cycles( gb, mnemonic, spent, cycles, takenCycles ) reporting any instruction whose T-States differ from the opcode table.
+*/
+
+#define GB_READ( addr ) GB_CORE_READ( addr )
+#define GB_WRITE( addr, value ) GB_CORE_WRITE( addr, value )
+#define TICK( cycles ) GB_CORE_TICK( cycles )
+
+//Each instruction's T-States are checked against the opcode table in DEBUG builds, counted from the cycle and frame counts before its opcode fetch
+#ifdef DEBUG
+#define GB_CHECK_BEGIN() do { startCycles = gb->cycles; startFrame = gb->frameCount; } while ( 0 )
+#define GB_CHECK_CYCLES( mnemonic, operation, listedCycles ) \
+	Check_Cycles( gb, mnemonic, gb->cycles - startCycles + ( gb->frameCount - startFrame ) * GB_CYCLES_PER_FRAME + GB_CORE_PENDING(), listedCycles, GB_TAKEN_CYCLES( operation ) );
+#else
+#define GB_CHECK_BEGIN()
+#define GB_CHECK_CYCLES( mnemonic, operation, listedCycles )
+#endif
+
+/*	Decodes the next instruction at the current PC and runs it.
+*	Each instruction is expanded from the opcode table in Opcodes.h into a handler, and dispatched by opcode through a jump table.
+*	Reports any illegal opcode, and lets the host pause execution upon it through the system's callback.
+*	Returns true if illegal opcode encountered and the host requests a quit mid-pause. Otherwise, returns false.
+*/
+static bool GB_CORE_NAME( Decode_Execute )( GameBoy *gb ) {
+	bool didQuitMidPause = false; //Whether user requested to quit mid-pause upon pausing execution for illegal opcode.
+	uint8_t opcode; //The opcode of the encoded instruction
+	GB_CORE_LOCALS
+#ifdef DEBUG
+	unsigned startCycles; //Cycle count before the instruction
+	uint32_t startFrame; //Frame count before the instruction
+#endif
+
+	GB_CHECK_BEGIN();
+	opcode = GB_CORE_FETCH();
+	GB_TRACE( gb, GB_TRACE_OPCODE, gb->cpu.pc - 1, opcode );
+
+	//HALT bug: The byte following HALT is read twice, as PC fails to increment
+	if ( gb->cpu.isHaltBug ) {
+		gb->cpu.isHaltBug = false;
+		gb->cpu.pc -= 1;
+	}//end if
+
+	//Instruction handlers perform timed memory accesses for every byte fetched
+#define FETCH8() GB_CORE_FETCH()
+#define OP_ILLEGAL( o1, o2 ) didQuitMidPause = Handle_Illegal_Opcode( gb, opcode );
+
+	//Run the instruction
+#include "Dispatch.h"
+GB_Dispatch_End:
+	GB_CORE_FLUSH();
+
+#undef FETCH8
+#undef OP_ILLEGAL
+
+	return didQuitMidPause;
+}//end function Decode_Execute
+
+/*	Runs the pre-decoded block of ROM instructions starting at the current PC, decoding and caching it first if not already cached.
+*	Blocks are identified by the host address of their first instruction, so a bank switch selects different blocks rather than stale ones.
+*	The block is left early if the frame ends, ROM is remapped, or an interrupt becomes serviceable.
+*	Instructions outside ROM, or in CPU states the cache does not model (EI delay, HALT bug), are run through Decode_Execute instead.
+*	Returns true if illegal opcode encountered and user quits mid-pause by closing emulator window. Otherwise, returns false.
+*/
+static bool GB_CORE_NAME( Execute_Block )( GameBoy *gb ) {
+	const struct GB_MemoryPage *page = &( gb->memoryMap[gb->cpu.pc >> 8] ); //Memory map entry of the page containing PC
+	struct GB_Block *block; //Cache entry for PC
+	unsigned romMapCount = gb->romMapCount; //ROM remap count when block started
+	GB_CORE_LOCALS
+#ifdef DEBUG
+	unsigned startCycles; //Cycle count before the running instruction
+	uint32_t startFrame; //Frame count before the running instruction
+#endif
+
+	if ( gb->cpu.pc >= 0x8000 || !( page->readMemory ) || gb->cpu.isIMEPending || gb->cpu.isHaltBug ) return GB_CORE_NAME( Decode_Execute )( gb );
+
+	block = &( gb->blockCache->blocks[gb->cpu.pc & gb->blockCache->mask] );
+	if ( block->tag != page->readMemory + ( gb->cpu.pc & 0xFF ) ) GB_Build_Block( block, page->readMemory, gb->cpu.pc & 0xFF );
+	if ( block->count == 0 ) return GB_CORE_NAME( Decode_Execute )( gb );
+
+	//Instruction handlers read their opcode and immediate operands from the pre-decoded instruction, but still spend 4 T-States per fetch
+#define FETCH8() ( TICK( 4 ), op->operands[operandIndex++] )
+	//Illegal opcodes are never cached, so are left to Decode_Execute to report
+#define OP_ILLEGAL( o1, o2 )
+
+	for ( uint8_t i = 0; i < block->count; ++i ) {
+		const struct GB_MicroOp *op = &( block->ops[i] ); //Instruction being run
+		unsigned operandIndex = 0; //Index of next operand byte fetched by the instruction
+		uint8_t opcode = op->opcode; //The opcode of the instruction
+
+		//Fetch opcode, and advance PC past the whole instruction
+		GB_CHECK_BEGIN();
+		GB_TRACE( gb, GB_TRACE_OPCODE, gb->cpu.pc, opcode );
+		gb->cpu.pc += op->length;
+		TICK( 4 );
+
+		//Run the instruction
+#include "Dispatch.h"
+GB_Dispatch_End:
+		GB_CORE_FLUSH();
+
+		if ( gb->isFrameOver || gb->romMapCount != romMapCount ) break;
+		if ( gb->cpu.ime && ( gb->io[0x0F] & gb->cpu.hram[0x7F] & 0x1F ) ) break;
+	}//end for
+
+#undef FETCH8
+#undef OP_ILLEGAL
+
+	return false;
+}//end function Execute_Block
+
+/*	Services the highest-priority interrupt that is both requested (IF register) and enabled (IE register), if any.
+*	Any such interrupt wakes the CPU from HALT, but is only serviced while IME is set.
+*	Servicing clears IME and the interrupt's request bit, then calls the interrupt's vector over 20 T-States.
+*/
+static void GB_CORE_NAME( Handle_Interrupts )( GameBoy *gb ) {
+	uint8_t pending = gb->io[0x0F] & gb->cpu.hram[0x7F] & 0x1F; //Interrupts both requested and enabled
+	GB_CORE_LOCALS
+
+	if ( !pending ) return;
+
+	gb->cpu.isHalted = false;
+	if ( !( gb->cpu.ime ) ) return;
+
+	//Lowest bit has highest priority
+	for ( int i = 0; i < 5; ++i ) {
+		if ( pending & ( 1 << i ) ) {
+			gb->cpu.ime = 0;
+			gb->cpu.isIMEPending = false;
+			gb->io[0x0F] &= ~( 1 << i );
+			GB_TRACE( gb, GB_TRACE_INTERRUPT, 0x0040 + 8 * i, 1 << i );
+
+			//HALT bug after EI: The interrupt returns to the HALT instruction, rather than the byte following it
+			if ( gb->cpu.isHaltBug ) {
+				gb->cpu.isHaltBug = false;
+				gb->cpu.pc -= 1;
+			}//end if
+
+			TICK( 8 );
+			PUSH16( gb->cpu.pc );
+			gb->cpu.pc = 0x0040 + 8 * i;
+			TICK( 4 );
+			GB_CORE_FLUSH();
+
+			break;
+		}//end if
+	}//end for
+
+	return;
+}//end function Handle_Interrupts
+
+#undef GB_READ
+#undef GB_WRITE
+#undef TICK
+#undef GB_CHECK_BEGIN
+#undef GB_CHECK_CYCLES
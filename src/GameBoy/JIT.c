@@ -0,0 +1,1360 @@
+#define _DEFAULT_SOURCE //Exposes MAP_ANONYMOUS when compiling as strict ISO C
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "GameBoy.h"
+
+/*	Dynamic recompiler from SM83 to x86-64 machine code.
+*	Hot ROM blocks are compiled into an executable buffer, and run with guest registers held in host registers.
+*	Memory accesses through directly-mapped pages and HRAM are performed inline. All others call back into the memory map handlers.
+*	Cycles are counted at compile time, and only passed to GB_Cycle_T_States before slow memory accesses and at block exit.
+*	Only available on x86-64 hosts using the System V calling convention. Compiled code does not record opcode trace events.
+*/
+#if defined( __x86_64__ ) && !defined( _WIN32 )
+
+#include <sys/mman.h>
+
+#include "Opcodes.h"
+
+#define JIT_BUFFER_SIZE 0x400000 //Size of executable code buffer in bytes
+#define JIT_BLOCK_RESERVE 0x4000 //Minimum free code buffer space needed to compile a block
+#define JIT_ENTRY_COUNT 0x2000 //Number of entries in the compiled block table. Must be a power of two.
+#define JIT_HOT_THRESHOLD 16 //Number of times a block is run by the interpreter before being compiled
+#define JIT_MAX_OPS 32 //Maximum number of instructions in one compiled block
+
+//Defines one entry of the compiled block table, indexed by address of first instruction
+struct GB_JITEntry {
+	const uint8_t *tag; //Host address of first instruction, identifying both its ROM bank and address. NULL if empty.
+	unsigned ( *code )( GameBoy *gb ); //Compiled block. Returns instructions run in bits 0-7 and T-States spent in the remaining bits. NULL if not compiled.
+	uint16_t hits; //Number of times block has been run by the interpreter
+	bool isUncompilable; //Whether the first instruction cannot be compiled, or the block failed a differential check
+};
+
+//Defines the state of the dynamic recompiler
+struct GB_JIT {
+	uint8_t *buffer; //Executable code buffer
+	size_t used; //Number of bytes of code buffer holding compiled blocks
+
+	struct GB_JITEntry entries[JIT_ENTRY_COUNT]; //Compiled block table
+
+	unsigned flushedCycles; //T-States into the running block already passed to GB_Cycle_T_States
+	unsigned romMapCount; //ROM remap count when the running block started
+	bool isExitRequested; //Set by slow memory accesses when the running block must exit after the current instruction
+
+	bool isChecked; //Whether each compiled block is checked against the interpreter
+	GameBoy *shadow; //Copy of the system run through the interpreter in differential-check mode. NULL if not checking.
+	unsigned long mismatches; //Number of compiled blocks which failed a differential check
+
+	unsigned long blocksCompiled; //Number of blocks compiled since initialization
+};
+
+//Defines host general-purpose registers by encoding number
+enum JIT_HostRegister {
+	HOST_RAX, HOST_RCX, HOST_RDX, HOST_RBX, HOST_RSP, HOST_RBP, HOST_RSI, HOST_RDI,
+	HOST_R8, HOST_R9, HOST_R10, HOST_R11, HOST_R12, HOST_R13, HOST_R14, HOST_R15
+};
+
+/*	Host register allocation within compiled blocks:
+*		R8 ~ R15 hold guest registers A, F, B, C, D, E, H, L, each zero-extended
+*		RBP holds guest SP, zero-extended
+*		RBX holds the GameBoy pointer
+*		RAX, RCX, RDX, RSI and RDI are scratch
+*	R8 ~ R11 are caller-saved, so are spilled to the stack around calls.
+*/
+#define HOST_NO_INDEX HOST_RSP //SIB index encoding for no index register
+#define JIT_SPILL_SLOTS 4 //Number of 8-byte stack slots used to spill caller-saved guest registers
+#define JIT_TEMP_SLOT ( 8 * JIT_SPILL_SLOTS ) //Stack offset of 4-byte temporary
+#define JIT_FRAME_SIZE 40 //Stack frame size. Keeps the stack 16-byte aligned at calls.
+
+//Host condition codes
+enum JIT_Condition {
+	CC_B = 0x2, //Below/Carry
+	CC_AE = 0x3, //Above or Equal/No Carry
+	CC_E = 0x4, //Equal/Zero
+	CC_NE = 0x5 //Not Equal/Not Zero
+};
+
+//Host ALU operations. Values are the r/m, r opcode of the 8-bit form. The 32-bit form is 1 higher, and the immediate form's ModRM digit is the value / 8.
+enum JIT_ALUOperation {
+	ALU_ADD = 0x00,
+	ALU_OR = 0x08,
+	ALU_ADC = 0x10,
+	ALU_SBB = 0x18,
+	ALU_AND = 0x20,
+	ALU_SUB = 0x28,
+	ALU_XOR = 0x30,
+	ALU_CMP = 0x38
+};
+
+//Host shift and rotate operations, as ModRM digits
+enum JIT_ShiftOperation {
+	SHIFT_ROL, SHIFT_ROR, SHIFT_RCL, SHIFT_RCR, SHIFT_SHL, SHIFT_SHR, SHIFT_SAL, SHIFT_SAR
+};
+
+//Defines SM83 operands, as named by the opcode table in Opcodes.h. Register C doubles as condition C.
+enum JIT_Operand {
+	JIT_ARG_NONE,
+	JIT_ARG_A, JIT_ARG_F, JIT_ARG_B, JIT_ARG_C, JIT_ARG_D, JIT_ARG_E, JIT_ARG_H, JIT_ARG_L,
+	JIT_ARG_HLI, JIT_ARG_HLIP, JIT_ARG_HLIM, JIT_ARG_BCI, JIT_ARG_DEI, JIT_ARG_CI, JIT_ARG_A8I, JIT_ARG_D8,
+	JIT_ARG_BC, JIT_ARG_DE, JIT_ARG_HL, JIT_ARG_SP, JIT_ARG_AF,
+	JIT_ARG_NZ, JIT_ARG_Z, JIT_ARG_NC,
+	JIT_ARG_D16, JIT_ARG_A16, JIT_ARG_R8, JIT_ARG_CB
+};
+
+//Numeric operands of RST and bit instructions are used as-is
+#define JIT_ARG_0 0
+#define JIT_ARG_1 1
+#define JIT_ARG_2 2
+#define JIT_ARG_3 3
+#define JIT_ARG_4 4
+#define JIT_ARG_5 5
+#define JIT_ARG_6 6
+#define JIT_ARG_7 7
+#define JIT_ARG_0x00 0x00
+#define JIT_ARG_0x08 0x08
+#define JIT_ARG_0x10 0x10
+#define JIT_ARG_0x18 0x18
+#define JIT_ARG_0x20 0x20
+#define JIT_ARG_0x28 0x28
+#define JIT_ARG_0x30 0x30
+#define JIT_ARG_0x38 0x38
+
+//Defines the operation and operands of one opcode
+struct JIT_OpcodeInfo {
+	uint8_t operation; //Operation, as a GB_Operation
+	uint8_t operand1; //First operand, as a JIT_Operand or number
+	uint8_t operand2; //Second operand, as a JIT_Operand or number
+};
+
+#define GB_OPCODE( code, mnemonic, operation, operand1, operand2, cycles ) [code] = { GB_OP_##operation, JIT_ARG_##operand1, JIT_ARG_##operand2 },
+static const struct JIT_OpcodeInfo BASE_OPCODE_INFO[0x100] = { GB_BASE_OPCODES }; //Operation and operands of each base opcode
+static const struct JIT_OpcodeInfo CB_OPCODE_INFO[0x100] = { GB_CB_OPCODES }; //Operation and operands of each 0xCB-prefixed opcode
+#undef GB_OPCODE
+
+//Host register holding each guest 8-bit register, indexed by JIT_Operand
+static const uint8_t GUEST_REGISTERS[] = {
+	[JIT_ARG_A] = HOST_R8, [JIT_ARG_F] = HOST_R9, [JIT_ARG_B] = HOST_R10, [JIT_ARG_C] = HOST_R11,
+	[JIT_ARG_D] = HOST_R12, [JIT_ARG_E] = HOST_R13, [JIT_ARG_H] = HOST_R14, [JIT_ARG_L] = HOST_R15
+};
+
+//Offset of each guest 8-bit register within the system, indexed by JIT_Operand
+static const int32_t GUEST_REGISTER_OFFSETS[] = {
+	[JIT_ARG_A] = offsetof( GameBoy, cpu.a ), [JIT_ARG_F] = offsetof( GameBoy, cpu.f ),
+	[JIT_ARG_B] = offsetof( GameBoy, cpu.b ), [JIT_ARG_C] = offsetof( GameBoy, cpu.c ),
+	[JIT_ARG_D] = offsetof( GameBoy, cpu.d ), [JIT_ARG_E] = offsetof( GameBoy, cpu.e ),
+	[JIT_ARG_H] = offsetof( GameBoy, cpu.h ), [JIT_ARG_L] = offsetof( GameBoy, cpu.l )
+};
+
+#define HOST_A HOST_R8
+#define HOST_F HOST_R9
+
+//Compiled code indexes the memory map by page number * 32
+_Static_assert( sizeof( struct GB_MemoryPage ) == 32, "Memory map entries must be 32 bytes" );
+
+//Defines how a compiled instruction sets each flag of the F register
+enum JIT_FlagSource {
+	FLAG_FROM_HOST, //Copied from the corresponding host flag (ZF, AF or CF)
+	FLAG_FROM_CL, //Carry only. Copied from CL, as saved by SETC before host carry was overwritten.
+	FLAG_CLEARED, //Reset to 0
+	FLAG_SET, //Set to 1
+	FLAG_KEPT //Left unchanged
+};
+
+//Defines the state of the block compiler
+struct JIT_Compiler {
+	uint8_t *code; //Start of code being emitted
+	size_t size; //Number of bytes emitted
+	size_t capacity; //Maximum number of bytes which may be emitted
+	bool isFull; //Whether emitted code exceeded capacity
+
+	struct GB_JIT *jit; //Recompiler state
+	const uint8_t *operands; //Immediate operand bytes of instruction being compiled
+	unsigned operandIndex; //Index of next immediate operand byte fetched
+	uint16_t pc; //Address following instruction being compiled
+	unsigned cycles; //T-States into block at current point of instruction being compiled
+	unsigned count; //Number of instructions compiled before instruction being compiled
+	bool hasSlowAccess; //Whether instruction being compiled may access memory through a handler
+};
+
+/*	Code Emission	*/
+
+/* Appends a byte of machine code. */
+static void Emit_Byte( struct JIT_Compiler *c, uint8_t byte ) {
+	if ( c->size < c->capacity ) c->code[c->size++] = byte;
+	else c->isFull = true;
+
+	return;
+}//end function Emit_Byte
+
+/* Appends a 32-bit little-endian value. */
+static void Emit_U32( struct JIT_Compiler *c, uint32_t value ) {
+	for ( int i = 0; i < 4; ++i )
+		Emit_Byte( c, value >> ( 8 * i ) );
+
+	return;
+}//end function Emit_U32
+
+/* Appends a 64-bit little-endian value. */
+static void Emit_U64( struct JIT_Compiler *c, uint64_t value ) {
+	for ( int i = 0; i < 8; ++i )
+		Emit_Byte( c, value >> ( 8 * i ) );
+
+	return;
+}//end function Emit_U64
+
+/* Appends a REX prefix, if needed. Byte-register instructions always take one, so encodings 4 ~ 7 select SPL ~ DIL rather than AH ~ BH. */
+static void Emit_REX( struct JIT_Compiler *c, bool isWide, int reg, int index, int base, bool isByte ) {
+	uint8_t rex = 0x40 | ( isWide << 3 ) | ( ( reg & 8 ) >> 1 ) | ( ( index & 8 ) >> 2 ) | ( ( base & 8 ) >> 3 ); //REX prefix
+
+	if ( rex != 0x40 || isByte ) Emit_Byte( c, rex );
+
+	return;
+}//end function Emit_REX
+
+/* Appends a one-byte opcode, or a two-byte opcode given as 0x0Fxx. */
+static void Emit_Opcode( struct JIT_Compiler *c, unsigned opcode ) {
+	if ( opcode > 0xFF ) Emit_Byte( c, opcode >> 8 );
+	Emit_Byte( c, opcode & 0xFF );
+
+	return;
+}//end function Emit_Opcode
+
+/* Appends an instruction with a register-direct ModRM operand. The reg field may be a register or an opcode extension digit. */
+static void Emit_Op_Reg( struct JIT_Compiler *c, bool isWide, bool isByte, unsigned opcode, int reg, int rm ) {
+	Emit_REX( c, isWide, reg, 0, rm, isByte );
+	Emit_Opcode( c, opcode );
+	Emit_Byte( c, 0xC0 | ( ( reg & 7 ) << 3 ) | ( rm & 7 ) );
+
+	return;
+}//end function Emit_Op_Reg
+
+/* Appends an instruction with a [base + index + disp32] memory operand. The reg field may be a register or an opcode extension digit. */
+static void Emit_Op_Mem( struct JIT_Compiler *c, bool isWide, bool isByte, unsigned opcode, int reg, int base, int index, int32_t disp ) {
+	Emit_REX( c, isWide, reg, index, base, isByte );
+	Emit_Opcode( c, opcode );
+	Emit_Byte( c, 0x84 | ( ( reg & 7 ) << 3 ) ); //mod = 10 (disp32), rm = 100 (SIB)
+	Emit_Byte( c, ( ( index & 7 ) << 3 ) | ( base & 7 ) ); //scale = 1
+	Emit_U32( c, (uint32_t)disp );
+
+	return;
+}//end function Emit_Op_Mem
+
+/* mov dst32, src32 */
+static void Emit_Mov( struct JIT_Compiler *c, int dst, int src ) {
+	Emit_Op_Reg( c, false, false, 0x89, src, dst );
+}//end function Emit_Mov
+
+/* mov dst64, src64 */
+static void Emit_Mov64( struct JIT_Compiler *c, int dst, int src ) {
+	Emit_Op_Reg( c, true, false, 0x89, src, dst );
+}//end function Emit_Mov64
+
+/* mov dst32, imm32 */
+static void Emit_Mov_Imm( struct JIT_Compiler *c, int dst, uint32_t imm ) {
+	Emit_REX( c, false, 0, 0, dst, false );
+	Emit_Byte( c, 0xB8 | ( dst & 7 ) );
+	Emit_U32( c, imm );
+}//end function Emit_Mov_Imm
+
+/* mov dst64, imm64 */
+static void Emit_Mov_Imm64( struct JIT_Compiler *c, int dst, uint64_t imm ) {
+	Emit_REX( c, true, 0, 0, dst, false );
+	Emit_Byte( c, 0xB8 | ( dst & 7 ) );
+	Emit_U64( c, imm );
+}//end function Emit_Mov_Imm64
+
+/* <op> dst32, src32 */
+static void Emit_ALU( struct JIT_Compiler *c, enum JIT_ALUOperation op, int dst, int src ) {
+	Emit_Op_Reg( c, false, false, op + 1, src, dst );
+}//end function Emit_ALU
+
+/* <op> dst8, src8 */
+static void Emit_ALU8( struct JIT_Compiler *c, enum JIT_ALUOperation op, int dst, int src ) {
+	Emit_Op_Reg( c, false, true, op, src, dst );
+}//end function Emit_ALU8
+
+/* <op> dst32, imm32 */
+static void Emit_ALU_Imm( struct JIT_Compiler *c, enum JIT_ALUOperation op, int dst, uint32_t imm ) {
+	Emit_Op_Reg( c, false, false, 0x81, op / 8, dst );
+	Emit_U32( c, imm );
+}//end function Emit_ALU_Imm
+
+/* <op> dst8, imm8 */
+static void Emit_ALU8_Imm( struct JIT_Compiler *c, enum JIT_ALUOperation op, int dst, uint8_t imm ) {
+	Emit_Op_Reg( c, false, true, 0x80, op / 8, dst );
+	Emit_Byte( c, imm );
+}//end function Emit_ALU8_Imm
+
+/* <shift> dst32, imm8 */
+static void Emit_Shift( struct JIT_Compiler *c, enum JIT_ShiftOperation op, int dst, uint8_t count ) {
+	Emit_Op_Reg( c, false, false, 0xC1, op, dst );
+	Emit_Byte( c, count );
+}//end function Emit_Shift
+
+/* <shift> dst8, imm8. Counts of 1 use the short form, which also sets flags for rotates. */
+static void Emit_Shift8( struct JIT_Compiler *c, enum JIT_ShiftOperation op, int dst, uint8_t count ) {
+	if ( count == 1 ) Emit_Op_Reg( c, false, true, 0xD0, op, dst );
+	else {
+		Emit_Op_Reg( c, false, true, 0xC0, op, dst );
+		Emit_Byte( c, count );
+	}//end if-else
+}//end function Emit_Shift8
+
+/* movzx dst32, src8 */
+static void Emit_Movzx8( struct JIT_Compiler *c, int dst, int src ) {
+	Emit_Op_Reg( c, false, true, 0x0FB6, dst, src );
+}//end function Emit_Movzx8
+
+/* movzx dst32, src16 */
+static void Emit_Movzx16( struct JIT_Compiler *c, int dst, int src ) {
+	Emit_Op_Reg( c, false, false, 0x0FB7, dst, src );
+}//end function Emit_Movzx16
+
+/* movzx dst32, byte [base + index + disp] */
+static void Emit_Load8( struct JIT_Compiler *c, int dst, int base, int index, int32_t disp ) {
+	Emit_Op_Mem( c, false, false, 0x0FB6, dst, base, index, disp );
+}//end function Emit_Load8
+
+/* movzx dst32, word [base + disp] */
+static void Emit_Load16( struct JIT_Compiler *c, int dst, int base, int32_t disp ) {
+	Emit_Op_Mem( c, false, false, 0x0FB7, dst, base, HOST_NO_INDEX, disp );
+}//end function Emit_Load16
+
+/* mov dst64, [base + index + disp] */
+static void Emit_Load64( struct JIT_Compiler *c, int dst, int base, int index, int32_t disp ) {
+	Emit_Op_Mem( c, true, false, 0x8B, dst, base, index, disp );
+}//end function Emit_Load64
+
+/* mov byte [base + index + disp], src8 */
+static void Emit_Store8( struct JIT_Compiler *c, int src, int base, int index, int32_t disp ) {
+	Emit_Op_Mem( c, false, true, 0x88, src, base, index, disp );
+}//end function Emit_Store8
+
+/* mov word [base + disp], src16 */
+static void Emit_Store16( struct JIT_Compiler *c, int src, int base, int32_t disp ) {
+	Emit_Byte( c, 0x66 );
+	Emit_Op_Mem( c, false, false, 0x89, src, base, HOST_NO_INDEX, disp );
+}//end function Emit_Store16
+
+/* mov word [base + disp], imm16 */
+static void Emit_Store16_Imm( struct JIT_Compiler *c, int base, int32_t disp, uint16_t imm ) {
+	Emit_Byte( c, 0x66 );
+	Emit_Op_Mem( c, false, false, 0xC7, 0, base, HOST_NO_INDEX, disp );
+	Emit_Byte( c, imm & 0xFF );
+	Emit_Byte( c, imm >> 8 );
+}//end function Emit_Store16_Imm
+
+/* lea dst32, [base + disp] */
+static void Emit_Lea( struct JIT_Compiler *c, int dst, int base, int32_t disp ) {
+	Emit_Op_Mem( c, false, false, 0x8D, dst, base, HOST_NO_INDEX, disp );
+}//end function Emit_Lea
+
+/* test reg8, imm8 */
+static void Emit_Test8_Imm( struct JIT_Compiler *c, int reg, uint8_t imm ) {
+	Emit_Op_Reg( c, false, true, 0xF6, 0, reg );
+	Emit_Byte( c, imm );
+}//end function Emit_Test8_Imm
+
+/* setcc reg8 */
+static void Emit_Setcc( struct JIT_Compiler *c, enum JIT_Condition cc, int reg ) {
+	Emit_Op_Reg( c, false, true, 0x0F90 | cc, 0, reg );
+}//end function Emit_Setcc
+
+/* bt reg32, imm8. Copies a bit into host carry. */
+static void Emit_BT( struct JIT_Compiler *c, int reg, uint8_t bit ) {
+	Emit_Op_Reg( c, false, false, 0x0FBA, 4, reg );
+	Emit_Byte( c, bit );
+}//end function Emit_BT
+
+/* jcc rel32. Returns position of the end of the displacement, for Emit_Patch. */
+static size_t Emit_Jcc( struct JIT_Compiler *c, enum JIT_Condition cc ) {
+	Emit_Byte( c, 0x0F );
+	Emit_Byte( c, 0x80 | cc );
+	Emit_U32( c, 0 );
+
+	return c->size;
+}//end function Emit_Jcc
+
+/* jmp rel32. Returns position of the end of the displacement, for Emit_Patch. */
+static size_t Emit_Jmp( struct JIT_Compiler *c ) {
+	Emit_Byte( c, 0xE9 );
+	Emit_U32( c, 0 );
+
+	return c->size;
+}//end function Emit_Jmp
+
+/* Points the jump ending at the given position to the current position. */
+static void Emit_Patch( struct JIT_Compiler *c, size_t jump ) {
+	uint32_t rel = (uint32_t)( c->size - jump ); //Displacement from end of jump
+
+	if ( c->isFull || jump > c->size ) return;
+	memcpy( c->code + jump - 4, &rel, 4 );
+
+	return;
+}//end function Emit_Patch
+
+/* Saves the caller-saved guest registers R8 ~ R11 to the stack. */
+static void Emit_Spill( struct JIT_Compiler *c ) {
+	for ( int i = 0; i < JIT_SPILL_SLOTS; ++i )
+		Emit_Op_Mem( c, true, false, 0x89, HOST_R8 + i, HOST_RSP, HOST_NO_INDEX, 8 * i );
+}//end function Emit_Spill
+
+/* Restores the caller-saved guest registers R8 ~ R11 from the stack. */
+static void Emit_Reload( struct JIT_Compiler *c ) {
+	for ( int i = 0; i < JIT_SPILL_SLOTS; ++i )
+		Emit_Load64( c, HOST_R8 + i, HOST_RSP, HOST_NO_INDEX, 8 * i );
+}//end function Emit_Reload
+
+/* mov rax, <function>; call rax */
+static void Emit_Call( struct JIT_Compiler *c, const void *function ) {
+	Emit_Mov_Imm64( c, HOST_RAX, (uint64_t)(uintptr_t)function );
+	Emit_Byte( c, 0xFF );
+	Emit_Byte( c, 0xD0 );
+}//end function Emit_Call
+
+/*	Guest State	*/
+
+/* Returns whether the given operand is an 8-bit guest register. */
+static bool Is_Register( uint8_t operand ) {
+	return operand >= JIT_ARG_A && operand <= JIT_ARG_L;
+}//end function Is_Register
+
+/* Returns the high and low host registers of the given guest register pair, other than SP. */
+static void Get_Pair_Registers( uint8_t pair, int *high, int *low ) {
+	switch ( pair ) {
+	case JIT_ARG_BC: *high = GUEST_REGISTERS[JIT_ARG_B]; *low = GUEST_REGISTERS[JIT_ARG_C]; break;
+	case JIT_ARG_DE: *high = GUEST_REGISTERS[JIT_ARG_D]; *low = GUEST_REGISTERS[JIT_ARG_E]; break;
+	case JIT_ARG_HL: *high = GUEST_REGISTERS[JIT_ARG_H]; *low = GUEST_REGISTERS[JIT_ARG_L]; break;
+	default: *high = HOST_A; *low = HOST_F; break;
+	}//end switch
+}//end function Get_Pair_Registers
+
+/* Loads the value of the given guest register pair into the given scratch register. */
+static void Emit_Load_Pair( struct JIT_Compiler *c, uint8_t pair, int dst ) {
+	int high, low; //Host registers of pair
+
+	if ( pair == JIT_ARG_SP ) {
+		Emit_Mov( c, dst, HOST_RBP );
+		return;
+	}//end if
+
+	Get_Pair_Registers( pair, &high, &low );
+	Emit_Mov( c, dst, high );
+	Emit_Shift( c, SHIFT_SHL, dst, 8 );
+	Emit_ALU( c, ALU_OR, dst, low );
+}//end function Emit_Load_Pair
+
+/* Stores the 16-bit value in the given scratch register into the given guest register pair. */
+static void Emit_Store_Pair( struct JIT_Compiler *c, uint8_t pair, int src ) {
+	int high, low; //Host registers of pair
+
+	if ( pair == JIT_ARG_SP ) {
+		Emit_Movzx16( c, HOST_RBP, src );
+		return;
+	}//end if
+
+	Get_Pair_Registers( pair, &high, &low );
+	if ( pair == JIT_ARG_AF ) {
+		Emit_Mov( c, low, src );
+		Emit_ALU_Imm( c, ALU_AND, low, 0xF0 ); //Lower 4 bits of F are always 0
+	}//end if
+	else Emit_Movzx8( c, low, src );
+	Emit_Movzx16( c, high, src );
+	Emit_Shift( c, SHIFT_SHR, high, 8 );
+}//end function Emit_Store_Pair
+
+/* Adds the given amount to guest SP, wrapping at 16 bits. */
+static void Emit_Adjust_SP( struct JIT_Compiler *c, int32_t amount ) {
+	Emit_Lea( c, HOST_RBP, HOST_RBP, amount );
+	Emit_Movzx16( c, HOST_RBP, HOST_RBP );
+}//end function Emit_Adjust_SP
+
+/* Stores all guest registers held in host registers back into the system. */
+static void Emit_Store_Guest( struct JIT_Compiler *c ) {
+	for ( int r = JIT_ARG_A; r <= JIT_ARG_L; ++r )
+		Emit_Store8( c, GUEST_REGISTERS[r], HOST_RBX, HOST_NO_INDEX, GUEST_REGISTER_OFFSETS[r] );
+	Emit_Store16( c, HOST_RBP, HOST_RBX, offsetof( GameBoy, cpu.sp ) );
+}//end function Emit_Store_Guest
+
+/*	Emits a block exit: stores guest registers and PC, then returns the number of instructions run and T-States spent.
+*	PC is taken from the given host register, or is the given constant if the register is negative.
+*/
+static void Emit_Exit( struct JIT_Compiler *c, int pcRegister, uint16_t pc, unsigned cycles, unsigned count ) {
+	Emit_Store_Guest( c );
+	if ( pcRegister >= 0 ) Emit_Store16( c, pcRegister, HOST_RBX, offsetof( GameBoy, cpu.pc ) );
+	else Emit_Store16_Imm( c, HOST_RBX, offsetof( GameBoy, cpu.pc ), pc );
+	Emit_Mov_Imm( c, HOST_RAX, ( cycles << 8 ) | count );
+
+	//Epilogue
+	Emit_Op_Reg( c, true, false, 0x83, 0, HOST_RSP ); //add rsp, imm8
+	Emit_Byte( c, JIT_FRAME_SIZE );
+	for ( int r = HOST_R15; r >= HOST_R12; --r ) {
+		Emit_REX( c, false, 0, 0, r, false );
+		Emit_Byte( c, 0x58 | ( r & 7 ) ); //pop
+	}//end for
+	Emit_Byte( c, 0x58 | HOST_RBP );
+	Emit_Byte( c, 0x58 | HOST_RBX );
+	Emit_Byte( c, 0xC3 ); //ret
+}//end function Emit_Exit
+
+/* Emits the block prologue: saves callee-saved host registers and loads guest registers from the system. */
+static void Emit_Prologue( struct JIT_Compiler *c ) {
+	Emit_Byte( c, 0x50 | HOST_RBX );
+	Emit_Byte( c, 0x50 | HOST_RBP );
+	for ( int r = HOST_R12; r <= HOST_R15; ++r ) {
+		Emit_REX( c, false, 0, 0, r, false );
+		Emit_Byte( c, 0x50 | ( r & 7 ) ); //push
+	}//end for
+	Emit_Op_Reg( c, true, false, 0x83, 5, HOST_RSP ); //sub rsp, imm8
+	Emit_Byte( c, JIT_FRAME_SIZE );
+
+	Emit_Mov64( c, HOST_RBX, HOST_RDI );
+	for ( int r = JIT_ARG_A; r <= JIT_ARG_L; ++r )
+		Emit_Load8( c, GUEST_REGISTERS[r], HOST_RBX, HOST_NO_INDEX, GUEST_REGISTER_OFFSETS[r] );
+	Emit_Load16( c, HOST_RBP, HOST_RBX, offsetof( GameBoy, cpu.sp ) );
+}//end function Emit_Prologue
+
+/*	Slow Memory Access	*/
+
+/* Requests that the running block exits after the current instruction if ROM was remapped or an interrupt became serviceable. */
+static void Check_Exit( GameBoy *gb ) {
+	struct GB_JIT *jit = gb->jit; //Recompiler state
+
+	if ( gb->romMapCount != jit->romMapCount || ( gb->cpu.ime && ( gb->io[0x0F] & gb->cpu.hram[0x7F] & 0x1F ) ) ) jit->isExitRequested = true;
+
+	return;
+}//end function Check_Exit
+
+/* Catches timed events up to the given T-State count into the running block, then reads through the memory map. Called by compiled code. */
+static unsigned JIT_Read( GameBoy *gb, unsigned addr, unsigned cycles ) {
+	uint8_t value; //The byte read
+
+	GB_Cycle_T_States( gb, cycles - gb->jit->flushedCycles );
+	gb->jit->flushedCycles = cycles;
+
+	value = GB_Read_Untimed( gb, addr );
+	GB_TRACE( gb, GB_TRACE_READ, addr, value );
+	Check_Exit( gb );
+
+	return value;
+}//end function JIT_Read
+
+/* Catches timed events up to the given T-State count into the running block, then writes through the memory map. Called by compiled code. */
+static void JIT_Write( GameBoy *gb, unsigned addr, unsigned value, unsigned cycles ) {
+	GB_Cycle_T_States( gb, cycles - gb->jit->flushedCycles );
+	gb->jit->flushedCycles = cycles;
+
+	GB_Write_Untimed( gb, addr, value );
+	GB_TRACE( gb, GB_TRACE_WRITE, addr, value );
+	Check_Exit( gb );
+
+	return;
+}//end function JIT_Write
+
+/*	Emits a lookup of the host memory for the guest address in EDI, leaving it in RDX.
+*	VRAM is remapped by PPU mode changes, which compiled code may not have caught up with, so is always accessed through the memory map handlers.
+*	Returns the jumps to patch to the slow path, taken if the page is VRAM or has no host memory.
+*/
+static void Emit_Page_Lookup( struct JIT_Compiler *c, size_t field, size_t *isVRAM, size_t *isUnmapped ) {
+	Emit_Mov( c, HOST_RAX, HOST_RDI );
+	Emit_Shift( c, SHIFT_SHR, HOST_RAX, 8 );
+	Emit_Lea( c, HOST_RDX, HOST_RAX, -0x80 );
+	Emit_ALU_Imm( c, ALU_CMP, HOST_RDX, 0x20 );
+	*isVRAM = Emit_Jcc( c, CC_B );
+	Emit_Shift( c, SHIFT_SHL, HOST_RAX, 5 );
+	Emit_Load64( c, HOST_RDX, HOST_RBX, HOST_RAX, offsetof( GameBoy, memoryMap ) + field );
+	Emit_Op_Reg( c, true, false, 0x85, HOST_RDX, HOST_RDX ); //test rdx, rdx
+	*isUnmapped = Emit_Jcc( c, CC_E );
+}//end function Emit_Page_Lookup
+
+/*	Emits a read of the guest address in EDI into EAX, taking 4 T-States.
+*	Directly-mapped pages other than VRAM, and HRAM, are read inline. All other addresses call JIT_Read. Clobbers all scratch registers.
+*/
+static void Emit_Read( struct JIT_Compiler *c ) {
+	size_t isVRAM, isUnmapped, call, done, hramDone; //Jumps to patch
+
+	//Directly-mapped page
+	Emit_Page_Lookup( c, offsetof( struct GB_MemoryPage, readMemory ), &isVRAM, &isUnmapped );
+	Emit_Movzx8( c, HOST_RAX, HOST_RDI );
+	Emit_Load8( c, HOST_RAX, HOST_RDX, HOST_RAX, 0 );
+	done = Emit_Jmp( c );
+
+	//HRAM, except IE register
+	Emit_Patch( c, isVRAM );
+	Emit_Patch( c, isUnmapped );
+	Emit_Lea( c, HOST_RAX, HOST_RDI, -0xFF80 );
+	Emit_ALU_Imm( c, ALU_CMP, HOST_RAX, 0x7F );
+	call = Emit_Jcc( c, CC_AE );
+	Emit_Load8( c, HOST_RAX, HOST_RBX, HOST_RDI, (int32_t)offsetof( GameBoy, cpu.hram ) - 0xFF80 );
+	hramDone = Emit_Jmp( c );
+
+	//Memory map handler
+	Emit_Patch( c, call );
+	Emit_Spill( c );
+	Emit_Mov( c, HOST_RSI, HOST_RDI );
+	Emit_Mov_Imm( c, HOST_RDX, c->cycles );
+	Emit_Mov64( c, HOST_RDI, HOST_RBX );
+	Emit_Call( c, (const void *)JIT_Read );
+	Emit_Reload( c );
+
+	Emit_Patch( c, done );
+	Emit_Patch( c, hramDone );
+
+	c->cycles += 4;
+	c->hasSlowAccess = true;
+}//end function Emit_Read
+
+/*	Emits a write of CL to the guest address in EDI, taking 4 T-States.
+*	Directly-mapped pages other than VRAM, and HRAM, are written inline. All other addresses call JIT_Write. Clobbers all scratch registers.
+*/
+static void Emit_Write( struct JIT_Compiler *c ) {
+	size_t isVRAM, isUnmapped, call, done, hramDone; //Jumps to patch
+
+	//Directly-mapped page
+	Emit_Page_Lookup( c, offsetof( struct GB_MemoryPage, writeMemory ), &isVRAM, &isUnmapped );
+	Emit_Movzx8( c, HOST_RAX, HOST_RDI );
+	Emit_Store8( c, HOST_RCX, HOST_RDX, HOST_RAX, 0 );
+	done = Emit_Jmp( c );
+
+	//HRAM, except IE register
+	Emit_Patch( c, isVRAM );
+	Emit_Patch( c, isUnmapped );
+	Emit_Lea( c, HOST_RAX, HOST_RDI, -0xFF80 );
+	Emit_ALU_Imm( c, ALU_CMP, HOST_RAX, 0x7F );
+	call = Emit_Jcc( c, CC_AE );
+	Emit_Store8( c, HOST_RCX, HOST_RBX, HOST_RDI, (int32_t)offsetof( GameBoy, cpu.hram ) - 0xFF80 );
+	hramDone = Emit_Jmp( c );
+
+	//Memory map handler
+	Emit_Patch( c, call );
+	Emit_Spill( c );
+	Emit_Mov( c, HOST_RSI, HOST_RDI );
+	Emit_Mov( c, HOST_RDX, HOST_RCX );
+	Emit_Mov_Imm( c, HOST_RCX, c->cycles );
+	Emit_Mov64( c, HOST_RDI, HOST_RBX );
+	Emit_Call( c, (const void *)JIT_Write );
+	Emit_Reload( c );
+
+	Emit_Patch( c, done );
+	Emit_Patch( c, hramDone );
+
+	c->cycles += 4;
+	c->hasSlowAccess = true;
+}//end function Emit_Write
+
+/*	Instruction Compilation	*/
+
+/* Returns the next immediate operand byte of the instruction being compiled, taking 4 T-States to fetch. */
+static uint8_t Fetch_Operand( struct JIT_Compiler *c ) {
+	c->cycles += 4;
+
+	return c->operands[c->operandIndex++];
+}//end function Fetch_Operand
+
+/* Returns the next two immediate operand bytes of the instruction being compiled as a 16-bit value, taking 8 T-States to fetch. */
+static uint16_t Fetch_Operand16( struct JIT_Compiler *c ) {
+	uint16_t value = Fetch_Operand( c ); //Low byte
+
+	return value | ( Fetch_Operand( c ) << 8 );
+}//end function Fetch_Operand16
+
+/* Emits computation of the address of the given memory operand into EDI, applying any post-increment or decrement of HL. */
+static void Emit_Address( struct JIT_Compiler *c, uint8_t operand ) {
+	switch ( operand ) {
+	case JIT_ARG_BCI: Emit_Load_Pair( c, JIT_ARG_BC, HOST_RDI ); break;
+	case JIT_ARG_DEI: Emit_Load_Pair( c, JIT_ARG_DE, HOST_RDI ); break;
+	default: Emit_Load_Pair( c, JIT_ARG_HL, HOST_RDI ); break;
+	}//end switch
+
+	if ( operand == JIT_ARG_HLIP || operand == JIT_ARG_HLIM ) {
+		Emit_Lea( c, HOST_RDX, HOST_RDI, operand == JIT_ARG_HLIP ? 1 : -1 );
+		Emit_Store_Pair( c, JIT_ARG_HL, HOST_RDX );
+	}//end if
+}//end function Emit_Address
+
+/* Emits loading of the given 8-bit source operand. Returns the host register holding it: a guest register, or EAX. */
+static int Emit_Get8( struct JIT_Compiler *c, uint8_t operand ) {
+	if ( Is_Register( operand ) ) return GUEST_REGISTERS[operand];
+
+	if ( operand == JIT_ARG_D8 ) Emit_Mov_Imm( c, HOST_RAX, Fetch_Operand( c ) );
+	else {
+		Emit_Address( c, operand );
+		Emit_Read( c );
+	}//end if-else
+
+	return HOST_RAX;
+}//end function Emit_Get8
+
+/*	Emits conversion of host flags into guest register F, as set by the preceding host instruction.
+*	Host flags are captured with LAHF, so the result of the preceding instruction must not be in AH. Clobbers EAX bits 8-15, EDX and ESI.
+*/
+static void Emit_Flags( struct JIT_Compiler *c, enum JIT_FlagSource z, enum JIT_FlagSource n, enum JIT_FlagSource h, enum JIT_FlagSource cy ) {
+	uint8_t hostMask = ( z == FLAG_FROM_HOST ? FLAG_Z : 0 ) | ( h == FLAG_FROM_HOST ? FLAG_H : 0 ); //Guest flags copied from ZF and AF
+	uint8_t setMask = ( z == FLAG_SET ? FLAG_Z : 0 ) | ( n == FLAG_SET ? FLAG_N : 0 ) | ( h == FLAG_SET ? FLAG_H : 0 ) | ( cy == FLAG_SET ? FLAG_C : 0 ); //Guest flags set
+	uint8_t keepMask = ( z == FLAG_KEPT ? FLAG_Z : 0 ) | ( n == FLAG_KEPT ? FLAG_N : 0 ) | ( h == FLAG_KEPT ? FLAG_H : 0 ) | ( cy == FLAG_KEPT ? FLAG_C : 0 ); //Guest flags unchanged
+
+	//AH = SF:ZF:0:AF:0:PF:1:CF, so ZF and AF are 7 bits above guest Z and H, and CF is 4 bits above guest C
+	Emit_Byte( c, 0x9F ); //lahf
+	if ( hostMask ) {
+		Emit_Mov( c, HOST_RDX, HOST_RAX );
+		Emit_Shift( c, SHIFT_SHR, HOST_RDX, 7 );
+		Emit_ALU_Imm( c, ALU_AND, HOST_RDX, hostMask );
+	}//end if
+	else Emit_ALU( c, ALU_XOR, HOST_RDX, HOST_RDX );
+
+	if ( cy == FLAG_FROM_HOST || cy == FLAG_FROM_CL ) {
+		if ( cy == FLAG_FROM_HOST ) {
+			Emit_Mov( c, HOST_RSI, HOST_RAX );
+			Emit_Shift( c, SHIFT_SHR, HOST_RSI, 4 );
+		}//end if
+		else {
+			Emit_Movzx8( c, HOST_RSI, HOST_RCX );
+			Emit_Shift( c, SHIFT_SHL, HOST_RSI, 4 );
+		}//end if-else
+		Emit_ALU_Imm( c, ALU_AND, HOST_RSI, FLAG_C );
+		Emit_ALU( c, ALU_OR, HOST_RDX, HOST_RSI );
+	}//end if
+
+	if ( setMask ) Emit_ALU_Imm( c, ALU_OR, HOST_RDX, setMask );
+
+	if ( keepMask ) {
+		Emit_ALU_Imm( c, ALU_AND, HOST_F, keepMask );
+		Emit_ALU( c, ALU_OR, HOST_F, HOST_RDX );
+	}//end if
+	else Emit_Mov( c, HOST_F, HOST_RDX );
+}//end function Emit_Flags
+
+/* Emits a test of the given guest condition. Returns the host condition under which the guest condition is false. */
+static enum JIT_Condition Emit_Condition( struct JIT_Compiler *c, uint8_t condition ) {
+	bool isCarry = condition == JIT_ARG_C || condition == JIT_ARG_NC; //Whether condition tests C rather than Z
+
+	Emit_Test8_Imm( c, HOST_F, isCarry ? FLAG_C : FLAG_Z );
+
+	//NZ/NC are false when the flag is set, Z/C when it is clear
+	return ( condition == JIT_ARG_NZ || condition == JIT_ARG_NC ) ? CC_NE : CC_E;
+}//end function Emit_Condition
+
+/* Emits a push of the given 16-bit value, or of the given guest register pair if value is negative, taking 8 T-States. */
+static void Emit_Push( struct JIT_Compiler *c, uint8_t pair, int32_t value ) {
+	for ( int i = 0; i < 2; ++i ) {
+		Emit_Adjust_SP( c, -1 );
+
+		//High byte first
+		if ( value >= 0 ) Emit_Mov_Imm( c, HOST_RCX, i == 0 ? value >> 8 : value & 0xFF );
+		else {
+			Emit_Load_Pair( c, pair, HOST_RCX );
+			if ( i == 0 ) Emit_Shift( c, SHIFT_SHR, HOST_RCX, 8 );
+			else Emit_ALU_Imm( c, ALU_AND, HOST_RCX, 0xFF );
+		}//end if-else
+
+		Emit_Mov( c, HOST_RDI, HOST_RBP );
+		Emit_Write( c );
+	}//end for
+}//end function Emit_Push
+
+/* Emits a pop of a 16-bit value into EAX, taking 8 T-States. */
+static void Emit_Pop( struct JIT_Compiler *c ) {
+	Emit_Mov( c, HOST_RDI, HOST_RBP );
+	Emit_Read( c );
+	Emit_Op_Mem( c, false, false, 0x89, HOST_RAX, HOST_RSP, HOST_NO_INDEX, JIT_TEMP_SLOT ); //mov [rsp + temp], eax
+	Emit_Adjust_SP( c, 1 );
+
+	Emit_Mov( c, HOST_RDI, HOST_RBP );
+	Emit_Read( c );
+	Emit_Shift( c, SHIFT_SHL, HOST_RAX, 8 );
+	Emit_Op_Mem( c, false, false, 0x0B, HOST_RAX, HOST_RSP, HOST_NO_INDEX, JIT_TEMP_SLOT ); //or eax, [rsp + temp]
+	Emit_Adjust_SP( c, 1 );
+}//end function Emit_Pop
+
+/* Emits a conditional branch's not-taken test. Returns the jump to patch to the not-taken path. */
+static size_t Emit_Branch_Test( struct JIT_Compiler *c, uint8_t condition ) {
+	return Emit_Jcc( c, Emit_Condition( c, condition ) );
+}//end function Emit_Branch_Test
+
+/* Emits a shift, rotate, or SWAP of the host 8-bit register holding an operand, and sets guest flags from the result. */
+static void Emit_Shift_Operation( struct JIT_Compiler *c, uint8_t operation, int reg, bool isAccumulatorForm ) {
+	enum JIT_FlagSource cy = FLAG_FROM_CL; //Source of guest C flag
+
+	switch ( operation ) {
+	case GB_OP_RLC: case GB_OP_RLCA: Emit_Shift8( c, SHIFT_ROL, reg, 1 ); break;
+	case GB_OP_RRC: case GB_OP_RRCA: Emit_Shift8( c, SHIFT_ROR, reg, 1 ); break;
+	case GB_OP_RL: case GB_OP_RLA: Emit_BT( c, HOST_F, 4 ); Emit_Shift8( c, SHIFT_RCL, reg, 1 ); break;
+	case GB_OP_RR: case GB_OP_RRA: Emit_BT( c, HOST_F, 4 ); Emit_Shift8( c, SHIFT_RCR, reg, 1 ); break;
+	case GB_OP_SLA: Emit_Shift8( c, SHIFT_SHL, reg, 1 ); break;
+	case GB_OP_SRA: Emit_Shift8( c, SHIFT_SAR, reg, 1 ); break;
+	case GB_OP_SRL: Emit_Shift8( c, SHIFT_SHR, reg, 1 ); break;
+	default: Emit_Shift8( c, SHIFT_ROL, reg, 4 ); cy = FLAG_CLEARED; break; //SWAP
+	}//end switch
+
+	//Rotates leave ZF unchanged, so save the carry and test the result
+	Emit_Setcc( c, CC_B, HOST_RCX );
+	Emit_Op_Reg( c, false, true, 0x84, reg, reg ); //test reg8, reg8
+	Emit_Flags( c, isAccumulatorForm ? FLAG_CLEARED : FLAG_FROM_HOST, FLAG_CLEARED, FLAG_CLEARED, cy );
+}//end function Emit_Shift_Operation
+
+/* Emits a 0xCB-prefixed instruction. */
+static void Emit_CB_Instruction( struct JIT_Compiler *c, const struct JIT_OpcodeInfo *info ) {
+	bool isBitOperation = info->operation == GB_OP_BIT || info->operation == GB_OP_RES || info->operation == GB_OP_SET; //Whether operand 1 is a bit index
+	uint8_t target = isBitOperation ? info->operand2 : info->operand1; //Register or (HL) operand
+	int reg = Emit_Get8( c, target ); //Host register holding operand
+
+	switch ( info->operation ) {
+	case GB_OP_BIT:
+		Emit_Test8_Imm( c, reg, 1 << info->operand1 );
+		Emit_Flags( c, FLAG_FROM_HOST, FLAG_CLEARED, FLAG_SET, FLAG_KEPT );
+		return;
+	case GB_OP_RES:
+		Emit_ALU8_Imm( c, ALU_AND, reg, ~( 1 << info->operand1 ) );
+		break;
+	case GB_OP_SET:
+		Emit_ALU8_Imm( c, ALU_OR, reg, 1 << info->operand1 );
+		break;
+	default:
+		Emit_Shift_Operation( c, info->operation, reg, false );
+		break;
+	}//end switch
+
+	//Write modified (HL) back
+	if ( !Is_Register( target ) ) {
+		Emit_Movzx8( c, HOST_RCX, HOST_RAX );
+		Emit_Address( c, target );
+		Emit_Write( c );
+	}//end if
+}//end function Emit_CB_Instruction
+
+/*	Emits one base instruction, whose opcode fetch has already been counted.
+*	Returns true if the instruction ends the block, having emitted its own exits.
+*/
+static bool Emit_Instruction( struct JIT_Compiler *c, const struct JIT_OpcodeInfo *info ) {
+	uint8_t o1 = info->operand1; //First operand
+	uint8_t o2 = info->operand2; //Second operand
+	int src; //Host register holding source operand
+	uint16_t target; //Branch target
+	size_t notTaken; //Jump to patch to not-taken path
+
+	switch ( info->operation ) {
+	case GB_OP_NOP:
+		break;
+
+	/*	Loads	*/
+	case GB_OP_LD8:
+		if ( Is_Register( o1 ) ) {
+			src = Emit_Get8( c, o2 );
+			Emit_Mov( c, GUEST_REGISTERS[o1], src );
+		}//end if
+		else {
+			if ( Is_Register( o2 ) ) Emit_Mov( c, HOST_RCX, GUEST_REGISTERS[o2] );
+			else Emit_Mov_Imm( c, HOST_RCX, Fetch_Operand( c ) );
+			Emit_Address( c, o1 );
+			Emit_Write( c );
+		}//end if-else
+		break;
+	case GB_OP_LD16_IMM:
+		Emit_Mov_Imm( c, HOST_RAX, Fetch_Operand16( c ) );
+		Emit_Store_Pair( c, o1, HOST_RAX );
+		break;
+	case GB_OP_LD_A16_A:
+		Emit_Mov_Imm( c, HOST_RDI, Fetch_Operand16( c ) );
+		Emit_Mov( c, HOST_RCX, HOST_A );
+		Emit_Write( c );
+		break;
+	case GB_OP_LD_A_A16:
+		Emit_Mov_Imm( c, HOST_RDI, Fetch_Operand16( c ) );
+		Emit_Read( c );
+		Emit_Mov( c, HOST_A, HOST_RAX );
+		break;
+	case GB_OP_LD_SP_HL:
+		Emit_Load_Pair( c, JIT_ARG_HL, HOST_RAX );
+		Emit_Store_Pair( c, JIT_ARG_SP, HOST_RAX );
+		c->cycles += 4;
+		break;
+	case GB_OP_PUSH:
+		c->cycles += 4;
+		Emit_Push( c, o1, -1 );
+		break;
+	case GB_OP_POP:
+		Emit_Pop( c );
+		Emit_Store_Pair( c, o1, HOST_RAX );
+		break;
+
+	/*	16-bit arithmetic	*/
+	case GB_OP_INC16:
+	case GB_OP_DEC16:
+		Emit_Load_Pair( c, o1, HOST_RAX );
+		Emit_Lea( c, HOST_RAX, HOST_RAX, info->operation == GB_OP_INC16 ? 1 : -1 );
+		Emit_Store_Pair( c, o1, HOST_RAX );
+		c->cycles += 4;
+		break;
+	case GB_OP_ADD_HL:
+		//H is the carry from bit 11, and C the carry from bit 15
+		Emit_Load_Pair( c, JIT_ARG_HL, HOST_RAX );
+		Emit_Load_Pair( c, o1, HOST_RCX );
+		Emit_Mov( c, HOST_RDX, HOST_RAX );
+		Emit_ALU_Imm( c, ALU_AND, HOST_RDX, 0x0FFF );
+		Emit_Mov( c, HOST_RSI, HOST_RCX );
+		Emit_ALU_Imm( c, ALU_AND, HOST_RSI, 0x0FFF );
+		Emit_ALU( c, ALU_ADD, HOST_RDX, HOST_RSI );
+		Emit_Shift( c, SHIFT_SHR, HOST_RDX, 7 );
+		Emit_ALU_Imm( c, ALU_AND, HOST_RDX, FLAG_H );
+		Emit_ALU( c, ALU_ADD, HOST_RAX, HOST_RCX );
+		Emit_Mov( c, HOST_RSI, HOST_RAX );
+		Emit_Shift( c, SHIFT_SHR, HOST_RSI, 12 );
+		Emit_ALU_Imm( c, ALU_AND, HOST_RSI, FLAG_C );
+		Emit_ALU( c, ALU_OR, HOST_RDX, HOST_RSI );
+		Emit_ALU_Imm( c, ALU_AND, HOST_F, FLAG_Z );
+		Emit_ALU( c, ALU_OR, HOST_F, HOST_RDX );
+		Emit_Store_Pair( c, JIT_ARG_HL, HOST_RAX );
+		c->cycles += 4;
+		break;
+
+	/*	8-bit arithmetic	*/
+	case GB_OP_INC8:
+	case GB_OP_DEC8:
+		src = Emit_Get8( c, o1 );
+		Emit_Op_Reg( c, false, true, 0xFE, info->operation == GB_OP_INC8 ? 0 : 1, src ); //inc/dec reg8
+		Emit_Flags( c, FLAG_FROM_HOST, info->operation == GB_OP_INC8 ? FLAG_CLEARED : FLAG_SET, FLAG_FROM_HOST, FLAG_KEPT );
+		if ( !Is_Register( o1 ) ) {
+			Emit_Movzx8( c, HOST_RCX, HOST_RAX );
+			Emit_Address( c, o1 );
+			Emit_Write( c );
+		}//end if
+		break;
+	case GB_OP_ADD:
+		src = Emit_Get8( c, o1 );
+		Emit_ALU8( c, ALU_ADD, HOST_A, src );
+		Emit_Flags( c, FLAG_FROM_HOST, FLAG_CLEARED, FLAG_FROM_HOST, FLAG_FROM_HOST );
+		break;
+	case GB_OP_ADC:
+		src = Emit_Get8( c, o1 );
+		Emit_BT( c, HOST_F, 4 );
+		Emit_ALU8( c, ALU_ADC, HOST_A, src );
+		Emit_Flags( c, FLAG_FROM_HOST, FLAG_CLEARED, FLAG_FROM_HOST, FLAG_FROM_HOST );
+		break;
+	case GB_OP_SUB:
+	case GB_OP_CP:
+		src = Emit_Get8( c, o1 );
+		Emit_ALU8( c, info->operation == GB_OP_SUB ? ALU_SUB : ALU_CMP, HOST_A, src );
+		Emit_Flags( c, FLAG_FROM_HOST, FLAG_SET, FLAG_FROM_HOST, FLAG_FROM_HOST );
+		break;
+	case GB_OP_SBC:
+		src = Emit_Get8( c, o1 );
+		Emit_BT( c, HOST_F, 4 );
+		Emit_ALU8( c, ALU_SBB, HOST_A, src );
+		Emit_Flags( c, FLAG_FROM_HOST, FLAG_SET, FLAG_FROM_HOST, FLAG_FROM_HOST );
+		break;
+	case GB_OP_AND:
+		src = Emit_Get8( c, o1 );
+		Emit_ALU8( c, ALU_AND, HOST_A, src );
+		Emit_Flags( c, FLAG_FROM_HOST, FLAG_CLEARED, FLAG_SET, FLAG_CLEARED );
+		break;
+	case GB_OP_XOR:
+	case GB_OP_OR:
+		src = Emit_Get8( c, o1 );
+		Emit_ALU8( c, info->operation == GB_OP_XOR ? ALU_XOR : ALU_OR, HOST_A, src );
+		Emit_Flags( c, FLAG_FROM_HOST, FLAG_CLEARED, FLAG_CLEARED, FLAG_CLEARED );
+		break;
+	case GB_OP_CPL:
+		Emit_ALU_Imm( c, ALU_XOR, HOST_A, 0xFF );
+		Emit_ALU_Imm( c, ALU_OR, HOST_F, FLAG_N | FLAG_H );
+		break;
+	case GB_OP_SCF:
+		Emit_ALU_Imm( c, ALU_AND, HOST_F, FLAG_Z );
+		Emit_ALU_Imm( c, ALU_OR, HOST_F, FLAG_C );
+		break;
+	case GB_OP_CCF:
+		Emit_ALU_Imm( c, ALU_XOR, HOST_F, FLAG_C );
+		Emit_ALU_Imm( c, ALU_AND, HOST_F, FLAG_Z | FLAG_C );
+		break;
+	case GB_OP_RLCA:
+	case GB_OP_RRCA:
+	case GB_OP_RLA:
+	case GB_OP_RRA:
+		Emit_Shift_Operation( c, info->operation, HOST_A, true );
+		break;
+	case GB_OP_PREFIX_CB:
+		c->cycles += 4;
+		Emit_CB_Instruction( c, &( CB_OPCODE_INFO[c->operands[c->operandIndex++]] ) );
+		break;
+
+	/*	Branches	*/
+	case GB_OP_JR:
+		target = c->pc + (int8_t)Fetch_Operand( c );
+		Emit_Exit( c, -1, target, c->cycles + 4, c->count + 1 );
+		return true;
+	case GB_OP_JR_CC:
+		target = c->pc + (int8_t)Fetch_Operand( c );
+		notTaken = Emit_Branch_Test( c, o1 );
+		Emit_Exit( c, -1, target, c->cycles + 4, c->count + 1 );
+		Emit_Patch( c, notTaken );
+		Emit_Exit( c, -1, c->pc, c->cycles, c->count + 1 );
+		return true;
+	case GB_OP_JP:
+		target = Fetch_Operand16( c );
+		Emit_Exit( c, -1, target, c->cycles + 4, c->count + 1 );
+		return true;
+	case GB_OP_JP_CC:
+		target = Fetch_Operand16( c );
+		notTaken = Emit_Branch_Test( c, o1 );
+		Emit_Exit( c, -1, target, c->cycles + 4, c->count + 1 );
+		Emit_Patch( c, notTaken );
+		Emit_Exit( c, -1, c->pc, c->cycles, c->count + 1 );
+		return true;
+	case GB_OP_JP_HL:
+		Emit_Load_Pair( c, JIT_ARG_HL, HOST_RDI );
+		Emit_Exit( c, HOST_RDI, 0, c->cycles, c->count + 1 );
+		return true;
+	case GB_OP_CALL:
+	case GB_OP_CALL_CC:
+		target = Fetch_Operand16( c );
+		notTaken = info->operation == GB_OP_CALL_CC ? Emit_Branch_Test( c, o1 ) : 0;
+		{
+			unsigned notTakenCycles = c->cycles; //T-States spent if the call is not taken
+
+			c->cycles += 4;
+			Emit_Push( c, 0, c->pc );
+			Emit_Exit( c, -1, target, c->cycles, c->count + 1 );
+			if ( notTaken ) {
+				Emit_Patch( c, notTaken );
+				Emit_Exit( c, -1, c->pc, notTakenCycles, c->count + 1 );
+			}//end if
+		}
+		return true;
+	case GB_OP_RET:
+		Emit_Pop( c );
+		Emit_Exit( c, HOST_RAX, 0, c->cycles + 4, c->count + 1 );
+		return true;
+	case GB_OP_RET_CC:
+		c->cycles += 4;
+		notTaken = Emit_Branch_Test( c, o1 );
+		{
+			unsigned notTakenCycles = c->cycles; //T-States spent if the return is not taken
+
+			Emit_Pop( c );
+			Emit_Exit( c, HOST_RAX, 0, c->cycles + 4, c->count + 1 );
+			Emit_Patch( c, notTaken );
+			Emit_Exit( c, -1, c->pc, notTakenCycles, c->count + 1 );
+		}
+		return true;
+	case GB_OP_RST:
+		c->cycles += 4;
+		Emit_Push( c, 0, c->pc );
+		Emit_Exit( c, -1, o1, c->cycles, c->count + 1 );
+		return true;
+
+	default:
+		break;
+	}//end switch
+
+	return false;
+}//end function Emit_Instruction
+
+/*	Returns whether the given base instruction can be compiled.
+*	Instructions changing interrupt or halt state, rarely-used SP arithmetic and DAA, and instructions addressing I/O registers are left to the interpreter.
+*/
+static bool Is_Compilable( const struct JIT_OpcodeInfo *info, const uint8_t *bytes ) {
+	switch ( info->operation ) {
+	case GB_OP_LD8:
+		return info->operand1 != JIT_ARG_CI && info->operand1 != JIT_ARG_A8I && info->operand2 != JIT_ARG_CI && info->operand2 != JIT_ARG_A8I;
+	case GB_OP_LD_A16_A:
+	case GB_OP_LD_A_A16:
+		return ( bytes[1] | ( bytes[2] << 8 ) ) < 0xFF00;
+	case GB_OP_ADD_SP_E:
+	case GB_OP_DAA:
+	case GB_OP_DI:
+	case GB_OP_EI:
+	case GB_OP_HALT:
+	case GB_OP_ILLEGAL:
+	case GB_OP_LD_A16_SP:
+	case GB_OP_LD_HL_SP_E:
+	case GB_OP_RETI:
+	case GB_OP_STOP:
+		return false;
+	default:
+		return true;
+	}//end switch
+}//end function Is_Compilable
+
+/*	Compiles the block of ROM instructions starting at the given page offset of the given host page.
+*	Compilation stops after the first branch, before any instruction which cannot be compiled, or before any instruction extending past the end of the page.
+*	Returns the compiled block, or NULL if its first instruction cannot be compiled or the code buffer is full.
+*/
+static void *Compile_Block( struct GB_JIT *jit, const uint8_t *page, uint16_t pc, bool *isFull ) {
+	struct JIT_Compiler compiler = { 0 }; //Block compiler state
+	struct JIT_Compiler *c = &compiler;
+	unsigned offset = pc & 0xFF; //Page offset of next instruction
+	bool isEnded = false; //Whether the last instruction compiled ended the block
+
+	c->code = jit->buffer + jit->used;
+	c->capacity = JIT_BUFFER_SIZE - jit->used;
+	c->jit = jit;
+	*isFull = c->capacity < JIT_BLOCK_RESERVE;
+	if ( *isFull ) return NULL;
+
+	if ( mprotect( jit->buffer, JIT_BUFFER_SIZE, PROT_READ | PROT_WRITE ) ) return NULL;
+
+	Emit_Prologue( c );
+	while ( c->count < JIT_MAX_OPS && !isEnded && offset < 0x100 ) {
+		const uint8_t *bytes = page + offset; //Bytes of next instruction
+		uint8_t length = bytes[0] == 0xCB ? 2 : GB_OPCODE_LENGTHS[bytes[0]]; //Length of next instruction
+		const struct JIT_OpcodeInfo *info = &( BASE_OPCODE_INFO[bytes[0]] ); //Operation and operands of next instruction
+		size_t exitCheck; //Jump past early exit, to patch
+
+		if ( offset + length > 0x100 || !Is_Compilable( info, bytes ) ) break;
+
+		c->operands = bytes + 1;
+		c->operandIndex = 0;
+		c->pc = pc + length;
+		c->cycles += 4; //Opcode fetch
+		c->hasSlowAccess = false;
+
+		isEnded = Emit_Instruction( c, info );
+
+		//Leave block early if requested by a slow memory access
+		if ( !isEnded && c->hasSlowAccess ) {
+			Emit_Mov_Imm64( c, HOST_RAX, (uint64_t)(uintptr_t)&( jit->isExitRequested ) );
+			Emit_Op_Mem( c, false, false, 0x80, 7, HOST_RAX, HOST_NO_INDEX, 0 ); //cmp byte [rax], imm8
+			Emit_Byte( c, 0 );
+			exitCheck = Emit_Jcc( c, CC_E );
+			Emit_Exit( c, -1, c->pc, c->cycles, c->count + 1 );
+			Emit_Patch( c, exitCheck );
+		}//end if
+
+		c->count += 1;
+		pc += length;
+		offset += length;
+	}//end while
+	if ( !isEnded ) Emit_Exit( c, -1, pc, c->cycles, c->count );
+
+	mprotect( jit->buffer, JIT_BUFFER_SIZE, PROT_READ | PROT_EXEC );
+
+	if ( c->count == 0 ) return NULL;
+	if ( c->isFull ) {
+		*isFull = true;
+		return NULL;
+	}//end if
+
+	jit->used += ( c->size + 15 ) & ~(size_t)15;
+	jit->blocksCompiled += 1;
+
+	return c->code;
+}//end function Compile_Block
+
+/*	Differential Check	*/
+
+/* Copies the system into the shadow system, which is then run through the interpreter after the compiled block. */
+static void Begin_Check( GameBoy *gb ) {
+	GameBoy *shadow = gb->jit->shadow; //Copy of system run through interpreter
+
+	memcpy( shadow, gb, sizeof( GameBoy ) );
+	shadow->trace = NULL;
+	shadow->jit = NULL;
+	shadow->blockCache = NULL;
+	shadow->callbacks.pauseOnUnknownOpcode = NULL;
+	GB_Map_Memory( shadow );
+
+	return;
+}//end function Begin_Check
+
+/*	Runs the given number of instructions on the shadow system through the interpreter, then compares it with the system.
+*	Upon mismatch, reports both states, adopts the interpreter's state, and stops using the block.
+*	External RAM is shared between both systems, so writes to it by the interpreter are applied twice.
+*/
+static void End_Check( GameBoy *gb, struct GB_JITEntry *entry, uint16_t startPC, unsigned count ) {
+	struct GB_JIT *jit = gb->jit; //Recompiler state
+	GameBoy *shadow = jit->shadow; //Copy of system run through interpreter
+	struct GB_Trace *trace = gb->trace; //Trace ring buffer, kept when adopting interpreter state
+	struct GB_BlockCache *blockCache = gb->blockCache; //Block cache, kept when adopting interpreter state
+	struct GB_Callbacks callbacks = gb->callbacks; //Host callbacks, kept when adopting interpreter state
+
+	//Compiled code ticks per access, so is checked against the per-access interpreter whatever the system's own timing
+	for ( unsigned i = 0; i < count; ++i )
+		GB_CORE_PER_ACCESS.decodeExecute( shadow );
+
+	if ( !memcmp( &( gb->cpu ), &( shadow->cpu ), offsetof( struct GB_Processor, boot ) )
+		&& !memcmp( gb->cpu.hram, shadow->cpu.hram, sizeof( gb->cpu.hram ) )
+		&& !memcmp( gb->io, shadow->io, sizeof( gb->io ) )
+		&& !memcmp( gb->wram, shadow->wram, sizeof( gb->wram ) )
+		&& !memcmp( gb->vram, shadow->vram, sizeof( gb->vram ) )
+		&& !memcmp( gb->cpu.ppu.oam, shadow->cpu.ppu.oam, sizeof( gb->cpu.ppu.oam ) )
+		&& gb->cycles == shadow->cycles ) return;
+
+	jit->mismatches += 1;
+	GB_ERROR( gb, "JIT mismatch in block at 0x%04X (%u instructions):\n", startPC, count );
+	GB_ERROR( gb, "\tJIT:         AF=%04X BC=%04X DE=%04X HL=%04X SP=%04X PC=%04X cycles=%u\n",
+		gb->cpu.af, gb->cpu.bc, gb->cpu.de, gb->cpu.hl, gb->cpu.sp, gb->cpu.pc, gb->cycles );
+	GB_ERROR( gb, "\tInterpreter: AF=%04X BC=%04X DE=%04X HL=%04X SP=%04X PC=%04X cycles=%u\n",
+		shadow->cpu.af, shadow->cpu.bc, shadow->cpu.de, shadow->cpu.hl, shadow->cpu.sp, shadow->cpu.pc, shadow->cycles );
+
+	memcpy( gb, shadow, sizeof( GameBoy ) );
+	gb->trace = trace;
+	gb->jit = jit;
+	gb->blockCache = blockCache;
+	gb->callbacks = callbacks;
+	GB_Map_Memory( gb );
+
+	entry->code = NULL;
+	entry->isUncompilable = true;
+
+	return;
+}//end function End_Check
+
+/*	Public Interface	*/
+
+/*	Allocates the system's recompiler and its executable code buffer.
+*	If isChecked, every compiled block is also run through the interpreter on a copy of the system, and any difference is reported.
+*	Returns 0 if successful. Else, returns 1 if unable to allocate.
+*/
+int GB_JIT_Init( GameBoy *gb, bool isChecked ) {
+	struct GB_JIT *jit; //New recompiler state
+
+	jit = calloc( 1, sizeof( struct GB_JIT ) );
+	if ( !jit ) {
+		GB_ERROR( gb, "Unable to allocate JIT state.\n" );
+		return 1;
+	}//end if
+
+	jit->buffer = mmap( NULL, JIT_BUFFER_SIZE, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+	if ( jit->buffer == MAP_FAILED ) {
+		GB_ERROR( gb, "Unable to map JIT code buffer.\n" );
+
+		free( jit );
+		return 1;
+	}//end if
+
+	jit->isChecked = isChecked;
+	if ( isChecked ) {
+		jit->shadow = aligned_alloc( _Alignof( GameBoy ), sizeof( GameBoy ) );
+		if ( !( jit->shadow ) ) {
+			GB_ERROR( gb, "Unable to allocate JIT differential-check system.\n" );
+
+			munmap( jit->buffer, JIT_BUFFER_SIZE );
+			free( jit );
+			return 1;
+		}//end if
+	}//end if
+
+	gb->jit = jit;
+	GB_DEBUG( gb, "JIT initialized (%d KB code buffer%s).\n", JIT_BUFFER_SIZE / 1024, isChecked ? ", differential check" : "" );
+
+	return 0;
+}//end function GB_JIT_Init
+
+/* Frees the system's recompiler, if allocated, reporting any differential-check mismatches. */
+void GB_JIT_Deinit( GameBoy *gb ) {
+	struct GB_JIT *jit = gb->jit; //Recompiler state
+
+	if ( !jit ) return;
+
+	GB_DEBUG( gb, "JIT compiled %lu blocks.\n", jit->blocksCompiled );
+	if ( jit->isChecked ) GB_ERROR( gb, "JIT differential check: %lu mismatching blocks.\n", jit->mismatches );
+
+	munmap( jit->buffer, JIT_BUFFER_SIZE );
+	if ( jit->shadow ) free( jit->shadow );
+	free( jit );
+	gb->jit = NULL;
+
+	return;
+}//end function GB_JIT_Deinit
+
+/* Discards all compiled blocks. Must be called whenever ROM memory is loaded or freed, as blocks are identified by host address. */
+void GB_JIT_Flush( GameBoy *gb ) {
+	if ( !( gb->jit ) ) return;
+
+	memset( gb->jit->entries, 0, sizeof( gb->jit->entries ) );
+	gb->jit->used = 0;
+
+	return;
+}//end function GB_JIT_Flush
+
+/* Runs the next instruction or block through the fastest interpreter tier available. */
+static bool Run_Interpreter( GameBoy *gb ) {
+	return gb->blockCache ? gb->core->executeBlock( gb ) : gb->core->decodeExecute( gb );
+}//end function Run_Interpreter
+
+/*	Runs the compiled block of ROM instructions starting at the current PC, compiling it first once hot.
+*	Cold blocks, code outside ROM, blocks whose first instruction cannot be compiled, and the EI-delay and HALT-bug states are run through the interpreter.
+*	Returns true if illegal opcode encountered and user quits mid-pause by closing emulator window. Otherwise, returns false.
+*/
+bool GB_JIT_Execute( GameBoy *gb ) {
+	struct GB_JIT *jit = gb->jit; //Recompiler state
+	const struct GB_MemoryPage *page = &( gb->memoryMap[gb->cpu.pc >> 8] ); //Memory map entry of the page containing PC
+	struct GB_JITEntry *entry; //Compiled block table entry for PC
+	const uint8_t *tag; //Host address of PC
+	uint16_t startPC = gb->cpu.pc; //PC at start of block
+	unsigned result; //Instructions run and T-States spent by compiled block
+
+	if ( gb->cpu.pc >= 0x8000 || !( page->readMemory ) || gb->cpu.isIMEPending || gb->cpu.isHaltBug ) return Run_Interpreter( gb );
+
+	tag = page->readMemory + ( gb->cpu.pc & 0xFF );
+	entry = &( jit->entries[gb->cpu.pc & ( JIT_ENTRY_COUNT - 1 )] );
+	if ( entry->tag != tag ) {
+		entry->tag = tag;
+		entry->code = NULL;
+		entry->hits = 0;
+		entry->isUncompilable = false;
+	}//end if
+
+	//Compile hot blocks. If the code buffer is full, discard all compiled blocks and start over.
+	if ( !( entry->code ) ) {
+		bool isFull; //Whether code buffer was too full to compile
+
+		if ( entry->isUncompilable || ++( entry->hits ) < JIT_HOT_THRESHOLD ) return Run_Interpreter( gb );
+
+		entry->code = (unsigned ( * )( GameBoy * ))Compile_Block( jit, page->readMemory, gb->cpu.pc, &isFull );
+		if ( !( entry->code ) && isFull ) {
+			GB_JIT_Flush( gb );
+			entry->tag = tag;
+			entry->code = (unsigned ( * )( GameBoy * ))Compile_Block( jit, page->readMemory, gb->cpu.pc, &isFull );
+		}//end if
+		if ( !( entry->code ) ) {
+			entry->isUncompilable = true;
+			return Run_Interpreter( gb );
+		}//end if
+	}//end if
+
+	if ( jit->isChecked ) Begin_Check( gb );
+
+	jit->flushedCycles = 0;
+	jit->romMapCount = gb->romMapCount;
+	jit->isExitRequested = false;
+
+	result = entry->code( gb );
+	GB_Cycle_T_States( gb, ( result >> 8 ) - jit->flushedCycles );
+
+	if ( jit->isChecked ) End_Check( gb, entry, startPC, result & 0xFF );
+
+	return false;
+}//end function GB_JIT_Execute
+
+#else
+
+/* Reports that the recompiler is unavailable on this host. Returns 1. */
+int GB_JIT_Init( GameBoy *gb, bool isChecked ) {
+	(void)isChecked;
+
+	gb->jit = NULL;
+	GB_ERROR( gb, "JIT is only supported on x86-64 System V hosts.\n" );
+
+	return 1;
+}//end function GB_JIT_Init
+
+/* Does nothing, as the recompiler is unavailable on this host. */
+void GB_JIT_Deinit( GameBoy *gb ) {
+	(void)gb;
+}//end function GB_JIT_Deinit
+
+/* Does nothing, as the recompiler is unavailable on this host. */
+void GB_JIT_Flush( GameBoy *gb ) {
+	(void)gb;
+}//end function GB_JIT_Flush
+
+/* Runs the next instruction through the interpreter, as the recompiler is unavailable on this host. */
+bool GB_JIT_Execute( GameBoy *gb ) {
+	return gb->blockCache ? gb->core->executeBlock( gb ) : gb->core->decodeExecute( gb );
+}//end function GB_JIT_Execute
+
+#endif
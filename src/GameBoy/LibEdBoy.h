@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*	libedboy, the emulator core as a library. Depends on neither SDL nor the front end.
+*	A host creates systems with GB_Create(), drives them through the functions below, and observes them through read-only pointers
+*	into each system, so neither stepping nor observation copies anything. The layout of a system is internal, and may change between versions.
+*/
+
+#define EDBOY_API_VERSION 1 //Incremented upon any incompatible change to the declarations below
+
+/*	Game Boy Constants	*/
+#define GB_LCD_HEIGHT 144 //Game Boy LCD screen pixel height
+#define GB_LCD_WIDTH 160 //Game Boy LCD screen pixel width
+#define GB_LCD_PITCH 160 //Bytes between the starts of consecutive LCD framebuffer rows. A multiple of 32, so every row is vector-aligned.
+#define GB_WRAM_SIZE 0x2000 //Size of Work RAM in bytes, mapped at 0xC000
+#define GB_HRAM_SIZE 0x80 //Size of High RAM in bytes, mapped at 0xFF80
+
+/*	Definitions	*/
+typedef struct GB_System GameBoy; //Total state of an emulated Game Boy system. Opaque to hosts. Defined in GameBoy.h.
+
+//Defines button IDs used for Game Boy buttons. Used as bit indices into button masks, and as indices into isPressed, CTRL_SCANCODES, etc.
+enum GameBoyButtonID {
+	GB_UP, //D-Pad Up
+	GB_DOWN, //D-Pad Down
+	GB_LEFT, //D-Pad Left
+	GB_RIGHT, //D-Pad Right
+	GB_A, //A Button
+	GB_B, //B Button
+	GB_START, //Start Button
+	GB_SELECT //Select Button
+};
+
+//Defines severities of messages reported through an instance's log callback
+enum GB_LogLevel {
+	GB_LOG_ERROR, //Failure or unexpected condition, such as an allocation failure or illegal opcode
+	GB_LOG_DEBUG //Progress detail. Only reported by builds with DEBUG defined.
+};
+
+//Defines how finely an instance's CPU ticks the rest of the system. Chosen per instance with GB_Set_Timing().
+enum GB_Timing {
+	GB_TIMING_PER_ACCESS, //Every memory access ticks the system as it happens. Default.
+	GB_TIMING_PER_INSTRUCTION //Each instruction ticks the system once, after its last access. Faster, but less accurate.
+};
+
+//Defines the callbacks through which an instance reports to, and waits on, the program hosting it.
+//Each instance has its own, so instances share no state, and may run on separate threads. All are called on the thread running the instance.
+struct GB_Callbacks {
+	void ( *log )( void *userData, enum GB_LogLevel level, const char *message ); //Receives each message, ending in a newline. If NULL, errors go to stderr and debug messages to stdout.
+	bool ( *pauseOnUnknownOpcode )( void *userData ); //Called upon an unknown opcode. Returns true to quit mid-frame. If NULL, execution continues.
+	void *userData; //Passed to every callback
+};
+
+/*	Function Prototypes	*/
+GameBoy *GB_Create( void ); //API.c
+void GB_Destroy( GameBoy *gb ); //API.c
+void GB_Set_Callbacks( GameBoy *gb, const struct GB_Callbacks *callbacks ); //API.c
+void GB_Set_Timing( GameBoy *gb, enum GB_Timing timing ); //API.c
+bool GB_Step_Frames( GameBoy *gb, unsigned frames, uint8_t buttons ); //API.c
+const uint8_t *GB_Get_Frame( const GameBoy *gb ); //API.c
+const uint8_t *GB_Get_WRAM( const GameBoy *gb ); //API.c
+const uint8_t *GB_Get_HRAM( const GameBoy *gb ); //API.c
+uint32_t GB_Get_Frame_Count( const GameBoy *gb ); //API.c
+
+void GB_Load_BootROM_Buffer( GameBoy *gb, const uint8_t *boot, size_t size ); //Load.c
+int GB_Load_Game_Buffer( GameBoy *gb, const uint8_t *rom, size_t size ); //Load.c
+
+int GB_Boot( GameBoy *gb, const char *cacheDir ); //Boot.c
+
+size_t GB_State_Size( const GameBoy *gb ); //State.c
+int GB_Save_State( const GameBoy *gb, uint8_t *buffer, size_t size ); //State.c
+int GB_Load_State( GameBoy *gb, const uint8_t *buffer, size_t size ); //State.c
+int GB_Save_State_File( const GameBoy *gb, const char *path ); //State.c
+int GB_Load_State_File( GameBoy *gb, const char *path ); //State.c
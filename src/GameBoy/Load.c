@@ -1,169 +1,333 @@
+#define _DEFAULT_SOURCE //Exposes fileno() when compiling as strict ISO C
+
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#if !defined( _WIN32 )
+#include <sys/mman.h>
+#endif
+
+#include "GameBoy.h"
 
-#include "../Edboy.h"
+/* Returns the smallest whole number of 16 KB ROM banks, and at least two, holding the given number of bytes, in bytes. */
+static size_t Round_ROM_Size( size_t size ) {
+	size_t rounded = ( size + 0x3FFF ) & ~(size_t)0x3FFF; //Size rounded up to a whole bank
 
-/*	TEMPORARY IMPLEMENTATION: Lacks MBC, external RAM support of any kind
-*	Attempts to allocate memory for cartridge ROM/RAM banks and load contents from file at the supplied path.
-*	If successful, loads the first 0x4000 bytes into lower ROM bank, then the next 0x4000 bytes into upper ROM bank.
-*	If unsuccessful, leaves uninitialized data in ROM banks to emulate unconnected cartridge pins.
-*	Leaves uninitialized data for external RAM to emulate lack of external RAM.
-*	Returns 0 if all allocations successful. Else, returns 1 if unable.
+	return rounded < 0x8000 ? 0x8000 : rounded;
+}//end function Round_ROM_Size
+
+/*	Identifies the loaded cartridge's memory bank controller and external RAM size from its header, allocates its external RAM,
+*	and resets its bank registers. Cartridges with an unsupported controller are run as if they had none.
+*	Returns 0 if successful. Else, returns 1 if unable to allocate external RAM.
 */
-int GB_Load_Game( GameBoy *gb, char *path ) {
-	FILE *romFile = NULL; //Points to ROM file, if successfully loaded.
+static int Insert_Cartridge( GameBoy *gb ) {
+	struct GB_GamePak *cart = &( gb->cart ); //Cartridge being inserted
+	uint8_t type = cart->romImage[0x147]; //Cartridge type header byte
+	uint8_t ramSize = cart->romImage[0x149]; //External RAM size header byte
 
-	//Open file
-	fopen_s( &romFile, path, "rb" );
+	//Identify memory bank controller
+	if ( type >= 0x01 && type <= 0x03 ) cart->mbc = GB_MBC1;
+	else if ( type >= 0x0F && type <= 0x13 ) cart->mbc = GB_MBC3;
+	else if ( type >= 0x19 && type <= 0x1E ) cart->mbc = GB_MBC5;
+	else {
+		cart->mbc = GB_MBC_NONE;
+		if ( type != 0x00 && type != 0x08 && type != 0x09 ) GB_ERROR( gb, "Unsupported cartridge type 0x%02X. Running without a memory bank controller.\n", type );
+	}//end if-else
 
-	if ( romFile ) {
-		dprintf( "Successfully opened cartridge ROM file.\n" );
-	}//end if
+	cart->hasBattery = type == 0x03 || type == 0x09 || type == 0x0F || type == 0x10 || type == 0x13 || type == 0x1B || type == 0x1E;
 
-	//If able to open file and allocate, load ROM contents
-	if ( romFile ) {
+	//Identify external RAM size. 2 KB RAM is treated as one whole 8 KB bank.
+	switch ( ramSize ) {
+	case 0x01: case 0x02: cart->extramSize = 0x2000; break;
+	case 0x03: cart->extramSize = 0x8000; break;
+	case 0x04: cart->extramSize = 0x20000; break;
+	case 0x05: cart->extramSize = 0x10000; break;
+	default: cart->extramSize = 0; break;
+	}//end switch
 
-		//Allocate ROM banks
-		gb->cart.rom0 = malloc( 0x4000 );
-		if ( !( gb->cart.rom0 ) ) {
-			eprintf( "Unable to allocate memory for ROM bank 0.\n" );
+	if ( cart->extramSize ) {
+		cart->extramImage = calloc( 1, cart->extramSize );
+		if ( !( cart->extramImage ) ) {
+			GB_ERROR( gb, "Unable to allocate memory for external RAM.\n" );
 
-			fclose( romFile );
+			cart->extramSize = 0;
 			return 1;
 		}//end if
-		else dprintf( "ROM bank 0 allocated.\n" );
+	}//end if
+
+	//Reset bank registers. External RAM needs no enabling without a controller.
+	cart->romBank = 1;
+	cart->ramBank = 0;
+	cart->bankMode = 0;
+	cart->isExtRAMEnabled = cart->mbc == GB_MBC_NONE;
+
+	GB_DEBUG( gb, "Cartridge inserted (type 0x%02X, %zu KB ROM, %zu KB RAM).\n", type, cart->romSize >> 10, cart->extramSize >> 10 );
 
-		gb->cart.rom1 = malloc( 0x4000 );
-		if ( !( gb->cart.rom1 ) ) {
-			eprintf( "Unable to allocate memory for ROM bank 1.\n" );
+	return 0;
+}//end function Insert_Cartridge
+
+/* Maps the selected banks of the inserted cartridge, or open bus for an empty slot, and drops any blocks decoded or compiled from previously loaded ROM. */
+static void Map_Inserted_Cartridge( GameBoy *gb ) {
+	GB_Map_Memory( gb );
+	GB_Block_Cache_Flush( gb );
+	GB_JIT_Flush( gb );
+
+	return;
+}//end function Map_Inserted_Cartridge
+
+/*	Unloads the loaded game, if any, releasing its ROM image and external RAM after writing back any attached save file, and leaves the cartridge slot empty.
+*	The memory map must be rebuilt before the system is run again.
+*/
+void GB_Unload_Game( GameBoy *gb ) {
+	struct GB_GamePak *cart = &( gb->cart ); //Cartridge being removed
+
+	GB_Detach_Save( gb );
+	GB_Release_Image( cart->romImage );
+	free( cart->extramImage );
+
+	cart->romImage = NULL;
+	cart->romSize = 0;
+	cart->extramImage = NULL;
+	cart->extramSize = 0;
+	cart->hasBattery = false;
+	cart->mbc = GB_MBC_NONE;
+	cart->rom0 = NULL;
+	cart->rom1 = NULL;
+	cart->extram = NULL;
+
+	return;
+}//end function GB_Unload_Game
 
-			fclose( romFile );
+/*	Loads the given cartridge ROM image of the given size, replacing any loaded game. Any memory bank controller named by its header is emulated.
+*	The image is shared with every other system running the same game, and otherwise copied, padded with 0 up to a whole number of 16 KB banks.
+*	If rom is NULL, emulates an empty cartridge slot.
+*	Returns 0 if all allocations successful. Else, returns 1 if unable, in which case the slot is left empty.
+*/
+int GB_Load_Game_Buffer( GameBoy *gb, const uint8_t *rom, size_t size ) {
+	GB_Unload_Game( gb );
+
+	if ( rom ) {
+		gb->cart.romImage = GB_Acquire_Image( gb, rom, size, Round_ROM_Size( size ), GB_IMAGE_BORROWED );
+		if ( !( gb->cart.romImage ) ) {
+			Map_Inserted_Cartridge( gb );
+			return 1;
+		}//end if
+
+		gb->cart.romSize = Round_ROM_Size( size );
+		if ( Insert_Cartridge( gb ) ) {
+			GB_Unload_Game( gb );
+			Map_Inserted_Cartridge( gb );
 			return 1;
 		}//end if
-		else dprintf( "ROM bank 1 allocated.\n" );
+	}//end if
+	else GB_DEBUG( gb, "No cartridge ROM. Emulating empty cartridge slot.\n" );
+
+	Map_Inserted_Cartridge( gb );
+
+	return 0;
+}//end function GB_Load_Game_Buffer
+
+/*	Attempts to map the cartridge ROM file open as the given descriptor, of the given size, read-only into memory.
+*	Pages are loaded on first access and shared through the page cache with every other mapping of the file, so mapping takes constant time.
+*	Only files of a whole number of 16 KB banks are mapped, so banks never extend past the end of the file.
+*	Returns the mapping if mapped. Otherwise, returns NULL, in which case the file should be read instead.
+*/
+static uint8_t *Map_ROM_File( int fd, size_t size ) {
+#if !defined( _WIN32 )
+	void *image; //Mapping of file
+
+	if ( size != Round_ROM_Size( size ) ) return NULL;
+
+	image = mmap( NULL, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+	return image == MAP_FAILED ? NULL : image;
+#else
+	(void)fd;
+	(void)size;
+
+	return NULL;
+#endif
+}//end function Map_ROM_File
 
-		//Attempt to load ROM Bank 0
-		fread( gb->cart.rom0, 1, 0x4000, romFile );
-		dprintf( "ROM Bank 0 loaded. First byte test: 0x%02X\n", gb->cart.rom0[0] );
+/*	Attempts to load the cartridge ROM file at the supplied path, replacing any loaded game. Any memory bank controller named by its header is emulated.
+*	The file is mapped read-only into memory if possible. Otherwise, it is read whole in a single bulk read, as GB_Load_Game_Buffer() would copy it.
+*	Either way, the image is then shared with every other system running the same game, and the duplicate dropped.
+*	If unable to open the file, emulates an empty cartridge slot.
+*	Returns 0 if all allocations successful. Else, returns 1 if unable, in which case the slot is left empty.
+*/
+int GB_Load_Game( GameBoy *gb, char *path ) {
+	FILE *romFile; //Points to ROM file, if successfully opened
+	long fileSize = -1; //Size of ROM file in bytes
+	uint8_t *image; //Mapped or read contents of ROM file, before sharing
+	enum GB_ImageSource source = GB_IMAGE_MAPPED; //How image was obtained
+
+	GB_Unload_Game( gb );
+
+	//Open file, and find its size
+	romFile = fopen( path, "rb" );
+	if ( romFile && !fseek( romFile, 0, SEEK_END ) ) {
+		fileSize = ftell( romFile );
+		rewind( romFile );
+	}//end if
 
-		//Attempt to load ROM Bank 1
-		if ( fread( gb->cart.rom1, 1, 0x4000, romFile ) > 0 ) {
-			dprintf( "ROM Bank 1 loaded. First byte test: 0x%02X\n", gb->cart.rom1[0] );
+	if ( !romFile || fileSize <= 0 ) {
+		GB_ERROR( gb, "Unable to load any cartridge ROM. Emulating empty cartridge slot instead.\n" );
+
+		if ( romFile ) fclose( romFile );
+		Map_Inserted_Cartridge( gb );
+		return 0;
+	}//end if
+	GB_DEBUG( gb, "Successfully opened cartridge ROM file (0x%lX bytes).\n", fileSize );
+
+	//Map file, or read it whole
+	image = Map_ROM_File( fileno( romFile ), (size_t)fileSize );
+	if ( !image ) {
+		source = GB_IMAGE_ALLOCATED;
+		image = calloc( 1, Round_ROM_Size( (size_t)fileSize ) );
+		if ( image && fread( image, 1, (size_t)fileSize, romFile ) != (size_t)fileSize ) {
+			free( image );
+			image = NULL;
 		}//end if
+	}//end if
+	fclose( romFile );
+
+	if ( !image ) {
+		GB_ERROR( gb, "Unable to read cartridge ROM file.\n" );
 
-		//Disable external RAM
-		gb->cart.extram = NULL;
+		Map_Inserted_Cartridge( gb );
+		return 1;
 	}//end if
-	//Else, unable to load ROM. Emulate empty cartridge slot.
-	else {
-		eprintf( "Unable to load any cartridge ROM. Emulating empty cartridge slot instead.\n" );
 
-		//Disable ROM banks and external RAM
-		gb->cart.rom0 = NULL;
-		gb->cart.rom1 = NULL;
-		gb->cart.extram = NULL;
-	}//end if-else
+	//Share image with other systems running the same game
+	gb->cart.romImage = GB_Acquire_Image( gb, image, (size_t)fileSize, Round_ROM_Size( (size_t)fileSize ), source );
+	if ( !( gb->cart.romImage ) ) {
+		Map_Inserted_Cartridge( gb );
+		return 1;
+	}//end if
+	gb->cart.romSize = Round_ROM_Size( (size_t)fileSize );
+
+	if ( Insert_Cartridge( gb ) ) {
+		GB_Unload_Game( gb );
+		Map_Inserted_Cartridge( gb );
+		return 1;
+	}//end if
 
-	if ( romFile )
-		fclose( romFile );
+	Map_Inserted_Cartridge( gb );
 
 	return 0;
 }//end function GB_Load_Game
 
-/*	Attempts to allocate memory and load boot ROM contents from file at the supplied path.
+/*	Attempts to load the given boot ROM image of the given size, shared with every other system using the same boot ROM. Any previously loaded boot ROM is released.
 *	If successful:
-*		Loads memory for boot ROM from file.
 *		Sets the Boot ROM Disable register (0xFF50) to 0.
 *		Sets the Program Counter to 0x0.
-*	If unsuccessful:
+*	If boot is NULL, not 0x100 bytes, or cannot be copied:
 *		Sets the Boot ROM Disable register to 1.
 *		Initializes register values to their post-Boot ROM values.
 */
-void GB_Load_BootROM( GameBoy *gb, char *path ) {
-	FILE *bootromFile = NULL; //Points to bootrom file, if successfully loaded
-	long fileSize = 0; //Size of loaded boot ROM file in bytes
-
-	//Pre-allocate boot ROM
-	gb->cpu.boot = malloc( 0x100 );
-	if ( !( gb->cpu.boot ) ) eprintf( "Unable to allocate memory for boot ROM.\n" );
-	else dprintf( "Boot ROM allocated.\n" );
-
-	fopen_s( &bootromFile, path, "rb" );
-
-	//Get file size
-	if ( bootromFile ) {
-		fseek( bootromFile, 0, SEEK_END );
-		fileSize = ftell( bootromFile );
-		rewind( bootromFile );
+void GB_Load_BootROM_Buffer( GameBoy *gb, const uint8_t *boot, size_t size ) {
+	GB_Release_Image( gb->cpu.boot );
+	gb->cpu.boot = boot && size == 0x100 ? GB_Acquire_Image( gb, boot, 0x100, 0x100, GB_IMAGE_BORROWED ) : NULL;
 
-		dprintf( "Successfully opened boot ROM file (0x%lX bytes).\n", fileSize );
-	}//end if
-
-	//If able to open, load bootrom and prepare for execution
-	if ( gb->cpu.boot && bootromFile && fileSize == 0x100 ) {
+	//If able to load, prepare for execution of bootrom
+	if ( gb->cpu.boot ) {
 
-		//Load boot ROM
-		fread( gb->cpu.boot, 1, 0x100, bootromFile );
-		dprintf( "Boot ROM loaded. First byte test: 0x%X\n", gb->cpu.boot[0] );
+		//Report boot ROM
+		GB_DEBUG( gb, "Boot ROM loaded. First byte test: 0x%X\n", gb->cpu.boot[0] );
 
 		//Set BANK register
-		*( gb->io[0x50] ) = 0;
-		dprintf( "BANK register set to %X\n", *( gb->io[0x50] ) );
+		gb->io[0x50] = 0;
+		GB_DEBUG( gb, "BANK register set to %X\n", gb->io[0x50] );
 
 		//Initialize PC register
 		gb->cpu.pc = 0x0;
-		dprintf( "PC set to %04X\n", gb->cpu.pc );
+		GB_DEBUG( gb, "PC set to %04X\n", gb->cpu.pc );
 
 	}//end if
 	//Unable to load bootrom, prepare for post-bootrom execution
 	else {
-		gb->cpu.boot = NULL;
-		eprintf( "Unable to load boot ROM. Loading alternative setup.\n" );
+		if ( boot ) GB_ERROR( gb, "Unable to load boot ROM. Loading alternative setup.\n" );
+		else GB_DEBUG( gb, "No boot ROM. Loading alternative setup.\n" );
 
 		//Initialize CPU registers
-		*( gb->cpu.a ) = 0x01;
-		*( gb->cpu.f ) = 0x00;
-		*( gb->cpu.b ) = 0x00;
-		*( gb->cpu.c ) = 0x13;
-		*( gb->cpu.d ) = 0x00;
-		*( gb->cpu.e ) = 0xD8;
-		*( gb->cpu.h ) = 0x01;
-		*( gb->cpu.l ) = 0x4D;
+		gb->cpu.a = 0x01;
+		gb->cpu.f = 0x00;
+		gb->cpu.b = 0x00;
+		gb->cpu.c = 0x13;
+		gb->cpu.d = 0x00;
+		gb->cpu.e = 0xD8;
+		gb->cpu.h = 0x01;
+		gb->cpu.l = 0x4D;
 		gb->cpu.pc = 0x0100;
 		gb->cpu.sp = 0xFFFE;
-		dprintf( "Initialized CPU registers to post-boot ROM state.\n" );
+		GB_DEBUG( gb, "Initialized CPU registers to post-boot ROM state.\n" );
 
 		//Initialize other I/O registers
-		*( gb->io[0x00] ) = 0xCF; //P1
-		*( gb->io[0x01] ) = 0x00; //SB
-		*( gb->io[0x02] ) = 0x7E; //SC
-		*( gb->io[0x04] ) = 0xAB; //DIV
-		*( gb->io[0x05] ) = 0x00; //TIMA
-		*( gb->io[0x06] ) = 0x00; //TMA
-		*( gb->io[0x07] ) = 0xF8; //TAC
-		*( gb->io[0x0F] ) = 0xE1; //IF
+		gb->io[0x00] = 0xCF; //P1
+		gb->io[0x01] = 0x00; //SB
+		gb->io[0x02] = 0x7E; //SC
+		gb->io[0x04] = 0xAB; //DIV
+		gb->io[0x05] = 0x00; //TIMA
+		gb->io[0x06] = 0x00; //TMA
+		gb->io[0x07] = 0xF8; //TAC
+		gb->io[0x0F] = 0xE1; //IF
 		//Skipping sound registers
-		*( gb->io[0x40] ) = 0x91; //LCDC
-		*( gb->io[0x41] ) = 0x85; //STAT
-		*( gb->io[0x42] ) = 0x00; //SCY
-		*( gb->io[0x43] ) = 0x00; //SCX
-		*( gb->io[0x44] ) = 0x00; //LY
-		*( gb->io[0x45] ) = 0x00; //LYC
-		*( gb->io[0x46] ) = 0xFF; //DMA
-		*( gb->io[0x47] ) = 0xFC; //BGP
+		gb->io[0x40] = 0x91; //LCDC
+		gb->io[0x41] = 0x85; //STAT
+		gb->io[0x42] = 0x00; //SCY
+		gb->io[0x43] = 0x00; //SCX
+		gb->io[0x44] = 0x00; //LY
+		gb->io[0x45] = 0x00; //LYC
+		gb->io[0x46] = 0xFF; //DMA
+		gb->io[0x47] = 0xFC; //BGP
 		//OBP0 and OBP1 left uninitialized
-		*( gb->io[0x4A] ) = 0x00; //WY
-		*( gb->io[0x4B] ) = 0xFC; //WX
-		*( gb->io[0x50] ) = 0x01; //BANK
+		gb->io[0x4A] = 0x00; //WY
+		gb->io[0x4B] = 0xFC; //WX
+		gb->io[0x50] = 0x01; //BANK
 		gb->cpu.hram[0x7F] = 0x00; //IE
-		dprintf( "Initialized I/O registers to post-boot ROM state.\n" );
+		GB_DEBUG( gb, "Initialized I/O registers to post-boot ROM state.\n" );
 	}//end else
 
-	//Close file
+	//Map or unmap boot ROM
+	GB_Map_ROM( gb );
+	GB_Block_Cache_Flush( gb );
+	GB_JIT_Flush( gb );
+
+	return;
+}//end function GB_Load_BootROM_Buffer
+
+/*	Attempts to load the boot ROM file at the supplied path, as GB_Load_BootROM_Buffer() does.
+*	If the file cannot be opened or is not 0x100 bytes, loads the alternative post-Boot ROM setup instead.
+*/
+void GB_Load_BootROM( GameBoy *gb, char *path ) {
+	FILE *bootromFile = NULL; //Points to bootrom file, if successfully loaded
+	uint8_t boot[0x100]; //Contents of boot ROM
+	long fileSize = 0; //Size of loaded boot ROM file in bytes
+
+	bootromFile = fopen( path, "rb" );
+
+	//Get file size, and read it if it fits
 	if ( bootromFile ) {
+		fseek( bootromFile, 0, SEEK_END );
+		fileSize = ftell( bootromFile );
+		rewind( bootromFile );
+
+		GB_DEBUG( gb, "Successfully opened boot ROM file (0x%lX bytes).\n", fileSize );
+
+		if ( fileSize != 0x100 || fread( boot, 1, 0x100, bootromFile ) != 0x100 ) fileSize = 0;
+
 		fclose( bootromFile );
-		dprintf( "Closed boot ROM file.\n" );
+		GB_DEBUG( gb, "Closed boot ROM file.\n" );
 	}//end if
 
+	if ( fileSize == 0x100 ) GB_Load_BootROM_Buffer( gb, boot, 0x100 );
+	else {
+		GB_ERROR( gb, "Unable to load boot ROM. Loading alternative setup.\n" );
+		GB_Load_BootROM_Buffer( gb, NULL, 0 );
+	}//end if-else
+
 	return;
-}//end function GB_Load_BootROM
\ No newline at end of file
+}//end function GB_Load_BootROM
@@ -0,0 +1,23 @@
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "GameBoy.h"
+
+#define GB_LOG_MESSAGE_SIZE 256 //Maximum length of one message, including its terminator. Longer messages are cut short.
+
+/*	Formats a message as printf does, and reports it through the given system's log callback.
+*	Without a callback, errors are written to stderr and debug messages to stdout.
+*/
+void GB_Log( const GameBoy *gb, enum GB_LogLevel level, const char *format, ... ) {
+	char message[GB_LOG_MESSAGE_SIZE]; //Formatted message
+	va_list args; //Arguments to format
+
+	va_start( args, format );
+	vsnprintf( message, sizeof( message ), format, args );
+	va_end( args );
+
+	if ( gb->callbacks.log ) gb->callbacks.log( gb->callbacks.userData, level, message );
+	else fputs( message, level == GB_LOG_ERROR ? stderr : stdout );
+
+	return;
+}//end function GB_Log
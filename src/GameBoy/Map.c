@@ -0,0 +1,396 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "GameBoy.h"
+
+/* Read handler for blocked regions and unconnected cartridge pins. */
+static uint8_t Read_Open_Bus( GameBoy *gb, uint16_t addr ) {
+	(void)gb;
+	(void)addr;
+
+	return 0xFF;
+}//end function Read_Open_Bus
+
+/* Write handler for blocked regions and unconnected cartridge pins. Writes are ignored. */
+static void Write_Ignored( GameBoy *gb, uint16_t addr, uint8_t value ) {
+	(void)gb;
+	(void)addr;
+	(void)value;
+
+	return;
+}//end function Write_Ignored
+
+/*	Selects the cartridge's ROM and external RAM banks from its memory bank controller registers, by pointing rom0, rom1 and extram into its images.
+*	Bank numbers beyond the end of the cartridge wrap around, as the unconnected upper bank lines of a real cartridge would.
+*/
+static void Select_Banks( GameBoy *gb ) {
+	struct GB_GamePak *cart = &( gb->cart ); //Cartridge being banked
+	unsigned romBanks = (unsigned)( cart->romSize / 0x4000 ); //Number of 16 KB ROM banks
+	unsigned ramBanks = (unsigned)( cart->extramSize / 0x2000 ); //Number of 8 KB RAM banks
+	unsigned rom0Bank = 0; //Lower ROM bank number
+	unsigned rom1Bank; //Upper ROM bank number
+	unsigned ramBank = 0; //RAM bank number. 0x08 or higher selects an MBC3 clock register.
+
+	if ( !( cart->romImage ) ) {
+		cart->rom0 = NULL;
+		cart->rom1 = NULL;
+		cart->extram = NULL;
+		return;
+	}//end if
+
+	switch ( cart->mbc ) {
+	case GB_MBC1: //Bank 0 of the lower 5 bits selects bank 1, even with upper bits set
+		rom1Bank = ( cart->ramBank << 5 ) | ( cart->romBank ? cart->romBank : 1 );
+		if ( cart->bankMode ) {
+			rom0Bank = cart->ramBank << 5;
+			ramBank = cart->ramBank;
+		}//end if
+		break;
+
+	case GB_MBC3:
+		rom1Bank = cart->romBank ? cart->romBank : 1;
+		ramBank = cart->ramBank;
+		break;
+
+	case GB_MBC5: //Bank 0 may be selected as the upper bank
+		rom1Bank = cart->romBank;
+		ramBank = cart->ramBank;
+		break;
+
+	default:
+		rom1Bank = 1;
+		break;
+	}//end switch
+
+	cart->rom0 = cart->romImage + (size_t)( rom0Bank % romBanks ) * 0x4000;
+	cart->rom1 = cart->romImage + (size_t)( rom1Bank % romBanks ) * 0x4000;
+	if ( cart->extramImage && cart->isExtRAMEnabled && ramBank < 0x08 ) cart->extram = cart->extramImage + (size_t)( ramBank % ramBanks ) * 0x2000;
+	else cart->extram = NULL;
+
+	//Accessible RAM may be written to without notice, so must be compared against the save file at the end of the frame
+	if ( cart->extram ) cart->isSaveStale = true;
+
+	return;
+}//end function Select_Banks
+
+/*	Write handler for cartridge ROM, which sets the registers of the cartridge's memory bank controller, if any.
+*	Switching banks only repoints the ROM and external RAM pages into the cartridge's images, so nothing is copied.
+*/
+static void Write_ROM( GameBoy *gb, uint16_t addr, uint8_t value ) {
+	struct GB_GamePak *cart = &( gb->cart ); //Cartridge being written
+
+	switch ( cart->mbc ) {
+	case GB_MBC1:
+		if ( addr < 0x2000 ) cart->isExtRAMEnabled = ( value & 0x0F ) == 0x0A;
+		else if ( addr < 0x4000 ) cart->romBank = value & 0x1F;
+		else if ( addr < 0x6000 ) cart->ramBank = value & 0x03;
+		else cart->bankMode = value & 0x01;
+		break;
+
+	case GB_MBC3:
+		if ( addr < 0x2000 ) cart->isExtRAMEnabled = ( value & 0x0F ) == 0x0A;
+		else if ( addr < 0x4000 ) cart->romBank = value & 0x7F;
+		else if ( addr < 0x6000 ) cart->ramBank = value & 0x0F;
+		else return; //Clock latch. The real-time clock is not emulated.
+		break;
+
+	case GB_MBC5:
+		if ( addr < 0x2000 ) cart->isExtRAMEnabled = ( value & 0x0F ) == 0x0A;
+		else if ( addr < 0x3000 ) cart->romBank = ( cart->romBank & 0x100 ) | value;
+		else if ( addr < 0x4000 ) cart->romBank = ( cart->romBank & 0xFF ) | ( value & 0x01 ) << 8;
+		else if ( addr < 0x6000 ) cart->ramBank = value & 0x0F;
+		else return;
+		break;
+
+	default: //No MBC. Writes are ignored.
+		return;
+	}//end switch
+
+	GB_Map_Cartridge( gb );
+
+	return;
+}//end function Write_ROM
+
+/* Read handler for the page containing OAM and the Unusable Area. */
+static uint8_t Read_OAM_Page( GameBoy *gb, uint16_t addr ) {
+	uint8_t byte; //The byte read by this operation
+
+	//OAM
+	if ( addr < 0xFEA0 ) {
+		if ( !gb->cpu.ppu.isOAMBlocked ) byte = gb->cpu.ppu.oam[addr - 0xFE00];
+		else byte = 0xFF;
+
+		//If read during Mode 2, trigger OAM Corruption Bug
+
+	}//end if
+
+	//Unusable Area
+	else {
+		if ( !gb->cpu.ppu.isOAMBlocked ) byte = 0x00;
+		else byte = 0xFF;
+		GB_TRACE( gb, GB_TRACE_INVALID, addr, byte );
+
+		//If read during Mode 2, trigger OAM Corruption Bug
+
+	}//end if-else
+
+	return byte;
+}//end function Read_OAM_Page
+
+/* Write handler for unblocked VRAM. Reads are direct, but writes first bring the LCD up to date, as rendering is deferred. */
+static void Write_VRAM( GameBoy *gb, uint16_t addr, uint8_t value ) {
+	GB_PPU_Catch_Up( gb );
+	gb->vram[addr - 0x8000] = value;
+
+	return;
+}//end function Write_VRAM
+
+/* Write handler for the page containing OAM and the Unusable Area. */
+static void Write_OAM_Page( GameBoy *gb, uint16_t addr, uint8_t value ) {
+
+	//OAM
+	if ( addr < 0xFEA0 ) {
+		if ( !gb->cpu.ppu.isOAMBlocked ) {
+			GB_PPU_Catch_Up( gb );
+			gb->cpu.ppu.oam[addr - 0xFE00] = value;
+		}//end if
+	}//end if
+
+	//Unusable Area
+	else GB_TRACE( gb, GB_TRACE_INVALID, addr, value );
+
+	return;
+}//end function Write_OAM_Page
+
+/* Returns whether the I/O register at the given offset from 0xFF00 exists on the DMG Game Boy. */
+static bool Is_IO_Register_Used( uint8_t index ) {
+	return index <= 0x02 //0xFF00 - 0xFF02
+		|| ( index >= 0x04 && index <= 0x07 ) //0xFF04 - 0xFF07
+		|| ( index >= 0x0F && index <= 0x14 ) //0xFF0F - 0xFF14
+		|| ( index >= 0x16 && index <= 0x26 ) //0xFF16 - 0xFF26
+		|| ( index >= 0x30 && index <= 0x4B ) //0xFF30 - 0xFF4B
+		|| index == 0x50; //0xFF50
+}//end function Is_IO_Register_Used
+
+/* Returns the value of the P1/JOYP register from its button-group selection bits and the buttons pressed this frame. Pressed buttons read as 0. */
+static uint8_t Read_Joypad( GameBoy *gb ) {
+	uint8_t lines = 0x0F; //Lower 4 bits of P1. Each selected group pulls the lines of its pressed buttons low.
+
+	//Direction buttons
+	if ( !( gb->io[0x00] & 0x10 ) ) {
+		if ( gb->buttons & ( 1 << GB_RIGHT ) ) lines &= ~0x01;
+		if ( gb->buttons & ( 1 << GB_LEFT ) ) lines &= ~0x02;
+		if ( gb->buttons & ( 1 << GB_UP ) ) lines &= ~0x04;
+		if ( gb->buttons & ( 1 << GB_DOWN ) ) lines &= ~0x08;
+	}//end if
+
+	//Action buttons
+	if ( !( gb->io[0x00] & 0x20 ) ) {
+		if ( gb->buttons & ( 1 << GB_A ) ) lines &= ~0x01;
+		if ( gb->buttons & ( 1 << GB_B ) ) lines &= ~0x02;
+		if ( gb->buttons & ( 1 << GB_SELECT ) ) lines &= ~0x04;
+		if ( gb->buttons & ( 1 << GB_START ) ) lines &= ~0x08;
+	}//end if
+
+	return 0xC0 | ( gb->io[0x00] & 0x30 ) | lines;
+}//end function Read_Joypad
+
+/* Read handler for the page containing the I/O registers, HRAM, and the IE register. */
+static uint8_t Read_IO_Page( GameBoy *gb, uint16_t addr ) {
+	uint8_t byte; //The byte read by this operation
+
+	//HRAM and IE register
+	if ( addr >= 0xFF80 ) {
+		byte = gb->cpu.hram[addr - 0xFF80];
+	}//end if
+
+	//P1/JOYP register
+	else if ( addr == 0xFF00 ) byte = Read_Joypad( gb );
+
+	//I/O registers
+	else {
+		if ( Is_IO_Register_Used( addr - 0xFF00 ) ) byte = gb->io[addr - 0xFF00];
+		else {
+			byte = 0xFF;
+			GB_TRACE( gb, GB_TRACE_INVALID, addr, byte );
+		}//end else
+	}//end if-else
+
+	return byte;
+}//end function Read_IO_Page
+
+/* Write handler for the page containing the I/O registers, HRAM, and the IE register. Performs the side effects of writing to each I/O register. */
+static void Write_IO_Page( GameBoy *gb, uint16_t addr, uint8_t value ) {
+	uint8_t index = addr & 0xFF; //Offset of written address from 0xFF00
+
+	//HRAM and IE register
+	if ( addr >= 0xFF80 ) {
+		gb->cpu.hram[addr - 0xFF80] = value;
+		return;
+	}//end if
+
+	//Unused I/O registers
+	if ( !Is_IO_Register_Used( index ) ) {
+		GB_TRACE( gb, GB_TRACE_INVALID, addr, value );
+		return;
+	}//end if
+
+	//Render the pixels drawn before a write to LCDC, SCY, SCX, BGP, OBP0, OBP1, WY or WX
+	if ( index == 0x40 || index == 0x42 || index == 0x43 || ( index >= 0x47 && index <= 0x4B ) ) GB_PPU_Catch_Up( gb );
+
+	switch ( index ) {
+	case 0x00: //P1/JOYP. Only button-group selection bits are writable.
+		gb->io[0x00] = ( gb->io[0x00] & ~0x30 ) | ( value & 0x30 );
+		break;
+
+	case 0x02: //SC. No link partner, so internally clocked transfers complete at once, shifting in 0xFF.
+		gb->io[0x02] = value | 0x7E;
+		if ( ( value & 0x81 ) == 0x81 ) {
+			gb->io[0x01] = 0xFF;
+			gb->io[0x02] &= ~0x80;
+			gb->io[0x0F] |= GB_INT_SERIAL;
+			GB_TRACE( gb, GB_TRACE_INTERRUPT, 0xFF0F, GB_INT_SERIAL );
+		}//end if
+		break;
+
+	case 0x04: //DIV. Any write resets to 0.
+		GB_Reset_DIV( gb );
+		break;
+
+	case 0x07: //TAC
+		gb->io[0x07] = value | 0xF8;
+		GB_Update_Timer( gb );
+		break;
+
+	case 0x0F: //IF
+		gb->io[0x0F] = value | 0xE0;
+		break;
+
+	case 0x40: //LCDC
+		if ( ( gb->io[0x40] ^ value ) & 0x80 ) {
+			gb->io[0x40] = value;
+			GB_Set_LCD_Enabled( gb, value & 0x80 );
+		}//end if
+		else gb->io[0x40] = value;
+		break;
+
+	case 0x41: //STAT. Mode and coincidence bits are read-only.
+		gb->io[0x41] = 0x80 | ( value & 0x78 ) | ( gb->io[0x41] & 0x07 );
+		break;
+
+	case 0x44: //LY. Read-only.
+		break;
+
+	case 0x45: //LYC
+		gb->io[0x45] = value;
+		GB_Compare_LY_LYC( gb );
+		break;
+
+	case 0x46: //DMA
+		gb->io[0x46] = value;
+		GB_Start_DMA( gb, value );
+		break;
+
+	case 0x50: //BANK. Any non-zero write permanently unmaps the boot ROM.
+		if ( gb->io[0x50] == 0x00 && value ) {
+			gb->io[0x50] = 0x01;
+			GB_Map_ROM( gb );
+			GB_DEBUG( gb, "Boot ROM unmapped.\n" );
+		}//end if
+		break;
+
+	default:
+		gb->io[index] = value;
+		break;
+	}//end switch
+
+	return;
+}//end function Write_IO_Page
+
+/*	Maps the given range of pages to consecutive pages of the given host memory, or to the open-bus handlers if the memory is missing or blocked.
+*	Read-only memory is read directly, but written through the ROM write handler.
+*/
+static void Map_Pages( GameBoy *gb, int firstPage, int lastPage, uint8_t *memory, bool isBlocked, bool isWritable ) {
+	for ( int page = firstPage; page <= lastPage; ++page ) {
+		struct GB_MemoryPage *entry = &( gb->memoryMap[page] ); //Memory map entry being updated
+
+		if ( memory && !isBlocked ) {
+			entry->readMemory = memory + ( ( page - firstPage ) << 8 );
+			entry->read = NULL;
+			entry->writeMemory = isWritable ? entry->readMemory : NULL;
+			entry->write = isWritable ? NULL : Write_ROM;
+		}//end if
+		else {
+			entry->readMemory = NULL;
+			entry->read = Read_Open_Bus;
+			entry->writeMemory = NULL;
+			entry->write = isWritable ? Write_Ignored : Write_ROM;
+		}//end if-else
+	}//end for
+
+	return;
+}//end function Map_Pages
+
+/* Maps a single page to the given read and write handlers. */
+static void Map_Handlers( GameBoy *gb, int page, uint8_t ( *read )( GameBoy *, uint16_t ), void ( *write )( GameBoy *, uint16_t, uint8_t ) ) {
+	gb->memoryMap[page].readMemory = NULL;
+	gb->memoryMap[page].read = read;
+	gb->memoryMap[page].writeMemory = NULL;
+	gb->memoryMap[page].write = write;
+
+	return;
+}//end function Map_Handlers
+
+/*	Rebuilds the entire memory map from the current state of the system's memory regions.
+*	Must be called after memory regions are allocated or loaded, and after the system state is copied into a new location.
+*/
+void GB_Map_Memory( GameBoy *gb ) {
+	GB_Map_Cartridge( gb );
+	GB_Map_VRAM( gb );
+
+	Map_Pages( gb, 0xC0, 0xDF, gb->wram, gb->isWRAMBlocked, true ); //WRAM
+	Map_Pages( gb, 0xE0, 0xFD, gb->wram, gb->isWRAMBlocked, true ); //Echo WRAM
+
+	Map_Handlers( gb, 0xFE, Read_OAM_Page, Write_OAM_Page );
+	Map_Handlers( gb, 0xFF, Read_IO_Page, Write_IO_Page );
+
+	GB_DEBUG( gb, "Memory map rebuilt.\n" );
+
+	return;
+}//end function GB_Map_Memory
+
+/* Selects the cartridge's ROM and external RAM banks from its memory bank controller registers, and remaps them. Must be called whenever a bank register changes. */
+void GB_Map_Cartridge( GameBoy *gb ) {
+	Select_Banks( gb );
+	GB_Map_ROM( gb );
+	Map_Pages( gb, 0xA0, 0xBF, gb->cart.extram, gb->cart.isExtRAMBlocked, true ); //External RAM
+
+	return;
+}//end function GB_Map_Cartridge
+
+/* Remaps the boot ROM and the selected cartridge ROM banks. Must be called whenever the boot ROM is unmapped or a ROM bank is switched. */
+void GB_Map_ROM( GameBoy *gb ) {
+	gb->romMapCount += 1;
+
+	Map_Pages( gb, 0x00, 0x3F, gb->cart.rom0, gb->cart.isROM0Blocked, false ); //Lower ROM bank
+	Map_Pages( gb, 0x40, 0x7F, gb->cart.rom1, gb->cart.isROM1Blocked, false ); //Upper ROM bank
+
+	//Boot ROM overlays the first page of the lower ROM bank until disabled
+	if ( gb->cpu.boot && gb->io[0x50] == 0x00 ) Map_Pages( gb, 0x00, 0x00, gb->cpu.boot, false, false );
+
+	return;
+}//end function GB_Map_ROM
+
+/* Remaps VRAM. Must be called whenever VRAM becomes blocked or unblocked. Unblocked VRAM is read directly, but written through its handler. */
+void GB_Map_VRAM( GameBoy *gb ) {
+	Map_Pages( gb, 0x80, 0x9F, gb->vram, gb->isVRAMBlocked, true );
+
+	if ( !( gb->isVRAMBlocked ) ) {
+		for ( int page = 0x80; page <= 0x9F; ++page ) {
+			gb->memoryMap[page].writeMemory = NULL;
+			gb->memoryMap[page].write = Write_VRAM;
+		}//end for
+	}//end if
+
+	return;
+}//end function GB_Map_VRAM
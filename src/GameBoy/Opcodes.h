@@ -0,0 +1,836 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "GameBoy.h"
+
+/*	SM83 opcode description table and instruction handlers.
+*	Each instruction is described once below as GB_OPCODE( opcode, mnemonic, operation, operand1, operand2, cycles ), where:
+*		operation selects the handler macro OP_<operation>,
+*		operands name registers (A ~ L, BC ~ AF), memory operands (HLI = (HL), HLIP = (HL+), HLIM = (HL-), BCI = (BC), DEI = (DE), CI = (0xFF00 + C), A8I = (0xFF00 + a8)),
+*			immediates (D8, D16, A16 = 16-bit address, R8 = signed offset, CB = second opcode byte), conditions (NZ, Z, NC, C), or literal numbers for RST vectors and bit indices,
+*		cycles is the T-State count of the instruction, or of its not-taken path for conditional instructions. Checked against the T-States actually spent in DEBUG builds.
+*	Instruction lengths are derived from the immediate operands, so every immediate an instruction fetches must be named by an operand.
+*	Users expand the table by defining GB_OPCODE, and must define the following before including this file:
+*		FETCH8() - Fetches the next instruction byte.
+*		GB_READ( addr ) / GB_WRITE( addr, value ) - Performs a memory access.
+*		TICK( cycles ) - Spends internal CPU cycles that perform no memory access.
+*	OP_PREFIX_CB and OP_ILLEGAL are dispatch-specific and also left to users. All handlers expect a local GameBoy *gb.
+*/
+
+#define GB_BASE_OPCODES \
+	GB_OPCODE( 0x00, "NOP", NOP, NONE, NONE, 4 ) \
+	GB_OPCODE( 0x01, "LD BC,d16", LD16_IMM, BC, D16, 12 ) \
+	GB_OPCODE( 0x02, "LD (BC),A", LD8, BCI, A, 8 ) \
+	GB_OPCODE( 0x03, "INC BC", INC16, BC, NONE, 8 ) \
+	GB_OPCODE( 0x04, "INC B", INC8, B, NONE, 4 ) \
+	GB_OPCODE( 0x05, "DEC B", DEC8, B, NONE, 4 ) \
+	GB_OPCODE( 0x06, "LD B,d8", LD8, B, D8, 8 ) \
+	GB_OPCODE( 0x07, "RLCA", RLCA, NONE, NONE, 4 ) \
+	GB_OPCODE( 0x08, "LD (a16),SP", LD_A16_SP, A16, NONE, 20 ) \
+	GB_OPCODE( 0x09, "ADD HL,BC", ADD_HL, BC, NONE, 8 ) \
+	GB_OPCODE( 0x0A, "LD A,(BC)", LD8, A, BCI, 8 ) \
+	GB_OPCODE( 0x0B, "DEC BC", DEC16, BC, NONE, 8 ) \
+	GB_OPCODE( 0x0C, "INC C", INC8, C, NONE, 4 ) \
+	GB_OPCODE( 0x0D, "DEC C", DEC8, C, NONE, 4 ) \
+	GB_OPCODE( 0x0E, "LD C,d8", LD8, C, D8, 8 ) \
+	GB_OPCODE( 0x0F, "RRCA", RRCA, NONE, NONE, 4 ) \
+	GB_OPCODE( 0x10, "STOP", STOP, D8, NONE, 8 ) \
+	GB_OPCODE( 0x11, "LD DE,d16", LD16_IMM, DE, D16, 12 ) \
+	GB_OPCODE( 0x12, "LD (DE),A", LD8, DEI, A, 8 ) \
+	GB_OPCODE( 0x13, "INC DE", INC16, DE, NONE, 8 ) \
+	GB_OPCODE( 0x14, "INC D", INC8, D, NONE, 4 ) \
+	GB_OPCODE( 0x15, "DEC D", DEC8, D, NONE, 4 ) \
+	GB_OPCODE( 0x16, "LD D,d8", LD8, D, D8, 8 ) \
+	GB_OPCODE( 0x17, "RLA", RLA, NONE, NONE, 4 ) \
+	GB_OPCODE( 0x18, "JR r8", JR, R8, NONE, 12 ) \
+	GB_OPCODE( 0x19, "ADD HL,DE", ADD_HL, DE, NONE, 8 ) \
+	GB_OPCODE( 0x1A, "LD A,(DE)", LD8, A, DEI, 8 ) \
+	GB_OPCODE( 0x1B, "DEC DE", DEC16, DE, NONE, 8 ) \
+	GB_OPCODE( 0x1C, "INC E", INC8, E, NONE, 4 ) \
+	GB_OPCODE( 0x1D, "DEC E", DEC8, E, NONE, 4 ) \
+	GB_OPCODE( 0x1E, "LD E,d8", LD8, E, D8, 8 ) \
+	GB_OPCODE( 0x1F, "RRA", RRA, NONE, NONE, 4 ) \
+	GB_OPCODE( 0x20, "JR NZ,r8", JR_CC, NZ, R8, 8 ) \
+	GB_OPCODE( 0x21, "LD HL,d16", LD16_IMM, HL, D16, 12 ) \
+	GB_OPCODE( 0x22, "LD (HL+),A", LD8, HLIP, A, 8 ) \
+	GB_OPCODE( 0x23, "INC HL", INC16, HL, NONE, 8 ) \
+	GB_OPCODE( 0x24, "INC H", INC8, H, NONE, 4 ) \
+	GB_OPCODE( 0x25, "DEC H", DEC8, H, NONE, 4 ) \
+	GB_OPCODE( 0x26, "LD H,d8", LD8, H, D8, 8 ) \
+	GB_OPCODE( 0x27, "DAA", DAA, NONE, NONE, 4 ) \
+	GB_OPCODE( 0x28, "JR Z,r8", JR_CC, Z, R8, 8 ) \
+	GB_OPCODE( 0x29, "ADD HL,HL", ADD_HL, HL, NONE, 8 ) \
+	GB_OPCODE( 0x2A, "LD A,(HL+)", LD8, A, HLIP, 8 ) \
+	GB_OPCODE( 0x2B, "DEC HL", DEC16, HL, NONE, 8 ) \
+	GB_OPCODE( 0x2C, "INC L", INC8, L, NONE, 4 ) \
+	GB_OPCODE( 0x2D, "DEC L", DEC8, L, NONE, 4 ) \
+	GB_OPCODE( 0x2E, "LD L,d8", LD8, L, D8, 8 ) \
+	GB_OPCODE( 0x2F, "CPL", CPL, NONE, NONE, 4 ) \
+	GB_OPCODE( 0x30, "JR NC,r8", JR_CC, NC, R8, 8 ) \
+	GB_OPCODE( 0x31, "LD SP,d16", LD16_IMM, SP, D16, 12 ) \
+	GB_OPCODE( 0x32, "LD (HL-),A", LD8, HLIM, A, 8 ) \
+	GB_OPCODE( 0x33, "INC SP", INC16, SP, NONE, 8 ) \
+	GB_OPCODE( 0x34, "INC (HL)", INC8, HLI, NONE, 12 ) \
+	GB_OPCODE( 0x35, "DEC (HL)", DEC8, HLI, NONE, 12 ) \
+	GB_OPCODE( 0x36, "LD (HL),d8", LD8, HLI, D8, 12 ) \
+	GB_OPCODE( 0x37, "SCF", SCF, NONE, NONE, 4 ) \
+	GB_OPCODE( 0x38, "JR C,r8", JR_CC, C, R8, 8 ) \
+	GB_OPCODE( 0x39, "ADD HL,SP", ADD_HL, SP, NONE, 8 ) \
+	GB_OPCODE( 0x3A, "LD A,(HL-)", LD8, A, HLIM, 8 ) \
+	GB_OPCODE( 0x3B, "DEC SP", DEC16, SP, NONE, 8 ) \
+	GB_OPCODE( 0x3C, "INC A", INC8, A, NONE, 4 ) \
+	GB_OPCODE( 0x3D, "DEC A", DEC8, A, NONE, 4 ) \
+	GB_OPCODE( 0x3E, "LD A,d8", LD8, A, D8, 8 ) \
+	GB_OPCODE( 0x3F, "CCF", CCF, NONE, NONE, 4 ) \
+	GB_OPCODE( 0x40, "LD B,B", LD8, B, B, 4 ) \
+	GB_OPCODE( 0x41, "LD B,C", LD8, B, C, 4 ) \
+	GB_OPCODE( 0x42, "LD B,D", LD8, B, D, 4 ) \
+	GB_OPCODE( 0x43, "LD B,E", LD8, B, E, 4 ) \
+	GB_OPCODE( 0x44, "LD B,H", LD8, B, H, 4 ) \
+	GB_OPCODE( 0x45, "LD B,L", LD8, B, L, 4 ) \
+	GB_OPCODE( 0x46, "LD B,(HL)", LD8, B, HLI, 8 ) \
+	GB_OPCODE( 0x47, "LD B,A", LD8, B, A, 4 ) \
+	GB_OPCODE( 0x48, "LD C,B", LD8, C, B, 4 ) \
+	GB_OPCODE( 0x49, "LD C,C", LD8, C, C, 4 ) \
+	GB_OPCODE( 0x4A, "LD C,D", LD8, C, D, 4 ) \
+	GB_OPCODE( 0x4B, "LD C,E", LD8, C, E, 4 ) \
+	GB_OPCODE( 0x4C, "LD C,H", LD8, C, H, 4 ) \
+	GB_OPCODE( 0x4D, "LD C,L", LD8, C, L, 4 ) \
+	GB_OPCODE( 0x4E, "LD C,(HL)", LD8, C, HLI, 8 ) \
+	GB_OPCODE( 0x4F, "LD C,A", LD8, C, A, 4 ) \
+	GB_OPCODE( 0x50, "LD D,B", LD8, D, B, 4 ) \
+	GB_OPCODE( 0x51, "LD D,C", LD8, D, C, 4 ) \
+	GB_OPCODE( 0x52, "LD D,D", LD8, D, D, 4 ) \
+	GB_OPCODE( 0x53, "LD D,E", LD8, D, E, 4 ) \
+	GB_OPCODE( 0x54, "LD D,H", LD8, D, H, 4 ) \
+	GB_OPCODE( 0x55, "LD D,L", LD8, D, L, 4 ) \
+	GB_OPCODE( 0x56, "LD D,(HL)", LD8, D, HLI, 8 ) \
+	GB_OPCODE( 0x57, "LD D,A", LD8, D, A, 4 ) \
+	GB_OPCODE( 0x58, "LD E,B", LD8, E, B, 4 ) \
+	GB_OPCODE( 0x59, "LD E,C", LD8, E, C, 4 ) \
+	GB_OPCODE( 0x5A, "LD E,D", LD8, E, D, 4 ) \
+	GB_OPCODE( 0x5B, "LD E,E", LD8, E, E, 4 ) \
+	GB_OPCODE( 0x5C, "LD E,H", LD8, E, H, 4 ) \
+	GB_OPCODE( 0x5D, "LD E,L", LD8, E, L, 4 ) \
+	GB_OPCODE( 0x5E, "LD E,(HL)", LD8, E, HLI, 8 ) \
+	GB_OPCODE( 0x5F, "LD E,A", LD8, E, A, 4 ) \
+	GB_OPCODE( 0x60, "LD H,B", LD8, H, B, 4 ) \
+	GB_OPCODE( 0x61, "LD H,C", LD8, H, C, 4 ) \
+	GB_OPCODE( 0x62, "LD H,D", LD8, H, D, 4 ) \
+	GB_OPCODE( 0x63, "LD H,E", LD8, H, E, 4 ) \
+	GB_OPCODE( 0x64, "LD H,H", LD8, H, H, 4 ) \
+	GB_OPCODE( 0x65, "LD H,L", LD8, H, L, 4 ) \
+	GB_OPCODE( 0x66, "LD H,(HL)", LD8, H, HLI, 8 ) \
+	GB_OPCODE( 0x67, "LD H,A", LD8, H, A, 4 ) \
+	GB_OPCODE( 0x68, "LD L,B", LD8, L, B, 4 ) \
+	GB_OPCODE( 0x69, "LD L,C", LD8, L, C, 4 ) \
+	GB_OPCODE( 0x6A, "LD L,D", LD8, L, D, 4 ) \
+	GB_OPCODE( 0x6B, "LD L,E", LD8, L, E, 4 ) \
+	GB_OPCODE( 0x6C, "LD L,H", LD8, L, H, 4 ) \
+	GB_OPCODE( 0x6D, "LD L,L", LD8, L, L, 4 ) \
+	GB_OPCODE( 0x6E, "LD L,(HL)", LD8, L, HLI, 8 ) \
+	GB_OPCODE( 0x6F, "LD L,A", LD8, L, A, 4 ) \
+	GB_OPCODE( 0x70, "LD (HL),B", LD8, HLI, B, 8 ) \
+	GB_OPCODE( 0x71, "LD (HL),C", LD8, HLI, C, 8 ) \
+	GB_OPCODE( 0x72, "LD (HL),D", LD8, HLI, D, 8 ) \
+	GB_OPCODE( 0x73, "LD (HL),E", LD8, HLI, E, 8 ) \
+	GB_OPCODE( 0x74, "LD (HL),H", LD8, HLI, H, 8 ) \
+	GB_OPCODE( 0x75, "LD (HL),L", LD8, HLI, L, 8 ) \
+	GB_OPCODE( 0x76, "HALT", HALT, NONE, NONE, 4 ) \
+	GB_OPCODE( 0x77, "LD (HL),A", LD8, HLI, A, 8 ) \
+	GB_OPCODE( 0x78, "LD A,B", LD8, A, B, 4 ) \
+	GB_OPCODE( 0x79, "LD A,C", LD8, A, C, 4 ) \
+	GB_OPCODE( 0x7A, "LD A,D", LD8, A, D, 4 ) \
+	GB_OPCODE( 0x7B, "LD A,E", LD8, A, E, 4 ) \
+	GB_OPCODE( 0x7C, "LD A,H", LD8, A, H, 4 ) \
+	GB_OPCODE( 0x7D, "LD A,L", LD8, A, L, 4 ) \
+	GB_OPCODE( 0x7E, "LD A,(HL)", LD8, A, HLI, 8 ) \
+	GB_OPCODE( 0x7F, "LD A,A", LD8, A, A, 4 ) \
+	GB_OPCODE( 0x80, "ADD A,B", ADD, B, NONE, 4 ) \
+	GB_OPCODE( 0x81, "ADD A,C", ADD, C, NONE, 4 ) \
+	GB_OPCODE( 0x82, "ADD A,D", ADD, D, NONE, 4 ) \
+	GB_OPCODE( 0x83, "ADD A,E", ADD, E, NONE, 4 ) \
+	GB_OPCODE( 0x84, "ADD A,H", ADD, H, NONE, 4 ) \
+	GB_OPCODE( 0x85, "ADD A,L", ADD, L, NONE, 4 ) \
+	GB_OPCODE( 0x86, "ADD A,(HL)", ADD, HLI, NONE, 8 ) \
+	GB_OPCODE( 0x87, "ADD A,A", ADD, A, NONE, 4 ) \
+	GB_OPCODE( 0x88, "ADC A,B", ADC, B, NONE, 4 ) \
+	GB_OPCODE( 0x89, "ADC A,C", ADC, C, NONE, 4 ) \
+	GB_OPCODE( 0x8A, "ADC A,D", ADC, D, NONE, 4 ) \
+	GB_OPCODE( 0x8B, "ADC A,E", ADC, E, NONE, 4 ) \
+	GB_OPCODE( 0x8C, "ADC A,H", ADC, H, NONE, 4 ) \
+	GB_OPCODE( 0x8D, "ADC A,L", ADC, L, NONE, 4 ) \
+	GB_OPCODE( 0x8E, "ADC A,(HL)", ADC, HLI, NONE, 8 ) \
+	GB_OPCODE( 0x8F, "ADC A,A", ADC, A, NONE, 4 ) \
+	GB_OPCODE( 0x90, "SUB B", SUB, B, NONE, 4 ) \
+	GB_OPCODE( 0x91, "SUB C", SUB, C, NONE, 4 ) \
+	GB_OPCODE( 0x92, "SUB D", SUB, D, NONE, 4 ) \
+	GB_OPCODE( 0x93, "SUB E", SUB, E, NONE, 4 ) \
+	GB_OPCODE( 0x94, "SUB H", SUB, H, NONE, 4 ) \
+	GB_OPCODE( 0x95, "SUB L", SUB, L, NONE, 4 ) \
+	GB_OPCODE( 0x96, "SUB (HL)", SUB, HLI, NONE, 8 ) \
+	GB_OPCODE( 0x97, "SUB A", SUB, A, NONE, 4 ) \
+	GB_OPCODE( 0x98, "SBC A,B", SBC, B, NONE, 4 ) \
+	GB_OPCODE( 0x99, "SBC A,C", SBC, C, NONE, 4 ) \
+	GB_OPCODE( 0x9A, "SBC A,D", SBC, D, NONE, 4 ) \
+	GB_OPCODE( 0x9B, "SBC A,E", SBC, E, NONE, 4 ) \
+	GB_OPCODE( 0x9C, "SBC A,H", SBC, H, NONE, 4 ) \
+	GB_OPCODE( 0x9D, "SBC A,L", SBC, L, NONE, 4 ) \
+	GB_OPCODE( 0x9E, "SBC A,(HL)", SBC, HLI, NONE, 8 ) \
+	GB_OPCODE( 0x9F, "SBC A,A", SBC, A, NONE, 4 ) \
+	GB_OPCODE( 0xA0, "AND B", AND, B, NONE, 4 ) \
+	GB_OPCODE( 0xA1, "AND C", AND, C, NONE, 4 ) \
+	GB_OPCODE( 0xA2, "AND D", AND, D, NONE, 4 ) \
+	GB_OPCODE( 0xA3, "AND E", AND, E, NONE, 4 ) \
+	GB_OPCODE( 0xA4, "AND H", AND, H, NONE, 4 ) \
+	GB_OPCODE( 0xA5, "AND L", AND, L, NONE, 4 ) \
+	GB_OPCODE( 0xA6, "AND (HL)", AND, HLI, NONE, 8 ) \
+	GB_OPCODE( 0xA7, "AND A", AND, A, NONE, 4 ) \
+	GB_OPCODE( 0xA8, "XOR B", XOR, B, NONE, 4 ) \
+	GB_OPCODE( 0xA9, "XOR C", XOR, C, NONE, 4 ) \
+	GB_OPCODE( 0xAA, "XOR D", XOR, D, NONE, 4 ) \
+	GB_OPCODE( 0xAB, "XOR E", XOR, E, NONE, 4 ) \
+	GB_OPCODE( 0xAC, "XOR H", XOR, H, NONE, 4 ) \
+	GB_OPCODE( 0xAD, "XOR L", XOR, L, NONE, 4 ) \
+	GB_OPCODE( 0xAE, "XOR (HL)", XOR, HLI, NONE, 8 ) \
+	GB_OPCODE( 0xAF, "XOR A", XOR, A, NONE, 4 ) \
+	GB_OPCODE( 0xB0, "OR B", OR, B, NONE, 4 ) \
+	GB_OPCODE( 0xB1, "OR C", OR, C, NONE, 4 ) \
+	GB_OPCODE( 0xB2, "OR D", OR, D, NONE, 4 ) \
+	GB_OPCODE( 0xB3, "OR E", OR, E, NONE, 4 ) \
+	GB_OPCODE( 0xB4, "OR H", OR, H, NONE, 4 ) \
+	GB_OPCODE( 0xB5, "OR L", OR, L, NONE, 4 ) \
+	GB_OPCODE( 0xB6, "OR (HL)", OR, HLI, NONE, 8 ) \
+	GB_OPCODE( 0xB7, "OR A", OR, A, NONE, 4 ) \
+	GB_OPCODE( 0xB8, "CP B", CP, B, NONE, 4 ) \
+	GB_OPCODE( 0xB9, "CP C", CP, C, NONE, 4 ) \
+	GB_OPCODE( 0xBA, "CP D", CP, D, NONE, 4 ) \
+	GB_OPCODE( 0xBB, "CP E", CP, E, NONE, 4 ) \
+	GB_OPCODE( 0xBC, "CP H", CP, H, NONE, 4 ) \
+	GB_OPCODE( 0xBD, "CP L", CP, L, NONE, 4 ) \
+	GB_OPCODE( 0xBE, "CP (HL)", CP, HLI, NONE, 8 ) \
+	GB_OPCODE( 0xBF, "CP A", CP, A, NONE, 4 ) \
+	GB_OPCODE( 0xC0, "RET NZ", RET_CC, NZ, NONE, 8 ) \
+	GB_OPCODE( 0xC1, "POP BC", POP, BC, NONE, 12 ) \
+	GB_OPCODE( 0xC2, "JP NZ,a16", JP_CC, NZ, A16, 12 ) \
+	GB_OPCODE( 0xC3, "JP a16", JP, A16, NONE, 16 ) \
+	GB_OPCODE( 0xC4, "CALL NZ,a16", CALL_CC, NZ, A16, 12 ) \
+	GB_OPCODE( 0xC5, "PUSH BC", PUSH, BC, NONE, 16 ) \
+	GB_OPCODE( 0xC6, "ADD A,d8", ADD, D8, NONE, 8 ) \
+	GB_OPCODE( 0xC7, "RST 00H", RST, 0x00, NONE, 16 ) \
+	GB_OPCODE( 0xC8, "RET Z", RET_CC, Z, NONE, 8 ) \
+	GB_OPCODE( 0xC9, "RET", RET, NONE, NONE, 16 ) \
+	GB_OPCODE( 0xCA, "JP Z,a16", JP_CC, Z, A16, 12 ) \
+	GB_OPCODE( 0xCB, "PREFIX CB", PREFIX_CB, CB, NONE, 4 ) \
+	GB_OPCODE( 0xCC, "CALL Z,a16", CALL_CC, Z, A16, 12 ) \
+	GB_OPCODE( 0xCD, "CALL a16", CALL, A16, NONE, 24 ) \
+	GB_OPCODE( 0xCE, "ADC A,d8", ADC, D8, NONE, 8 ) \
+	GB_OPCODE( 0xCF, "RST 08H", RST, 0x08, NONE, 16 ) \
+	GB_OPCODE( 0xD0, "RET NC", RET_CC, NC, NONE, 8 ) \
+	GB_OPCODE( 0xD1, "POP DE", POP, DE, NONE, 12 ) \
+	GB_OPCODE( 0xD2, "JP NC,a16", JP_CC, NC, A16, 12 ) \
+	GB_OPCODE( 0xD3, "ILLEGAL", ILLEGAL, NONE, NONE, 4 ) \
+	GB_OPCODE( 0xD4, "CALL NC,a16", CALL_CC, NC, A16, 12 ) \
+	GB_OPCODE( 0xD5, "PUSH DE", PUSH, DE, NONE, 16 ) \
+	GB_OPCODE( 0xD6, "SUB d8", SUB, D8, NONE, 8 ) \
+	GB_OPCODE( 0xD7, "RST 10H", RST, 0x10, NONE, 16 ) \
+	GB_OPCODE( 0xD8, "RET C", RET_CC, C, NONE, 8 ) \
+	GB_OPCODE( 0xD9, "RETI", RETI, NONE, NONE, 16 ) \
+	GB_OPCODE( 0xDA, "JP C,a16", JP_CC, C, A16, 12 ) \
+	GB_OPCODE( 0xDB, "ILLEGAL", ILLEGAL, NONE, NONE, 4 ) \
+	GB_OPCODE( 0xDC, "CALL C,a16", CALL_CC, C, A16, 12 ) \
+	GB_OPCODE( 0xDD, "ILLEGAL", ILLEGAL, NONE, NONE, 4 ) \
+	GB_OPCODE( 0xDE, "SBC A,d8", SBC, D8, NONE, 8 ) \
+	GB_OPCODE( 0xDF, "RST 18H", RST, 0x18, NONE, 16 ) \
+	GB_OPCODE( 0xE0, "LDH (a8),A", LD8, A8I, A, 12 ) \
+	GB_OPCODE( 0xE1, "POP HL", POP, HL, NONE, 12 ) \
+	GB_OPCODE( 0xE2, "LD (C),A", LD8, CI, A, 8 ) \
+	GB_OPCODE( 0xE3, "ILLEGAL", ILLEGAL, NONE, NONE, 4 ) \
+	GB_OPCODE( 0xE4, "ILLEGAL", ILLEGAL, NONE, NONE, 4 ) \
+	GB_OPCODE( 0xE5, "PUSH HL", PUSH, HL, NONE, 16 ) \
+	GB_OPCODE( 0xE6, "AND d8", AND, D8, NONE, 8 ) \
+	GB_OPCODE( 0xE7, "RST 20H", RST, 0x20, NONE, 16 ) \
+	GB_OPCODE( 0xE8, "ADD SP,r8", ADD_SP_E, R8, NONE, 16 ) \
+	GB_OPCODE( 0xE9, "JP HL", JP_HL, NONE, NONE, 4 ) \
+	GB_OPCODE( 0xEA, "LD (a16),A", LD_A16_A, A16, NONE, 16 ) \
+	GB_OPCODE( 0xEB, "ILLEGAL", ILLEGAL, NONE, NONE, 4 ) \
+	GB_OPCODE( 0xEC, "ILLEGAL", ILLEGAL, NONE, NONE, 4 ) \
+	GB_OPCODE( 0xED, "ILLEGAL", ILLEGAL, NONE, NONE, 4 ) \
+	GB_OPCODE( 0xEE, "XOR d8", XOR, D8, NONE, 8 ) \
+	GB_OPCODE( 0xEF, "RST 28H", RST, 0x28, NONE, 16 ) \
+	GB_OPCODE( 0xF0, "LDH A,(a8)", LD8, A, A8I, 12 ) \
+	GB_OPCODE( 0xF1, "POP AF", POP, AF, NONE, 12 ) \
+	GB_OPCODE( 0xF2, "LD A,(C)", LD8, A, CI, 8 ) \
+	GB_OPCODE( 0xF3, "DI", DI, NONE, NONE, 4 ) \
+	GB_OPCODE( 0xF4, "ILLEGAL", ILLEGAL, NONE, NONE, 4 ) \
+	GB_OPCODE( 0xF5, "PUSH AF", PUSH, AF, NONE, 16 ) \
+	GB_OPCODE( 0xF6, "OR d8", OR, D8, NONE, 8 ) \
+	GB_OPCODE( 0xF7, "RST 30H", RST, 0x30, NONE, 16 ) \
+	GB_OPCODE( 0xF8, "LD HL,SP+r8", LD_HL_SP_E, R8, NONE, 12 ) \
+	GB_OPCODE( 0xF9, "LD SP,HL", LD_SP_HL, NONE, NONE, 8 ) \
+	GB_OPCODE( 0xFA, "LD A,(a16)", LD_A_A16, A16, NONE, 16 ) \
+	GB_OPCODE( 0xFB, "EI", EI, NONE, NONE, 4 ) \
+	GB_OPCODE( 0xFC, "ILLEGAL", ILLEGAL, NONE, NONE, 4 ) \
+	GB_OPCODE( 0xFD, "ILLEGAL", ILLEGAL, NONE, NONE, 4 ) \
+	GB_OPCODE( 0xFE, "CP d8", CP, D8, NONE, 8 ) \
+	GB_OPCODE( 0xFF, "RST 38H", RST, 0x38, NONE, 16 )
+
+#define GB_CB_OPCODES \
+	GB_OPCODE( 0x00, "RLC B", RLC, B, NONE, 8 ) \
+	GB_OPCODE( 0x01, "RLC C", RLC, C, NONE, 8 ) \
+	GB_OPCODE( 0x02, "RLC D", RLC, D, NONE, 8 ) \
+	GB_OPCODE( 0x03, "RLC E", RLC, E, NONE, 8 ) \
+	GB_OPCODE( 0x04, "RLC H", RLC, H, NONE, 8 ) \
+	GB_OPCODE( 0x05, "RLC L", RLC, L, NONE, 8 ) \
+	GB_OPCODE( 0x06, "RLC (HL)", RLC, HLI, NONE, 16 ) \
+	GB_OPCODE( 0x07, "RLC A", RLC, A, NONE, 8 ) \
+	GB_OPCODE( 0x08, "RRC B", RRC, B, NONE, 8 ) \
+	GB_OPCODE( 0x09, "RRC C", RRC, C, NONE, 8 ) \
+	GB_OPCODE( 0x0A, "RRC D", RRC, D, NONE, 8 ) \
+	GB_OPCODE( 0x0B, "RRC E", RRC, E, NONE, 8 ) \
+	GB_OPCODE( 0x0C, "RRC H", RRC, H, NONE, 8 ) \
+	GB_OPCODE( 0x0D, "RRC L", RRC, L, NONE, 8 ) \
+	GB_OPCODE( 0x0E, "RRC (HL)", RRC, HLI, NONE, 16 ) \
+	GB_OPCODE( 0x0F, "RRC A", RRC, A, NONE, 8 ) \
+	GB_OPCODE( 0x10, "RL B", RL, B, NONE, 8 ) \
+	GB_OPCODE( 0x11, "RL C", RL, C, NONE, 8 ) \
+	GB_OPCODE( 0x12, "RL D", RL, D, NONE, 8 ) \
+	GB_OPCODE( 0x13, "RL E", RL, E, NONE, 8 ) \
+	GB_OPCODE( 0x14, "RL H", RL, H, NONE, 8 ) \
+	GB_OPCODE( 0x15, "RL L", RL, L, NONE, 8 ) \
+	GB_OPCODE( 0x16, "RL (HL)", RL, HLI, NONE, 16 ) \
+	GB_OPCODE( 0x17, "RL A", RL, A, NONE, 8 ) \
+	GB_OPCODE( 0x18, "RR B", RR, B, NONE, 8 ) \
+	GB_OPCODE( 0x19, "RR C", RR, C, NONE, 8 ) \
+	GB_OPCODE( 0x1A, "RR D", RR, D, NONE, 8 ) \
+	GB_OPCODE( 0x1B, "RR E", RR, E, NONE, 8 ) \
+	GB_OPCODE( 0x1C, "RR H", RR, H, NONE, 8 ) \
+	GB_OPCODE( 0x1D, "RR L", RR, L, NONE, 8 ) \
+	GB_OPCODE( 0x1E, "RR (HL)", RR, HLI, NONE, 16 ) \
+	GB_OPCODE( 0x1F, "RR A", RR, A, NONE, 8 ) \
+	GB_OPCODE( 0x20, "SLA B", SLA, B, NONE, 8 ) \
+	GB_OPCODE( 0x21, "SLA C", SLA, C, NONE, 8 ) \
+	GB_OPCODE( 0x22, "SLA D", SLA, D, NONE, 8 ) \
+	GB_OPCODE( 0x23, "SLA E", SLA, E, NONE, 8 ) \
+	GB_OPCODE( 0x24, "SLA H", SLA, H, NONE, 8 ) \
+	GB_OPCODE( 0x25, "SLA L", SLA, L, NONE, 8 ) \
+	GB_OPCODE( 0x26, "SLA (HL)", SLA, HLI, NONE, 16 ) \
+	GB_OPCODE( 0x27, "SLA A", SLA, A, NONE, 8 ) \
+	GB_OPCODE( 0x28, "SRA B", SRA, B, NONE, 8 ) \
+	GB_OPCODE( 0x29, "SRA C", SRA, C, NONE, 8 ) \
+	GB_OPCODE( 0x2A, "SRA D", SRA, D, NONE, 8 ) \
+	GB_OPCODE( 0x2B, "SRA E", SRA, E, NONE, 8 ) \
+	GB_OPCODE( 0x2C, "SRA H", SRA, H, NONE, 8 ) \
+	GB_OPCODE( 0x2D, "SRA L", SRA, L, NONE, 8 ) \
+	GB_OPCODE( 0x2E, "SRA (HL)", SRA, HLI, NONE, 16 ) \
+	GB_OPCODE( 0x2F, "SRA A", SRA, A, NONE, 8 ) \
+	GB_OPCODE( 0x30, "SWAP B", SWAP, B, NONE, 8 ) \
+	GB_OPCODE( 0x31, "SWAP C", SWAP, C, NONE, 8 ) \
+	GB_OPCODE( 0x32, "SWAP D", SWAP, D, NONE, 8 ) \
+	GB_OPCODE( 0x33, "SWAP E", SWAP, E, NONE, 8 ) \
+	GB_OPCODE( 0x34, "SWAP H", SWAP, H, NONE, 8 ) \
+	GB_OPCODE( 0x35, "SWAP L", SWAP, L, NONE, 8 ) \
+	GB_OPCODE( 0x36, "SWAP (HL)", SWAP, HLI, NONE, 16 ) \
+	GB_OPCODE( 0x37, "SWAP A", SWAP, A, NONE, 8 ) \
+	GB_OPCODE( 0x38, "SRL B", SRL, B, NONE, 8 ) \
+	GB_OPCODE( 0x39, "SRL C", SRL, C, NONE, 8 ) \
+	GB_OPCODE( 0x3A, "SRL D", SRL, D, NONE, 8 ) \
+	GB_OPCODE( 0x3B, "SRL E", SRL, E, NONE, 8 ) \
+	GB_OPCODE( 0x3C, "SRL H", SRL, H, NONE, 8 ) \
+	GB_OPCODE( 0x3D, "SRL L", SRL, L, NONE, 8 ) \
+	GB_OPCODE( 0x3E, "SRL (HL)", SRL, HLI, NONE, 16 ) \
+	GB_OPCODE( 0x3F, "SRL A", SRL, A, NONE, 8 ) \
+	GB_OPCODE( 0x40, "BIT 0,B", BIT, 0, B, 8 ) \
+	GB_OPCODE( 0x41, "BIT 0,C", BIT, 0, C, 8 ) \
+	GB_OPCODE( 0x42, "BIT 0,D", BIT, 0, D, 8 ) \
+	GB_OPCODE( 0x43, "BIT 0,E", BIT, 0, E, 8 ) \
+	GB_OPCODE( 0x44, "BIT 0,H", BIT, 0, H, 8 ) \
+	GB_OPCODE( 0x45, "BIT 0,L", BIT, 0, L, 8 ) \
+	GB_OPCODE( 0x46, "BIT 0,(HL)", BIT, 0, HLI, 12 ) \
+	GB_OPCODE( 0x47, "BIT 0,A", BIT, 0, A, 8 ) \
+	GB_OPCODE( 0x48, "BIT 1,B", BIT, 1, B, 8 ) \
+	GB_OPCODE( 0x49, "BIT 1,C", BIT, 1, C, 8 ) \
+	GB_OPCODE( 0x4A, "BIT 1,D", BIT, 1, D, 8 ) \
+	GB_OPCODE( 0x4B, "BIT 1,E", BIT, 1, E, 8 ) \
+	GB_OPCODE( 0x4C, "BIT 1,H", BIT, 1, H, 8 ) \
+	GB_OPCODE( 0x4D, "BIT 1,L", BIT, 1, L, 8 ) \
+	GB_OPCODE( 0x4E, "BIT 1,(HL)", BIT, 1, HLI, 12 ) \
+	GB_OPCODE( 0x4F, "BIT 1,A", BIT, 1, A, 8 ) \
+	GB_OPCODE( 0x50, "BIT 2,B", BIT, 2, B, 8 ) \
+	GB_OPCODE( 0x51, "BIT 2,C", BIT, 2, C, 8 ) \
+	GB_OPCODE( 0x52, "BIT 2,D", BIT, 2, D, 8 ) \
+	GB_OPCODE( 0x53, "BIT 2,E", BIT, 2, E, 8 ) \
+	GB_OPCODE( 0x54, "BIT 2,H", BIT, 2, H, 8 ) \
+	GB_OPCODE( 0x55, "BIT 2,L", BIT, 2, L, 8 ) \
+	GB_OPCODE( 0x56, "BIT 2,(HL)", BIT, 2, HLI, 12 ) \
+	GB_OPCODE( 0x57, "BIT 2,A", BIT, 2, A, 8 ) \
+	GB_OPCODE( 0x58, "BIT 3,B", BIT, 3, B, 8 ) \
+	GB_OPCODE( 0x59, "BIT 3,C", BIT, 3, C, 8 ) \
+	GB_OPCODE( 0x5A, "BIT 3,D", BIT, 3, D, 8 ) \
+	GB_OPCODE( 0x5B, "BIT 3,E", BIT, 3, E, 8 ) \
+	GB_OPCODE( 0x5C, "BIT 3,H", BIT, 3, H, 8 ) \
+	GB_OPCODE( 0x5D, "BIT 3,L", BIT, 3, L, 8 ) \
+	GB_OPCODE( 0x5E, "BIT 3,(HL)", BIT, 3, HLI, 12 ) \
+	GB_OPCODE( 0x5F, "BIT 3,A", BIT, 3, A, 8 ) \
+	GB_OPCODE( 0x60, "BIT 4,B", BIT, 4, B, 8 ) \
+	GB_OPCODE( 0x61, "BIT 4,C", BIT, 4, C, 8 ) \
+	GB_OPCODE( 0x62, "BIT 4,D", BIT, 4, D, 8 ) \
+	GB_OPCODE( 0x63, "BIT 4,E", BIT, 4, E, 8 ) \
+	GB_OPCODE( 0x64, "BIT 4,H", BIT, 4, H, 8 ) \
+	GB_OPCODE( 0x65, "BIT 4,L", BIT, 4, L, 8 ) \
+	GB_OPCODE( 0x66, "BIT 4,(HL)", BIT, 4, HLI, 12 ) \
+	GB_OPCODE( 0x67, "BIT 4,A", BIT, 4, A, 8 ) \
+	GB_OPCODE( 0x68, "BIT 5,B", BIT, 5, B, 8 ) \
+	GB_OPCODE( 0x69, "BIT 5,C", BIT, 5, C, 8 ) \
+	GB_OPCODE( 0x6A, "BIT 5,D", BIT, 5, D, 8 ) \
+	GB_OPCODE( 0x6B, "BIT 5,E", BIT, 5, E, 8 ) \
+	GB_OPCODE( 0x6C, "BIT 5,H", BIT, 5, H, 8 ) \
+	GB_OPCODE( 0x6D, "BIT 5,L", BIT, 5, L, 8 ) \
+	GB_OPCODE( 0x6E, "BIT 5,(HL)", BIT, 5, HLI, 12 ) \
+	GB_OPCODE( 0x6F, "BIT 5,A", BIT, 5, A, 8 ) \
+	GB_OPCODE( 0x70, "BIT 6,B", BIT, 6, B, 8 ) \
+	GB_OPCODE( 0x71, "BIT 6,C", BIT, 6, C, 8 ) \
+	GB_OPCODE( 0x72, "BIT 6,D", BIT, 6, D, 8 ) \
+	GB_OPCODE( 0x73, "BIT 6,E", BIT, 6, E, 8 ) \
+	GB_OPCODE( 0x74, "BIT 6,H", BIT, 6, H, 8 ) \
+	GB_OPCODE( 0x75, "BIT 6,L", BIT, 6, L, 8 ) \
+	GB_OPCODE( 0x76, "BIT 6,(HL)", BIT, 6, HLI, 12 ) \
+	GB_OPCODE( 0x77, "BIT 6,A", BIT, 6, A, 8 ) \
+	GB_OPCODE( 0x78, "BIT 7,B", BIT, 7, B, 8 ) \
+	GB_OPCODE( 0x79, "BIT 7,C", BIT, 7, C, 8 ) \
+	GB_OPCODE( 0x7A, "BIT 7,D", BIT, 7, D, 8 ) \
+	GB_OPCODE( 0x7B, "BIT 7,E", BIT, 7, E, 8 ) \
+	GB_OPCODE( 0x7C, "BIT 7,H", BIT, 7, H, 8 ) \
+	GB_OPCODE( 0x7D, "BIT 7,L", BIT, 7, L, 8 ) \
+	GB_OPCODE( 0x7E, "BIT 7,(HL)", BIT, 7, HLI, 12 ) \
+	GB_OPCODE( 0x7F, "BIT 7,A", BIT, 7, A, 8 ) \
+	GB_OPCODE( 0x80, "RES 0,B", RES, 0, B, 8 ) \
+	GB_OPCODE( 0x81, "RES 0,C", RES, 0, C, 8 ) \
+	GB_OPCODE( 0x82, "RES 0,D", RES, 0, D, 8 ) \
+	GB_OPCODE( 0x83, "RES 0,E", RES, 0, E, 8 ) \
+	GB_OPCODE( 0x84, "RES 0,H", RES, 0, H, 8 ) \
+	GB_OPCODE( 0x85, "RES 0,L", RES, 0, L, 8 ) \
+	GB_OPCODE( 0x86, "RES 0,(HL)", RES, 0, HLI, 16 ) \
+	GB_OPCODE( 0x87, "RES 0,A", RES, 0, A, 8 ) \
+	GB_OPCODE( 0x88, "RES 1,B", RES, 1, B, 8 ) \
+	GB_OPCODE( 0x89, "RES 1,C", RES, 1, C, 8 ) \
+	GB_OPCODE( 0x8A, "RES 1,D", RES, 1, D, 8 ) \
+	GB_OPCODE( 0x8B, "RES 1,E", RES, 1, E, 8 ) \
+	GB_OPCODE( 0x8C, "RES 1,H", RES, 1, H, 8 ) \
+	GB_OPCODE( 0x8D, "RES 1,L", RES, 1, L, 8 ) \
+	GB_OPCODE( 0x8E, "RES 1,(HL)", RES, 1, HLI, 16 ) \
+	GB_OPCODE( 0x8F, "RES 1,A", RES, 1, A, 8 ) \
+	GB_OPCODE( 0x90, "RES 2,B", RES, 2, B, 8 ) \
+	GB_OPCODE( 0x91, "RES 2,C", RES, 2, C, 8 ) \
+	GB_OPCODE( 0x92, "RES 2,D", RES, 2, D, 8 ) \
+	GB_OPCODE( 0x93, "RES 2,E", RES, 2, E, 8 ) \
+	GB_OPCODE( 0x94, "RES 2,H", RES, 2, H, 8 ) \
+	GB_OPCODE( 0x95, "RES 2,L", RES, 2, L, 8 ) \
+	GB_OPCODE( 0x96, "RES 2,(HL)", RES, 2, HLI, 16 ) \
+	GB_OPCODE( 0x97, "RES 2,A", RES, 2, A, 8 ) \
+	GB_OPCODE( 0x98, "RES 3,B", RES, 3, B, 8 ) \
+	GB_OPCODE( 0x99, "RES 3,C", RES, 3, C, 8 ) \
+	GB_OPCODE( 0x9A, "RES 3,D", RES, 3, D, 8 ) \
+	GB_OPCODE( 0x9B, "RES 3,E", RES, 3, E, 8 ) \
+	GB_OPCODE( 0x9C, "RES 3,H", RES, 3, H, 8 ) \
+	GB_OPCODE( 0x9D, "RES 3,L", RES, 3, L, 8 ) \
+	GB_OPCODE( 0x9E, "RES 3,(HL)", RES, 3, HLI, 16 ) \
+	GB_OPCODE( 0x9F, "RES 3,A", RES, 3, A, 8 ) \
+	GB_OPCODE( 0xA0, "RES 4,B", RES, 4, B, 8 ) \
+	GB_OPCODE( 0xA1, "RES 4,C", RES, 4, C, 8 ) \
+	GB_OPCODE( 0xA2, "RES 4,D", RES, 4, D, 8 ) \
+	GB_OPCODE( 0xA3, "RES 4,E", RES, 4, E, 8 ) \
+	GB_OPCODE( 0xA4, "RES 4,H", RES, 4, H, 8 ) \
+	GB_OPCODE( 0xA5, "RES 4,L", RES, 4, L, 8 ) \
+	GB_OPCODE( 0xA6, "RES 4,(HL)", RES, 4, HLI, 16 ) \
+	GB_OPCODE( 0xA7, "RES 4,A", RES, 4, A, 8 ) \
+	GB_OPCODE( 0xA8, "RES 5,B", RES, 5, B, 8 ) \
+	GB_OPCODE( 0xA9, "RES 5,C", RES, 5, C, 8 ) \
+	GB_OPCODE( 0xAA, "RES 5,D", RES, 5, D, 8 ) \
+	GB_OPCODE( 0xAB, "RES 5,E", RES, 5, E, 8 ) \
+	GB_OPCODE( 0xAC, "RES 5,H", RES, 5, H, 8 ) \
+	GB_OPCODE( 0xAD, "RES 5,L", RES, 5, L, 8 ) \
+	GB_OPCODE( 0xAE, "RES 5,(HL)", RES, 5, HLI, 16 ) \
+	GB_OPCODE( 0xAF, "RES 5,A", RES, 5, A, 8 ) \
+	GB_OPCODE( 0xB0, "RES 6,B", RES, 6, B, 8 ) \
+	GB_OPCODE( 0xB1, "RES 6,C", RES, 6, C, 8 ) \
+	GB_OPCODE( 0xB2, "RES 6,D", RES, 6, D, 8 ) \
+	GB_OPCODE( 0xB3, "RES 6,E", RES, 6, E, 8 ) \
+	GB_OPCODE( 0xB4, "RES 6,H", RES, 6, H, 8 ) \
+	GB_OPCODE( 0xB5, "RES 6,L", RES, 6, L, 8 ) \
+	GB_OPCODE( 0xB6, "RES 6,(HL)", RES, 6, HLI, 16 ) \
+	GB_OPCODE( 0xB7, "RES 6,A", RES, 6, A, 8 ) \
+	GB_OPCODE( 0xB8, "RES 7,B", RES, 7, B, 8 ) \
+	GB_OPCODE( 0xB9, "RES 7,C", RES, 7, C, 8 ) \
+	GB_OPCODE( 0xBA, "RES 7,D", RES, 7, D, 8 ) \
+	GB_OPCODE( 0xBB, "RES 7,E", RES, 7, E, 8 ) \
+	GB_OPCODE( 0xBC, "RES 7,H", RES, 7, H, 8 ) \
+	GB_OPCODE( 0xBD, "RES 7,L", RES, 7, L, 8 ) \
+	GB_OPCODE( 0xBE, "RES 7,(HL)", RES, 7, HLI, 16 ) \
+	GB_OPCODE( 0xBF, "RES 7,A", RES, 7, A, 8 ) \
+	GB_OPCODE( 0xC0, "SET 0,B", SET, 0, B, 8 ) \
+	GB_OPCODE( 0xC1, "SET 0,C", SET, 0, C, 8 ) \
+	GB_OPCODE( 0xC2, "SET 0,D", SET, 0, D, 8 ) \
+	GB_OPCODE( 0xC3, "SET 0,E", SET, 0, E, 8 ) \
+	GB_OPCODE( 0xC4, "SET 0,H", SET, 0, H, 8 ) \
+	GB_OPCODE( 0xC5, "SET 0,L", SET, 0, L, 8 ) \
+	GB_OPCODE( 0xC6, "SET 0,(HL)", SET, 0, HLI, 16 ) \
+	GB_OPCODE( 0xC7, "SET 0,A", SET, 0, A, 8 ) \
+	GB_OPCODE( 0xC8, "SET 1,B", SET, 1, B, 8 ) \
+	GB_OPCODE( 0xC9, "SET 1,C", SET, 1, C, 8 ) \
+	GB_OPCODE( 0xCA, "SET 1,D", SET, 1, D, 8 ) \
+	GB_OPCODE( 0xCB, "SET 1,E", SET, 1, E, 8 ) \
+	GB_OPCODE( 0xCC, "SET 1,H", SET, 1, H, 8 ) \
+	GB_OPCODE( 0xCD, "SET 1,L", SET, 1, L, 8 ) \
+	GB_OPCODE( 0xCE, "SET 1,(HL)", SET, 1, HLI, 16 ) \
+	GB_OPCODE( 0xCF, "SET 1,A", SET, 1, A, 8 ) \
+	GB_OPCODE( 0xD0, "SET 2,B", SET, 2, B, 8 ) \
+	GB_OPCODE( 0xD1, "SET 2,C", SET, 2, C, 8 ) \
+	GB_OPCODE( 0xD2, "SET 2,D", SET, 2, D, 8 ) \
+	GB_OPCODE( 0xD3, "SET 2,E", SET, 2, E, 8 ) \
+	GB_OPCODE( 0xD4, "SET 2,H", SET, 2, H, 8 ) \
+	GB_OPCODE( 0xD5, "SET 2,L", SET, 2, L, 8 ) \
+	GB_OPCODE( 0xD6, "SET 2,(HL)", SET, 2, HLI, 16 ) \
+	GB_OPCODE( 0xD7, "SET 2,A", SET, 2, A, 8 ) \
+	GB_OPCODE( 0xD8, "SET 3,B", SET, 3, B, 8 ) \
+	GB_OPCODE( 0xD9, "SET 3,C", SET, 3, C, 8 ) \
+	GB_OPCODE( 0xDA, "SET 3,D", SET, 3, D, 8 ) \
+	GB_OPCODE( 0xDB, "SET 3,E", SET, 3, E, 8 ) \
+	GB_OPCODE( 0xDC, "SET 3,H", SET, 3, H, 8 ) \
+	GB_OPCODE( 0xDD, "SET 3,L", SET, 3, L, 8 ) \
+	GB_OPCODE( 0xDE, "SET 3,(HL)", SET, 3, HLI, 16 ) \
+	GB_OPCODE( 0xDF, "SET 3,A", SET, 3, A, 8 ) \
+	GB_OPCODE( 0xE0, "SET 4,B", SET, 4, B, 8 ) \
+	GB_OPCODE( 0xE1, "SET 4,C", SET, 4, C, 8 ) \
+	GB_OPCODE( 0xE2, "SET 4,D", SET, 4, D, 8 ) \
+	GB_OPCODE( 0xE3, "SET 4,E", SET, 4, E, 8 ) \
+	GB_OPCODE( 0xE4, "SET 4,H", SET, 4, H, 8 ) \
+	GB_OPCODE( 0xE5, "SET 4,L", SET, 4, L, 8 ) \
+	GB_OPCODE( 0xE6, "SET 4,(HL)", SET, 4, HLI, 16 ) \
+	GB_OPCODE( 0xE7, "SET 4,A", SET, 4, A, 8 ) \
+	GB_OPCODE( 0xE8, "SET 5,B", SET, 5, B, 8 ) \
+	GB_OPCODE( 0xE9, "SET 5,C", SET, 5, C, 8 ) \
+	GB_OPCODE( 0xEA, "SET 5,D", SET, 5, D, 8 ) \
+	GB_OPCODE( 0xEB, "SET 5,E", SET, 5, E, 8 ) \
+	GB_OPCODE( 0xEC, "SET 5,H", SET, 5, H, 8 ) \
+	GB_OPCODE( 0xED, "SET 5,L", SET, 5, L, 8 ) \
+	GB_OPCODE( 0xEE, "SET 5,(HL)", SET, 5, HLI, 16 ) \
+	GB_OPCODE( 0xEF, "SET 5,A", SET, 5, A, 8 ) \
+	GB_OPCODE( 0xF0, "SET 6,B", SET, 6, B, 8 ) \
+	GB_OPCODE( 0xF1, "SET 6,C", SET, 6, C, 8 ) \
+	GB_OPCODE( 0xF2, "SET 6,D", SET, 6, D, 8 ) \
+	GB_OPCODE( 0xF3, "SET 6,E", SET, 6, E, 8 ) \
+	GB_OPCODE( 0xF4, "SET 6,H", SET, 6, H, 8 ) \
+	GB_OPCODE( 0xF5, "SET 6,L", SET, 6, L, 8 ) \
+	GB_OPCODE( 0xF6, "SET 6,(HL)", SET, 6, HLI, 16 ) \
+	GB_OPCODE( 0xF7, "SET 6,A", SET, 6, A, 8 ) \
+	GB_OPCODE( 0xF8, "SET 7,B", SET, 7, B, 8 ) \
+	GB_OPCODE( 0xF9, "SET 7,C", SET, 7, C, 8 ) \
+	GB_OPCODE( 0xFA, "SET 7,D", SET, 7, D, 8 ) \
+	GB_OPCODE( 0xFB, "SET 7,E", SET, 7, E, 8 ) \
+	GB_OPCODE( 0xFC, "SET 7,H", SET, 7, H, 8 ) \
+	GB_OPCODE( 0xFD, "SET 7,L", SET, 7, L, 8 ) \
+	GB_OPCODE( 0xFE, "SET 7,(HL)", SET, 7, HLI, 16 ) \
+	GB_OPCODE( 0xFF, "SET 7,A", SET, 7, A, 8 )
+
+/*	Operations	*/
+//Defines SM83 operations, as named by the opcode table
+enum GB_Operation {
+	GB_OP_ADC, GB_OP_ADD, GB_OP_ADD_HL, GB_OP_ADD_SP_E, GB_OP_AND, GB_OP_BIT, GB_OP_CALL, GB_OP_CALL_CC, GB_OP_CCF, GB_OP_CP,
+	GB_OP_CPL, GB_OP_DAA, GB_OP_DEC16, GB_OP_DEC8, GB_OP_DI, GB_OP_EI, GB_OP_HALT, GB_OP_ILLEGAL, GB_OP_INC16, GB_OP_INC8,
+	GB_OP_JP, GB_OP_JP_CC, GB_OP_JP_HL, GB_OP_JR, GB_OP_JR_CC, GB_OP_LD16_IMM, GB_OP_LD8, GB_OP_LD_A16_A, GB_OP_LD_A16_SP, GB_OP_LD_A_A16,
+	GB_OP_LD_HL_SP_E, GB_OP_LD_SP_HL, GB_OP_NOP, GB_OP_OR, GB_OP_POP, GB_OP_PREFIX_CB, GB_OP_PUSH, GB_OP_RES, GB_OP_RET, GB_OP_RETI,
+	GB_OP_RET_CC, GB_OP_RL, GB_OP_RLA, GB_OP_RLC, GB_OP_RLCA, GB_OP_RR, GB_OP_RRA, GB_OP_RRC, GB_OP_RRCA, GB_OP_RST,
+	GB_OP_SBC, GB_OP_SCF, GB_OP_SET, GB_OP_SLA, GB_OP_SRA, GB_OP_SRL, GB_OP_STOP, GB_OP_SUB, GB_OP_SWAP, GB_OP_XOR
+};
+
+//Extra T-States spent by a conditional operation when its condition holds, beyond the cycles listed by the opcode table
+#define GB_TAKEN_CYCLES( operation ) ( ( operation ) == GB_OP_JR_CC || ( operation ) == GB_OP_JP_CC ? 4 : ( operation ) == GB_OP_CALL_CC || ( operation ) == GB_OP_RET_CC ? 12 : 0 )
+
+#define GB_OPCODE( code, mnemonic, operation, operand1, operand2, cycles ) [code] = GB_OP_##operation,
+static const uint8_t GB_BASE_OPERATIONS[0x100] = { GB_BASE_OPCODES }; //Operation of each base opcode, as a GB_Operation
+#undef GB_OPCODE
+
+/*	Instruction lengths	*/
+//Number of immediate bytes each operand adds to an instruction's encoding
+#define GB_IMMEDIATE_SIZE_NONE 0
+#define GB_IMMEDIATE_SIZE_A 0
+#define GB_IMMEDIATE_SIZE_B 0
+#define GB_IMMEDIATE_SIZE_C 0 //Register C, or condition C
+#define GB_IMMEDIATE_SIZE_D 0
+#define GB_IMMEDIATE_SIZE_E 0
+#define GB_IMMEDIATE_SIZE_H 0
+#define GB_IMMEDIATE_SIZE_L 0
+#define GB_IMMEDIATE_SIZE_BC 0
+#define GB_IMMEDIATE_SIZE_DE 0
+#define GB_IMMEDIATE_SIZE_HL 0
+#define GB_IMMEDIATE_SIZE_SP 0
+#define GB_IMMEDIATE_SIZE_AF 0
+#define GB_IMMEDIATE_SIZE_HLI 0
+#define GB_IMMEDIATE_SIZE_HLIP 0
+#define GB_IMMEDIATE_SIZE_HLIM 0
+#define GB_IMMEDIATE_SIZE_BCI 0
+#define GB_IMMEDIATE_SIZE_DEI 0
+#define GB_IMMEDIATE_SIZE_CI 0
+#define GB_IMMEDIATE_SIZE_NZ 0
+#define GB_IMMEDIATE_SIZE_Z 0
+#define GB_IMMEDIATE_SIZE_NC 0
+#define GB_IMMEDIATE_SIZE_A8I 1
+#define GB_IMMEDIATE_SIZE_D8 1
+#define GB_IMMEDIATE_SIZE_R8 1
+#define GB_IMMEDIATE_SIZE_CB 1
+#define GB_IMMEDIATE_SIZE_D16 2
+#define GB_IMMEDIATE_SIZE_A16 2
+#define GB_IMMEDIATE_SIZE_0x00 0 //RST vectors
+#define GB_IMMEDIATE_SIZE_0x08 0
+#define GB_IMMEDIATE_SIZE_0x10 0
+#define GB_IMMEDIATE_SIZE_0x18 0
+#define GB_IMMEDIATE_SIZE_0x20 0
+#define GB_IMMEDIATE_SIZE_0x28 0
+#define GB_IMMEDIATE_SIZE_0x30 0
+#define GB_IMMEDIATE_SIZE_0x38 0
+
+//Length in bytes of each base instruction, including its opcode and immediate operands. All 0xCB-prefixed instructions are 2 bytes long.
+#define GB_OPCODE( code, mnemonic, operation, operand1, operand2, cycles ) [code] = 1 + GB_IMMEDIATE_SIZE_##operand1 + GB_IMMEDIATE_SIZE_##operand2,
+static const uint8_t GB_OPCODE_LENGTHS[0x100] = { GB_BASE_OPCODES };
+#undef GB_OPCODE
+
+//Computed-goto dispatch is used when supported by the compiler. Otherwise, instructions are dispatched through a switch.
+#if defined( __GNUC__ ) || defined( __clang__ )
+#define GB_USE_COMPUTED_GOTO 1
+#else
+#define GB_USE_COMPUTED_GOTO 0
+#endif
+
+/*	Flags	*/
+#define FLAG_Z 0x80 //Zero flag of F register
+#define FLAG_N 0x40 //Subtraction flag of F register
+#define FLAG_H 0x20 //Half carry flag of F register
+#define FLAG_C 0x10 //Carry flag of F register
+
+/*	Conditions	*/
+#define COND_NZ() ( !( gb->cpu.f & FLAG_Z ) )
+#define COND_Z() ( gb->cpu.f & FLAG_Z )
+#define COND_NC() ( !( gb->cpu.f & FLAG_C ) )
+#define COND_C() ( gb->cpu.f & FLAG_C )
+
+/*	8-bit operands	*/
+#define GET8_A() ( gb->cpu.a )
+#define GET8_B() ( gb->cpu.b )
+#define GET8_C() ( gb->cpu.c )
+#define GET8_D() ( gb->cpu.d )
+#define GET8_E() ( gb->cpu.e )
+#define GET8_H() ( gb->cpu.h )
+#define GET8_L() ( gb->cpu.l )
+#define GET8_HLI() GB_READ( gb->cpu.hl )
+#define GET8_HLIP() GB_READ( gb->cpu.hl++ )
+#define GET8_HLIM() GB_READ( gb->cpu.hl-- )
+#define GET8_BCI() GB_READ( gb->cpu.bc )
+#define GET8_DEI() GB_READ( gb->cpu.de )
+#define GET8_CI() GB_READ( 0xFF00 | gb->cpu.c )
+#define GET8_A8I() GB_READ( 0xFF00 | FETCH8() )
+#define GET8_D8() FETCH8()
+
+#define SET8_A( value ) ( gb->cpu.a = ( value ) )
+#define SET8_B( value ) ( gb->cpu.b = ( value ) )
+#define SET8_C( value ) ( gb->cpu.c = ( value ) )
+#define SET8_D( value ) ( gb->cpu.d = ( value ) )
+#define SET8_E( value ) ( gb->cpu.e = ( value ) )
+#define SET8_H( value ) ( gb->cpu.h = ( value ) )
+#define SET8_L( value ) ( gb->cpu.l = ( value ) )
+#define SET8_HLI( value ) GB_WRITE( gb->cpu.hl, ( value ) )
+#define SET8_HLIP( value ) GB_WRITE( gb->cpu.hl++, ( value ) )
+#define SET8_HLIM( value ) GB_WRITE( gb->cpu.hl--, ( value ) )
+#define SET8_BCI( value ) GB_WRITE( gb->cpu.bc, ( value ) )
+#define SET8_DEI( value ) GB_WRITE( gb->cpu.de, ( value ) )
+#define SET8_CI( value ) GB_WRITE( 0xFF00 | gb->cpu.c, ( value ) )
+#define SET8_A8I( value ) do { uint16_t addr8_ = 0xFF00 | FETCH8(); GB_WRITE( addr8_, ( value ) ); } while ( 0 )
+
+/*	16-bit operands	*/
+#define GET16_BC() ( gb->cpu.bc )
+#define GET16_DE() ( gb->cpu.de )
+#define GET16_HL() ( gb->cpu.hl )
+#define GET16_SP() ( gb->cpu.sp )
+#define GET16_AF() ( gb->cpu.af )
+
+#define SET16_BC( value ) ( gb->cpu.bc = ( value ) )
+#define SET16_DE( value ) ( gb->cpu.de = ( value ) )
+#define SET16_HL( value ) ( gb->cpu.hl = ( value ) )
+#define SET16_SP( value ) ( gb->cpu.sp = ( value ) )
+#define SET16_AF( value ) ( gb->cpu.af = ( value ) & 0xFFF0 ) //Lower 4 bits of F are always 0
+
+/*	Multi-byte helpers	*/
+#define FETCH16_INTO( var ) do { var = FETCH8(); var |= (uint16_t)FETCH8() << 8; } while ( 0 )
+#define PUSH16( value ) do { uint16_t push_ = ( value ); GB_WRITE( --gb->cpu.sp, push_ >> 8 ); GB_WRITE( --gb->cpu.sp, push_ & 0xFF ); } while ( 0 )
+#define POP16_INTO( var ) do { var = GB_READ( gb->cpu.sp++ ); var |= (uint16_t)GB_READ( gb->cpu.sp++ ) << 8; } while ( 0 )
+
+/* Adds the given value and carry to register A, setting flags. */
+static inline void GB_ALU_Add( struct GB_Processor *cpu, uint8_t value, uint8_t carry ) {
+	unsigned result = cpu->a + value + carry; //Full result, including carry out
+
+	cpu->f = ( (uint8_t)result ? 0 : FLAG_Z )
+		| ( ( cpu->a & 0x0F ) + ( value & 0x0F ) + carry > 0x0F ? FLAG_H : 0 )
+		| ( result > 0xFF ? FLAG_C : 0 );
+	cpu->a = (uint8_t)result;
+}//end function GB_ALU_Add
+
+/* Subtracts the given value and carry from register A, setting flags. Result is discarded if not stored, as for CP. */
+static inline void GB_ALU_Sub( struct GB_Processor *cpu, uint8_t value, uint8_t carry, bool isStored ) {
+	int result = cpu->a - value - carry; //Full result, negative on borrow
+
+	cpu->f = FLAG_N
+		| ( (uint8_t)result ? 0 : FLAG_Z )
+		| ( ( cpu->a & 0x0F ) - ( value & 0x0F ) - carry < 0 ? FLAG_H : 0 )
+		| ( result < 0 ? FLAG_C : 0 );
+	if ( isStored ) cpu->a = (uint8_t)result;
+}//end function GB_ALU_Sub
+
+/* Decimal-adjusts register A after a BCD addition or subtraction, setting flags. */
+static inline void GB_ALU_DAA( struct GB_Processor *cpu ) {
+	uint8_t correction = 0; //Value added to or subtracted from A
+	bool isCarry = false; //Whether the adjustment carries out of the upper digit
+
+	if ( ( cpu->f & FLAG_H ) || ( !( cpu->f & FLAG_N ) && ( cpu->a & 0x0F ) > 0x09 ) ) correction |= 0x06;
+	if ( ( cpu->f & FLAG_C ) || ( !( cpu->f & FLAG_N ) && cpu->a > 0x99 ) ) {
+		correction |= 0x60;
+		isCarry = true;
+	}//end if
+
+	cpu->a = ( cpu->f & FLAG_N ) ? cpu->a - correction : cpu->a + correction;
+	cpu->f = ( cpu->f & FLAG_N ) | ( cpu->a ? 0 : FLAG_Z ) | ( isCarry ? FLAG_C : 0 );
+}//end function GB_ALU_DAA
+
+/* Adds a signed 8-bit offset to SP and returns the result, setting flags from the unsigned low-byte addition. */
+static inline uint16_t GB_ALU_Add_SP( struct GB_Processor *cpu, uint8_t offset ) {
+	cpu->f = ( ( cpu->sp & 0x0F ) + ( offset & 0x0F ) > 0x0F ? FLAG_H : 0 )
+		| ( ( cpu->sp & 0xFF ) + offset > 0xFF ? FLAG_C : 0 );
+
+	return cpu->sp + (int8_t)offset;
+}//end function GB_ALU_Add_SP
+
+/* Rotates/shifts the given value as selected by a 0xCB-prefixed rotate/shift opcode's upper bits, setting flags. Returns the result. */
+static inline uint8_t GB_ALU_Shift( struct GB_Processor *cpu, uint8_t op, uint8_t value ) {
+	uint8_t result; //Rotated or shifted value
+	uint8_t carry; //Bit shifted out
+
+	switch ( op ) {
+	case 0: //RLC
+		result = (uint8_t)( value << 1 | value >> 7 );
+		carry = value >> 7;
+		break;
+	case 1: //RRC
+		result = (uint8_t)( value >> 1 | value << 7 );
+		carry = value & 0x01;
+		break;
+	case 2: //RL
+		result = (uint8_t)( value << 1 | ( ( cpu->f & FLAG_C ) ? 1 : 0 ) );
+		carry = value >> 7;
+		break;
+	case 3: //RR
+		result = (uint8_t)( value >> 1 | ( ( cpu->f & FLAG_C ) ? 0x80 : 0 ) );
+		carry = value & 0x01;
+		break;
+	case 4: //SLA
+		result = (uint8_t)( value << 1 );
+		carry = value >> 7;
+		break;
+	case 5: //SRA
+		result = (uint8_t)( ( value >> 1 ) | ( value & 0x80 ) );
+		carry = value & 0x01;
+		break;
+	case 6: //SWAP
+		result = (uint8_t)( value << 4 | value >> 4 );
+		carry = 0;
+		break;
+	default: //SRL
+		result = value >> 1;
+		carry = value & 0x01;
+		break;
+	}//end switch
+
+	cpu->f = ( result ? 0 : FLAG_Z ) | ( carry ? FLAG_C : 0 );
+
+	return result;
+}//end function GB_ALU_Shift
+
+/*	Base operations	*/
+#define OP_NOP( o1, o2 )
+#define OP_LD8( dst, src ) SET8_##dst( GET8_##src() );
+#define OP_LD16_IMM( rr, o2 ) { uint16_t imm_; FETCH16_INTO( imm_ ); SET16_##rr( imm_ ); }
+#define OP_LD_A16_SP( o1, o2 ) { uint16_t addr_; FETCH16_INTO( addr_ ); GB_WRITE( addr_, gb->cpu.sp & 0xFF ); GB_WRITE( (uint16_t)( addr_ + 1 ), gb->cpu.sp >> 8 ); }
+#define OP_LD_A16_A( o1, o2 ) { uint16_t addr_; FETCH16_INTO( addr_ ); GB_WRITE( addr_, gb->cpu.a ); }
+#define OP_LD_A_A16( o1, o2 ) { uint16_t addr_; FETCH16_INTO( addr_ ); gb->cpu.a = GB_READ( addr_ ); }
+#define OP_LD_SP_HL( o1, o2 ) { gb->cpu.sp = gb->cpu.hl; TICK( 4 ); }
+#define OP_LD_HL_SP_E( o1, o2 ) { uint8_t offset_ = FETCH8(); gb->cpu.hl = GB_ALU_Add_SP( &( gb->cpu ), offset_ ); TICK( 4 ); }
+#define OP_ADD_SP_E( o1, o2 ) { uint8_t offset_ = FETCH8(); gb->cpu.sp = GB_ALU_Add_SP( &( gb->cpu ), offset_ ); TICK( 8 ); }
+
+#define OP_INC16( rr, o2 ) { SET16_##rr( (uint16_t)( GET16_##rr() + 1 ) ); TICK( 4 ); }
+#define OP_DEC16( rr, o2 ) { SET16_##rr( (uint16_t)( GET16_##rr() - 1 ) ); TICK( 4 ); }
+#define OP_ADD_HL( rr, o2 ) { \
+	uint16_t value_ = GET16_##rr(); \
+	gb->cpu.f = ( gb->cpu.f & FLAG_Z ) | ( ( gb->cpu.hl & 0x0FFF ) + ( value_ & 0x0FFF ) > 0x0FFF ? FLAG_H : 0 ) | ( gb->cpu.hl + value_ > 0xFFFF ? FLAG_C : 0 ); \
+	gb->cpu.hl += value_; \
+	TICK( 4 ); \
+}
+#define OP_INC8( r, o2 ) { \
+	uint8_t value_ = GET8_##r(); \
+	gb->cpu.f = ( gb->cpu.f & FLAG_C ) | ( (uint8_t)( value_ + 1 ) ? 0 : FLAG_Z ) | ( ( value_ & 0x0F ) == 0x0F ? FLAG_H : 0 ); \
+	SET8_##r( (uint8_t)( value_ + 1 ) ); \
+}
+#define OP_DEC8( r, o2 ) { \
+	uint8_t value_ = GET8_##r(); \
+	gb->cpu.f = ( gb->cpu.f & FLAG_C ) | FLAG_N | ( (uint8_t)( value_ - 1 ) ? 0 : FLAG_Z ) | ( ( value_ & 0x0F ) == 0x00 ? FLAG_H : 0 ); \
+	SET8_##r( (uint8_t)( value_ - 1 ) ); \
+}
+
+#define OP_ADD( src, o2 ) GB_ALU_Add( &( gb->cpu ), GET8_##src(), 0 );
+#define OP_ADC( src, o2 ) { uint8_t value_ = GET8_##src(); GB_ALU_Add( &( gb->cpu ), value_, ( gb->cpu.f & FLAG_C ) ? 1 : 0 ); }
+#define OP_SUB( src, o2 ) GB_ALU_Sub( &( gb->cpu ), GET8_##src(), 0, true );
+#define OP_SBC( src, o2 ) { uint8_t value_ = GET8_##src(); GB_ALU_Sub( &( gb->cpu ), value_, ( gb->cpu.f & FLAG_C ) ? 1 : 0, true ); }
+#define OP_AND( src, o2 ) { gb->cpu.a &= GET8_##src(); gb->cpu.f = ( gb->cpu.a ? 0 : FLAG_Z ) | FLAG_H; }
+#define OP_XOR( src, o2 ) { gb->cpu.a ^= GET8_##src(); gb->cpu.f = gb->cpu.a ? 0 : FLAG_Z; }
+#define OP_OR( src, o2 ) { gb->cpu.a |= GET8_##src(); gb->cpu.f = gb->cpu.a ? 0 : FLAG_Z; }
+#define OP_CP( src, o2 ) GB_ALU_Sub( &( gb->cpu ), GET8_##src(), 0, false );
+
+#define OP_RLCA( o1, o2 ) { gb->cpu.a = GB_ALU_Shift( &( gb->cpu ), 0, gb->cpu.a ); gb->cpu.f &= FLAG_C; }
+#define OP_RRCA( o1, o2 ) { gb->cpu.a = GB_ALU_Shift( &( gb->cpu ), 1, gb->cpu.a ); gb->cpu.f &= FLAG_C; }
+#define OP_RLA( o1, o2 ) { gb->cpu.a = GB_ALU_Shift( &( gb->cpu ), 2, gb->cpu.a ); gb->cpu.f &= FLAG_C; }
+#define OP_RRA( o1, o2 ) { gb->cpu.a = GB_ALU_Shift( &( gb->cpu ), 3, gb->cpu.a ); gb->cpu.f &= FLAG_C; }
+#define OP_DAA( o1, o2 ) GB_ALU_DAA( &( gb->cpu ) );
+#define OP_CPL( o1, o2 ) { gb->cpu.a = ~gb->cpu.a; gb->cpu.f |= FLAG_N | FLAG_H; }
+#define OP_SCF( o1, o2 ) { gb->cpu.f = ( gb->cpu.f & FLAG_Z ) | FLAG_C; }
+#define OP_CCF( o1, o2 ) { gb->cpu.f = ( gb->cpu.f & FLAG_Z ) | ( ( gb->cpu.f & FLAG_C ) ^ FLAG_C ); }
+
+#define OP_JR( o1, o2 ) { int8_t offset_ = (int8_t)FETCH8(); gb->cpu.pc += offset_; TICK( 4 ); }
+#define OP_JR_CC( cc, o2 ) { int8_t offset_ = (int8_t)FETCH8(); if ( COND_##cc() ) { gb->cpu.pc += offset_; TICK( 4 ); } }
+#define OP_JP( o1, o2 ) { uint16_t addr_; FETCH16_INTO( addr_ ); gb->cpu.pc = addr_; TICK( 4 ); }
+#define OP_JP_CC( cc, o2 ) { uint16_t addr_; FETCH16_INTO( addr_ ); if ( COND_##cc() ) { gb->cpu.pc = addr_; TICK( 4 ); } }
+#define OP_JP_HL( o1, o2 ) gb->cpu.pc = gb->cpu.hl;
+#define OP_CALL( o1, o2 ) { uint16_t addr_; FETCH16_INTO( addr_ ); TICK( 4 ); PUSH16( gb->cpu.pc ); gb->cpu.pc = addr_; }
+#define OP_CALL_CC( cc, o2 ) { uint16_t addr_; FETCH16_INTO( addr_ ); if ( COND_##cc() ) { TICK( 4 ); PUSH16( gb->cpu.pc ); gb->cpu.pc = addr_; } }
+#define OP_RET( o1, o2 ) { POP16_INTO( gb->cpu.pc ); TICK( 4 ); }
+#define OP_RET_CC( cc, o2 ) { TICK( 4 ); if ( COND_##cc() ) { POP16_INTO( gb->cpu.pc ); TICK( 4 ); } }
+#define OP_RETI( o1, o2 ) { POP16_INTO( gb->cpu.pc ); TICK( 4 ); gb->cpu.ime = 1; }
+#define OP_RST( vector, o2 ) { TICK( 4 ); PUSH16( gb->cpu.pc ); gb->cpu.pc = ( vector ); }
+#define OP_PUSH( rr, o2 ) { TICK( 4 ); PUSH16( GET16_##rr() ); }
+#define OP_POP( rr, o2 ) { uint16_t value_; POP16_INTO( value_ ); SET16_##rr( value_ ); }
+
+#define OP_DI( o1, o2 ) { gb->cpu.ime = 0; gb->cpu.isIMEPending = false; }
+#define OP_EI( o1, o2 ) gb->cpu.isIMEPending = true;
+#define OP_HALT( o1, o2 ) GB_Halt( gb );
+#define OP_STOP( o1, o2 ) FETCH8();
+
+/*	0xCB-prefixed operations	*/
+#define OP_RLC( r, o2 ) { uint8_t value_ = GET8_##r(); SET8_##r( GB_ALU_Shift( &( gb->cpu ), 0, value_ ) ); }
+#define OP_RRC( r, o2 ) { uint8_t value_ = GET8_##r(); SET8_##r( GB_ALU_Shift( &( gb->cpu ), 1, value_ ) ); }
+#define OP_RL( r, o2 ) { uint8_t value_ = GET8_##r(); SET8_##r( GB_ALU_Shift( &( gb->cpu ), 2, value_ ) ); }
+#define OP_RR( r, o2 ) { uint8_t value_ = GET8_##r(); SET8_##r( GB_ALU_Shift( &( gb->cpu ), 3, value_ ) ); }
+#define OP_SLA( r, o2 ) { uint8_t value_ = GET8_##r(); SET8_##r( GB_ALU_Shift( &( gb->cpu ), 4, value_ ) ); }
+#define OP_SRA( r, o2 ) { uint8_t value_ = GET8_##r(); SET8_##r( GB_ALU_Shift( &( gb->cpu ), 5, value_ ) ); }
+#define OP_SWAP( r, o2 ) { uint8_t value_ = GET8_##r(); SET8_##r( GB_ALU_Shift( &( gb->cpu ), 6, value_ ) ); }
+#define OP_SRL( r, o2 ) { uint8_t value_ = GET8_##r(); SET8_##r( GB_ALU_Shift( &( gb->cpu ), 7, value_ ) ); }
+#define OP_BIT( bit, r ) { uint8_t value_ = GET8_##r(); gb->cpu.f = ( gb->cpu.f & FLAG_C ) | FLAG_H | ( ( value_ & ( 1 << ( bit ) ) ) ? 0 : FLAG_Z ); }
+#define OP_RES( bit, r ) { uint8_t value_ = GET8_##r(); SET8_##r( (uint8_t)( value_ & ~( 1 << ( bit ) ) ) ); }
+#define OP_SET( bit, r ) { uint8_t value_ = GET8_##r(); SET8_##r( (uint8_t)( value_ | ( 1 << ( bit ) ) ) ); }
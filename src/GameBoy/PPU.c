@@ -0,0 +1,511 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "GameBoy.h"
+
+/*	Scanline rendering into the LCD. Each visible scanline is rendered in one of two ways:
+*		Fast path: The whole line is rendered in one pass at the end of Mode 3, decoding tile rows with SIMD where available.
+*		Pixel FIFO: Pixels are pushed to the LCD one at a time, as if one per dot, so mid-line register writes take effect at the right pixel.
+*	A line switches to the Pixel FIFO upon its first write to a register affecting rendering during Mode 3, or always if doRenderPerDot is set.
+*	Both paths produce identical output for a line with no such writes. LCD pixels are stored as shades 0 (white) ~ 3 (black).
+*
+*	Fast-path lines are rendered lazily. The end of Mode 3 only records that a line is complete, and completed lines are rendered in one batch
+*	when the CPU next writes state they depend on (VRAM, OAM, or a register affecting rendering), or upon VBlank.
+*	Until then, nothing they depend on can have changed.
+*	Rendering has no effect on emulated timing, so lines of suppressed frames are not rendered at all.
+*
+*	The LCD is double-buffered. Lines are drawn into gb->lcd, which is swapped by pointer with gb->frame upon VBlank,
+*	so gb->frame always holds the last complete frame for display.
+*/
+
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#define GB_PPU_VECTOR_TILES 4 //Number of tile rows decoded per vector operation
+#elif defined( __SSE2__ )
+#include <emmintrin.h>
+#define GB_PPU_VECTOR_TILES 2 //Number of tile rows decoded per vector operation
+#else
+#define GB_PPU_VECTOR_TILES 1 //Number of tile rows decoded per iteration
+#endif
+
+#define GB_FIFO_STARTUP_DOTS 12 //Number of Mode 3 dots before the Pixel FIFO pushes its first pixel
+_Static_assert( GB_LCD_PITCH >= GB_LCD_WIDTH && GB_LCD_PITCH % 32 == 0, "LCD rows must be wide enough and vector-aligned" );
+
+#define GB_LINE_TILES 24 //Number of tile rows decoded for one line of BG or window. 21 are needed, rounded up to a whole number of vectors.
+
+/*	Shared Helpers	*/
+
+/* Returns the VRAM offset of the given row of the given BG/window tile, according to the LCDC register's tile data area. */
+static uint16_t Get_Tile_Row_Address( uint8_t lcdc, uint8_t tile, unsigned row ) {
+	if ( lcdc & 0x10 ) return tile * 16 + row * 2; //0x8000 area, unsigned tile index
+	else return 0x1000 + (int8_t)tile * 16 + row * 2; //0x8800 area, signed tile index from 0x9000
+}//end function Get_Tile_Row_Address
+
+/* Reads the two bitplanes of the given column of the current BG or window line. Columns count from the leftmost visible tile. */
+static void Get_BG_Tile_Row( GameBoy *gb, bool isWindow, unsigned column, uint8_t *lo, uint8_t *hi ) {
+	uint8_t lcdc = gb->io[0x40]; //LCDC register
+	unsigned y; //Y-coordinate within the 256 x 256 tile map
+	uint16_t map; //VRAM offset of the tile map row
+	uint16_t addr; //VRAM offset of the tile row
+
+	if ( isWindow ) {
+		y = gb->cpu.ppu.windowLine;
+		map = ( ( lcdc & 0x40 ) ? 0x1C00 : 0x1800 ) + ( y >> 3 ) * 32 + ( column & 31 );
+	}//end if
+	else {
+		y = ( gb->io[0x42] + gb->cpu.ppu.line ) & 0xFF;
+		map = ( ( lcdc & 0x08 ) ? 0x1C00 : 0x1800 ) + ( y >> 3 ) * 32 + ( ( ( gb->io[0x43] >> 3 ) + column ) & 31 );
+	}//end if-else
+
+	addr = Get_Tile_Row_Address( lcdc, gb->vram[map], y & 7 );
+	*lo = gb->vram[addr];
+	*hi = gb->vram[addr + 1];
+
+	return;
+}//end function Get_BG_Tile_Row
+
+/* Reads the two bitplanes of the current line of the given sprite, mirrored if the sprite is flipped horizontally. */
+static void Get_Sprite_Tile_Row( GameBoy *gb, const uint8_t *sprite, uint8_t *lo, uint8_t *hi ) {
+	unsigned height = ( gb->io[0x40] & 0x04 ) ? 16 : 8; //Sprite height in pixels
+	unsigned row = ( gb->cpu.ppu.line + 16 - sprite[0] ) & ( height - 1 ); //Row of sprite on line being rendered
+	uint8_t tile = height == 16 ? sprite[2] & 0xFE : sprite[2]; //Tile index of sprite's top tile
+	uint16_t addr; //VRAM offset of tile row
+
+	if ( sprite[3] & 0x40 ) row = height - 1 - row;
+	addr = tile * 16 + row * 2;
+	*lo = gb->vram[addr];
+	*hi = gb->vram[addr + 1];
+
+	//Mirror bits for horizontal flip
+	if ( sprite[3] & 0x20 ) {
+		for ( int i = 0; i < 2; ++i ) {
+			uint8_t *plane = i ? hi : lo; //Bitplane being mirrored
+
+			*plane = ( *plane & 0xF0 ) >> 4 | ( *plane & 0x0F ) << 4;
+			*plane = ( *plane & 0xCC ) >> 2 | ( *plane & 0x33 ) << 2;
+			*plane = ( *plane & 0xAA ) >> 1 | ( *plane & 0x55 ) << 1;
+		}//end for
+	}//end if
+
+	return;
+}//end function Get_Sprite_Tile_Row
+
+/* Decodes one interleaved 2bpp tile row into 8 color indices, leftmost pixel first. */
+static void Decode_Tile_Row( uint8_t lo, uint8_t hi, uint8_t *out ) {
+	for ( int i = 0; i < 8; ++i )
+		out[i] = ( ( lo >> ( 7 - i ) ) & 1 ) | ( ( ( hi >> ( 7 - i ) ) & 1 ) << 1 );
+
+	return;
+}//end function Decode_Tile_Row
+
+/* Returns whether the window is drawn on the line being rendered, once the line reaches WX. */
+static bool Is_Window_Line( GameBoy *gb ) {
+	return gb->cpu.ppu.isWindowYTriggered && ( gb->io[0x40] & 0x20 ) && gb->io[0x4B] <= 166;
+}//end function Is_Window_Line
+
+/*	Prepares to render the given line. Updates the window's per-frame state, then finds the first 10 sprites in OAM on the line, as during Mode 2,
+*	and sorts them into drawing priority: lower X first, then lower OAM index.
+*/
+static void Prepare_Line( GameBoy *gb, uint8_t line ) {
+	struct GB_PictureProcessor *ppu = &( gb->cpu.ppu ); //Picture Processing Unit
+	unsigned height = ( gb->io[0x40] & 0x04 ) ? 16 : 8; //Sprite height in pixels
+
+	ppu->line = line;
+
+	//The window line counter and WY trigger reset each frame
+	if ( line == 0 ) {
+		ppu->windowLine = 0;
+		ppu->isWindowYTriggered = false;
+	}//end if
+	if ( line == gb->io[0x4A] ) ppu->isWindowYTriggered = true;
+
+	//OAM scan, with insertion sort by X
+	ppu->oamScanCount = 0;
+	for ( uint8_t i = 0; i < 40 && ppu->oamScanCount < 10; ++i ) {
+		unsigned top = ppu->oam[4 * i]; //Sprite Y-coordinate plus 16
+		int j = ppu->oamScanCount; //Sorted position of sprite
+
+		if ( line + 16u < top || line + 16u >= top + height ) continue;
+
+		while ( j > 0 && ppu->oam[4 * ppu->oamScanResults[j - 1] + 1] > ppu->oam[4 * i + 1] ) {
+			ppu->oamScanResults[j] = ppu->oamScanResults[j - 1];
+			--j;
+		}//end while
+		ppu->oamScanResults[j] = i;
+		ppu->oamScanCount += 1;
+	}//end for
+
+	return;
+}//end function Prepare_Line
+
+/*	Fast Path	*/
+
+/*	Decodes the given number of interleaved 2bpp tile rows into 8 color indices each. The count must be a multiple of GB_PPU_VECTOR_TILES.
+*	Each bitplane byte is broadcast across 8 lanes and tested against one bit per lane, so a vector of tile rows is decoded at once.
+*/
+static void Decode_Tile_Rows( const uint8_t *lo, const uint8_t *hi, unsigned count, uint8_t *out ) {
+#if defined( __AVX2__ )
+	const __m256i bits = _mm256_set1_epi64x( 0x0102040810204080LL ); //Bit tested by each lane, leftmost pixel in lowest lane
+	const __m256i one = _mm256_set1_epi8( 1 );
+	const __m256i two = _mm256_set1_epi8( 2 );
+	const uint64_t broadcast = 0x0101010101010101ULL; //Multiplier copying a byte into all 8 bytes
+
+	for ( unsigned t = 0; t < count; t += 4 ) {
+		__m256i l = _mm256_set_epi64x( lo[t + 3] * broadcast, lo[t + 2] * broadcast, lo[t + 1] * broadcast, lo[t] * broadcast ); //Low bitplanes
+		__m256i h = _mm256_set_epi64x( hi[t + 3] * broadcast, hi[t + 2] * broadcast, hi[t + 1] * broadcast, hi[t] * broadcast ); //High bitplanes
+
+		l = _mm256_and_si256( _mm256_cmpeq_epi8( _mm256_and_si256( l, bits ), bits ), one );
+		h = _mm256_and_si256( _mm256_cmpeq_epi8( _mm256_and_si256( h, bits ), bits ), two );
+		_mm256_storeu_si256( (__m256i *)( out + 8 * t ), _mm256_or_si256( l, h ) );
+	}//end for
+#elif defined( __SSE2__ )
+	const __m128i bits = _mm_set1_epi64x( 0x0102040810204080LL ); //Bit tested by each lane, leftmost pixel in lowest lane
+	const __m128i one = _mm_set1_epi8( 1 );
+	const __m128i two = _mm_set1_epi8( 2 );
+	const uint64_t broadcast = 0x0101010101010101ULL; //Multiplier copying a byte into all 8 bytes
+
+	for ( unsigned t = 0; t < count; t += 2 ) {
+		__m128i l = _mm_set_epi64x( lo[t + 1] * broadcast, lo[t] * broadcast ); //Low bitplanes
+		__m128i h = _mm_set_epi64x( hi[t + 1] * broadcast, hi[t] * broadcast ); //High bitplanes
+
+		l = _mm_and_si128( _mm_cmpeq_epi8( _mm_and_si128( l, bits ), bits ), one );
+		h = _mm_and_si128( _mm_cmpeq_epi8( _mm_and_si128( h, bits ), bits ), two );
+		_mm_storeu_si128( (__m128i *)( out + 8 * t ), _mm_or_si128( l, h ) );
+	}//end for
+#else
+	for ( unsigned t = 0; t < count; ++t )
+		Decode_Tile_Row( lo[t], hi[t], out + 8 * t );
+#endif
+
+	return;
+}//end function Decode_Tile_Rows
+
+/* Maps a full line of color indices through the given palette register into LCD shades. */
+static void Apply_Palette( const uint8_t *indices, uint8_t palette, uint8_t *out ) {
+#if defined( __AVX2__ )
+	for ( int x = 0; x < GB_LCD_WIDTH; x += 32 ) {
+		__m256i index = _mm256_loadu_si256( (const __m256i *)( indices + x ) ); //Color indices of 32 pixels
+		__m256i shade = _mm256_setzero_si256(); //Shades of 32 pixels
+
+		for ( int c = 0; c < 4; ++c )
+			shade = _mm256_or_si256( shade, _mm256_and_si256( _mm256_cmpeq_epi8( index, _mm256_set1_epi8( c ) ), _mm256_set1_epi8( ( palette >> ( 2 * c ) ) & 3 ) ) );
+		_mm256_storeu_si256( (__m256i *)( out + x ), shade );
+	}//end for
+#elif defined( __SSE2__ )
+	for ( int x = 0; x < GB_LCD_WIDTH; x += 16 ) {
+		__m128i index = _mm_loadu_si128( (const __m128i *)( indices + x ) ); //Color indices of 16 pixels
+		__m128i shade = _mm_setzero_si128(); //Shades of 16 pixels
+
+		for ( int c = 0; c < 4; ++c )
+			shade = _mm_or_si128( shade, _mm_and_si128( _mm_cmpeq_epi8( index, _mm_set1_epi8( c ) ), _mm_set1_epi8( ( palette >> ( 2 * c ) ) & 3 ) ) );
+		_mm_storeu_si128( (__m128i *)( out + x ), shade );
+	}//end for
+#else
+	for ( int x = 0; x < GB_LCD_WIDTH; ++x )
+		out[x] = ( palette >> ( 2 * indices[x] ) ) & 3;
+#endif
+
+	return;
+}//end function Apply_Palette
+
+/* Decodes the tile rows of the current BG or window line, from its leftmost visible column. */
+static void Decode_BG_Line( GameBoy *gb, bool isWindow, uint8_t *out ) {
+	_Alignas( 32 ) uint8_t lo[GB_LINE_TILES]; //Low bitplanes of each tile row
+	_Alignas( 32 ) uint8_t hi[GB_LINE_TILES]; //High bitplanes of each tile row
+
+	for ( unsigned t = 0; t < GB_LINE_TILES; ++t )
+		Get_BG_Tile_Row( gb, isWindow, t, &( lo[t] ), &( hi[t] ) );
+	Decode_Tile_Rows( lo, hi, GB_LINE_TILES, out );
+
+	return;
+}//end function Decode_BG_Line
+
+/*	Draws the current line's sprites over the given line of BG shades.
+*	Sprites were found and sorted into drawing priority by Prepare_Line. Each pixel is taken by the highest-priority opaque sprite,
+*	which is then hidden behind non-zero BG colors if its OBJ-to-BG Priority bit is set.
+*/
+static void Render_Sprites( GameBoy *gb, const uint8_t *bg, uint8_t *line ) {
+	struct GB_PictureProcessor *ppu = &( gb->cpu.ppu ); //Picture Processing Unit
+	uint8_t colors[GB_LCD_WIDTH] = { 0 }; //Color index of the sprite pixel taking each LCD pixel. 0 if none.
+	uint8_t attributes[GB_LCD_WIDTH]; //Attributes of the sprite taking each LCD pixel
+
+	for ( int i = 0; i < ppu->oamScanCount; ++i ) {
+		const uint8_t *sprite = &( ppu->oam[4 * ppu->oamScanResults[i]] ); //OAM entry of sprite
+		uint8_t pixels[8]; //Color indices of sprite's row
+		uint8_t lo, hi; //Bitplanes of sprite's row
+
+		Get_Sprite_Tile_Row( gb, sprite, &lo, &hi );
+		Decode_Tile_Row( lo, hi, pixels );
+
+		for ( int p = 0; p < 8; ++p ) {
+			int x = sprite[1] - 8 + p; //LCD X-coordinate of pixel
+
+			if ( x < 0 || x >= GB_LCD_WIDTH || colors[x] ) continue;
+			colors[x] = pixels[p];
+			attributes[x] = sprite[3];
+		}//end for
+	}//end for
+
+	for ( int x = 0; x < GB_LCD_WIDTH; ++x ) {
+		if ( !colors[x] || ( ( attributes[x] & 0x80 ) && bg[x] ) ) continue;
+		line[x] = ( gb->io[( attributes[x] & 0x10 ) ? 0x49 : 0x48] >> ( 2 * colors[x] ) ) & 3;
+	}//end for
+
+	return;
+}//end function Render_Sprites
+
+/* Renders the whole line being rendered into the LCD in one pass, from the current values of the PPU registers. */
+static void Render_Scanline( GameBoy *gb ) {
+	struct GB_PictureProcessor *ppu = &( gb->cpu.ppu ); //Picture Processing Unit
+	uint8_t lcdc = gb->io[0x40]; //LCDC register
+	uint8_t *line = gb->lcd + ppu->line * GB_LCD_PITCH; //LCD line being rendered
+	_Alignas( 32 ) uint8_t tiles[GB_LINE_TILES * 8]; //Color indices of decoded tile rows
+	_Alignas( 32 ) uint8_t bg[GB_LCD_WIDTH]; //Color indices of BG and window pixels
+
+	//Background
+	Decode_BG_Line( gb, false, tiles );
+	memcpy( bg, tiles + ( gb->io[0x43] & 7 ), GB_LCD_WIDTH );
+
+	//Window, from WX - 7 to the right edge
+	if ( Is_Window_Line( gb ) ) {
+		int windowX = gb->io[0x4B] - 7; //LCD X-coordinate of window's left edge. Negative if cut off.
+		int start = windowX < 0 ? 0 : windowX; //First LCD X-coordinate covered by window
+
+		Decode_BG_Line( gb, true, tiles );
+		memcpy( bg + start, tiles + ( start - windowX ), GB_LCD_WIDTH - start );
+		ppu->windowLine += 1;
+	}//end if
+
+	//BG and window blank to white when disabled, and never hide sprites
+	if ( lcdc & 0x01 ) Apply_Palette( bg, gb->io[0x47], line );
+	else {
+		memset( bg, 0, GB_LCD_WIDTH );
+		memset( line, 0, GB_LCD_WIDTH );
+	}//end if-else
+
+	if ( ( lcdc & 0x02 ) && ppu->oamScanCount ) Render_Sprites( gb, bg, line );
+
+	return;
+}//end function Render_Scanline
+
+/*	Pixel FIFO	*/
+
+/* Removes the first pixel from the given Pixel FIFO. */
+static struct GB_FIFOPixel Pop_FIFO( struct GB_FIFOPixel *fifo, uint8_t *tail ) {
+	struct GB_FIFOPixel pixel = fifo[0]; //The pixel removed
+
+	*tail -= 1;
+	memmove( fifo, fifo + 1, *tail * sizeof( struct GB_FIFOPixel ) );
+
+	return pixel;
+}//end function Pop_FIFO
+
+/* Fetches the next BG or window tile row into the BG Pixel FIFO. */
+static void Fetch_BG_Tile( GameBoy *gb ) {
+	struct GB_PictureProcessor *ppu = &( gb->cpu.ppu ); //Picture Processing Unit
+	uint8_t pixels[8]; //Color indices of fetched row
+	uint8_t lo, hi; //Bitplanes of fetched row
+
+	Get_BG_Tile_Row( gb, ppu->isFetchingWindow, ppu->fetcherX, &lo, &hi );
+	Decode_Tile_Row( lo, hi, pixels );
+	ppu->fetcherX += 1;
+
+	for ( int i = 0; i < 8; ++i )
+		ppu->bgFIFO[ppu->bgFIFOTail++] = (struct GB_FIFOPixel){ .colorIndex = pixels[i] };
+
+	return;
+}//end function Fetch_BG_Tile
+
+/* Fetches the current line of the given sprite, and mixes it into the transparent and empty slots of the sprite Pixel FIFO. */
+static void Fetch_Sprite( GameBoy *gb, const uint8_t *sprite ) {
+	struct GB_PictureProcessor *ppu = &( gb->cpu.ppu ); //Picture Processing Unit
+	uint8_t pixels[8]; //Color indices of fetched row
+	uint8_t lo, hi; //Bitplanes of fetched row
+	int skipped = ppu->lcdX - ( sprite[1] - 8 ); //Number of pixels left of the LCD's left edge
+
+	Get_Sprite_Tile_Row( gb, sprite, &lo, &hi );
+	Decode_Tile_Row( lo, hi, pixels );
+
+	for ( int i = 0; i + skipped < 8; ++i ) {
+		struct GB_FIFOPixel pixel = { pixels[i + skipped], ( sprite[3] >> 4 ) & 1, sprite[3] >> 7 }; //Sprite pixel
+
+		if ( i >= ppu->oamFIFOTail ) ppu->oamFIFO[ppu->oamFIFOTail++] = pixel;
+		else if ( !( ppu->oamFIFO[i].colorIndex ) ) ppu->oamFIFO[i] = pixel;
+	}//end for
+
+	return;
+}//end function Fetch_Sprite
+
+/* Starts rendering the current line through the Pixel FIFO. Completed lines must already be rendered. */
+static void Begin_FIFO_Line( GameBoy *gb ) {
+	struct GB_PictureProcessor *ppu = &( gb->cpu.ppu ); //Picture Processing Unit
+
+	Prepare_Line( gb, gb->io[0x44] );
+	ppu->isLineInFIFO = true;
+	ppu->lcdX = 0;
+	ppu->fetcherX = 0;
+	ppu->bgFIFOTail = 0;
+	ppu->oamFIFOTail = 0;
+	ppu->nextSprite = 0;
+	ppu->discardCount = gb->io[0x43] & 7;
+	ppu->isFetchingWindow = false;
+
+	return;
+}//end function Begin_FIFO_Line
+
+/* Runs the Pixel FIFO until it pushes its next pixel to the LCD. */
+static void Push_FIFO_Pixel( GameBoy *gb ) {
+	struct GB_PictureProcessor *ppu = &( gb->cpu.ppu ); //Picture Processing Unit
+	uint8_t lcdc = gb->io[0x40]; //LCDC register
+	struct GB_FIFOPixel bg; //BG or window pixel
+	struct GB_FIFOPixel obj = { 0 }; //Sprite pixel, if any
+	uint8_t bgIndex; //BG color index, or 0 if BG disabled
+	uint8_t shade; //Shade pushed to LCD
+
+	//Fill the BG FIFO, switching to the window upon reaching WX, and discard pixels scrolled off the left edge
+	for ( ;; ) {
+		if ( !( ppu->isFetchingWindow ) && Is_Window_Line( gb ) && ppu->lcdX + 7 >= gb->io[0x4B] ) {
+			ppu->isFetchingWindow = true;
+			ppu->fetcherX = 0;
+			ppu->bgFIFOTail = 0;
+			ppu->discardCount = gb->io[0x4B] < 7 ? 7 - gb->io[0x4B] : 0;
+		}//end if
+
+		if ( !( ppu->bgFIFOTail ) ) Fetch_BG_Tile( gb );
+
+		if ( !( ppu->discardCount ) ) break;
+		Pop_FIFO( ppu->bgFIFO, &( ppu->bgFIFOTail ) );
+		ppu->discardCount -= 1;
+	}//end for
+
+	//Fetch sprites starting at this pixel, in drawing priority
+	while ( ppu->nextSprite < ppu->oamScanCount ) {
+		const uint8_t *sprite = &( ppu->oam[4 * ppu->oamScanResults[ppu->nextSprite]] ); //OAM entry of next sprite
+
+		if ( sprite[1] - 8 > ppu->lcdX ) break;
+		if ( lcdc & 0x02 ) Fetch_Sprite( gb, sprite );
+		ppu->nextSprite += 1;
+	}//end while
+
+	//Mix BG and sprite pixels
+	bg = Pop_FIFO( ppu->bgFIFO, &( ppu->bgFIFOTail ) );
+	if ( ppu->oamFIFOTail ) obj = Pop_FIFO( ppu->oamFIFO, &( ppu->oamFIFOTail ) );
+
+	bgIndex = ( lcdc & 0x01 ) ? bg.colorIndex : 0;
+	shade = ( lcdc & 0x01 ) ? ( gb->io[0x47] >> ( 2 * bgIndex ) ) & 3 : 0;
+	if ( obj.colorIndex && !( obj.priority && bgIndex ) ) shade = ( gb->io[obj.palette ? 0x49 : 0x48] >> ( 2 * obj.colorIndex ) ) & 3;
+
+	gb->lcd[ppu->line * GB_LCD_PITCH + ppu->lcdX++] = shade;
+
+	return;
+}//end function Push_FIFO_Pixel
+
+/* Runs the Pixel FIFO until it has pushed the given number of pixels on the current line. */
+static void Run_FIFO( GameBoy *gb, unsigned pixels ) {
+	while ( gb->cpu.ppu.lcdX < pixels )
+		Push_FIFO_Pixel( gb );
+
+	return;
+}//end function Run_FIFO
+
+/*	Public Interface	*/
+
+/* Renders every line which has completed Mode 3 but not yet been rendered, in order. */
+void GB_PPU_Render_Pending( GameBoy *gb ) {
+	struct GB_PictureProcessor *ppu = &( gb->cpu.ppu ); //Picture Processing Unit
+
+	//Lines of frames which are never displayed are skipped
+	if ( gb->suppressedFrames ) {
+		ppu->renderedLines = ppu->completedLines;
+		return;
+	}//end if
+
+	while ( ppu->renderedLines < ppu->completedLines ) {
+		Prepare_Line( gb, ppu->renderedLines++ );
+		Render_Scanline( gb );
+	}//end while
+
+	return;
+}//end function GB_PPU_Render_Pending
+
+/* Begins Mode 3 of the current line at the given cycle count. A new LCD frame first renders any lines left over from the last. */
+void GB_PPU_Start_Line( GameBoy *gb, unsigned cycles ) {
+	struct GB_PictureProcessor *ppu = &( gb->cpu.ppu ); //Picture Processing Unit
+
+	ppu->lineStart = cycles;
+	ppu->isLineInFIFO = false;
+
+	if ( gb->io[0x44] == 0 ) {
+		GB_PPU_Render_Pending( gb );
+		ppu->renderedLines = 0;
+		ppu->completedLines = 0;
+	}//end if
+
+	if ( gb->doRenderPerDot && !( gb->suppressedFrames ) ) {
+		GB_PPU_Render_Pending( gb );
+		Begin_FIFO_Line( gb );
+	}//end if
+
+	return;
+}//end function GB_PPU_Start_Line
+
+/* Ends Mode 3 of the current line. A line started in the Pixel FIFO is finished there. Otherwise, the line is left for the fast path to render later. */
+void GB_PPU_End_Line( GameBoy *gb ) {
+	struct GB_PictureProcessor *ppu = &( gb->cpu.ppu ); //Picture Processing Unit
+
+	ppu->completedLines = gb->io[0x44] + 1;
+	if ( !( ppu->isLineInFIFO ) ) return;
+
+	Run_FIFO( gb, GB_LCD_WIDTH );
+	if ( ppu->isFetchingWindow ) ppu->windowLine += 1;
+	ppu->isLineInFIFO = false;
+	ppu->renderedLines = ppu->completedLines;
+
+	return;
+}//end function GB_PPU_End_Line
+
+/*	Brings the LCD up to date with the current cycle count. Must be called before any CPU write to VRAM, OAM, or a register affecting rendering.
+*	Completed lines are rendered first. Within Mode 3, the current line then switches to the Pixel FIFO and pushes every pixel due before the write.
+*/
+void GB_PPU_Catch_Up( GameBoy *gb ) {
+	struct GB_PictureProcessor *ppu = &( gb->cpu.ppu ); //Picture Processing Unit
+	unsigned dots = gb->cycles - ppu->lineStart; //Dots since Mode 3 began
+	unsigned pixels; //Number of pixels due by this dot
+
+	GB_PPU_Render_Pending( gb );
+	if ( gb->suppressedFrames || !( gb->io[0x40] & 0x80 ) || ( gb->io[0x41] & 0x03 ) != 3 ) return;
+
+	pixels = dots > GB_FIFO_STARTUP_DOTS ? dots - GB_FIFO_STARTUP_DOTS : 0;
+	if ( pixels > GB_LCD_WIDTH ) pixels = GB_LCD_WIDTH;
+
+	if ( !( ppu->isLineInFIFO ) ) Begin_FIFO_Line( gb );
+	Run_FIFO( gb, pixels );
+
+	return;
+}//end function GB_PPU_Catch_Up
+
+/*	Finishes the LCD frame upon entering VBlank. Renders any pending lines, then swaps the drawn framebuffer with the displayed one.
+*	The first frame after the LCD is turned on is not displayed, as on hardware. Neither is a suppressed frame.
+*/
+void GB_PPU_End_Frame( GameBoy *gb ) {
+	uint8_t *drawn = gb->lcd; //Framebuffer of the frame just drawn
+
+	GB_PPU_Render_Pending( gb );
+
+	if ( gb->suppressedFrames ) {
+		gb->suppressedFrames -= 1;
+		gb->lcdBlankThisFrame = false;
+		return;
+	}//end if
+
+	if ( gb->lcdBlankThisFrame ) {
+		gb->lcdBlankThisFrame = false;
+		return;
+	}//end if
+
+	gb->lcd = gb->frame;
+	gb->frame = drawn;
+
+	return;
+}//end function GB_PPU_End_Frame
@@ -0,0 +1,270 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "GameBoy.h"
+
+/*	Rewind history. The newest state is held in full, and each older frame as the XOR of its state against the frame after it.
+*	Most of the machine is unchanged between frames, so the XOR is mostly zero words, and is stored as runs of skipped and changed words.
+*	Stepping back XORs the newest delta into the held state, which yields the state before it, so no periodic keyframes are needed.
+*	Deltas are packed into a fixed-size ring of bytes. When it fills, the oldest deltas are dropped, so history is only ever cut short from the far end.
+*/
+
+#define REWIND_MAX_RUN 0xFFFF //Maximum number of words in one run of a delta
+
+//Defines the location of one frame's delta in the ring
+struct GB_RewindRecord {
+	uint32_t offset; //Offset of delta into ring
+	uint32_t length; //Length of delta in bytes
+};
+
+//Defines the state of a system's rewind history
+struct GB_Rewind {
+	size_t stateSize; //Size of one state in bytes
+	size_t words; //Size of one state in 8-byte words, rounded up. State buffers are zero-padded to a whole word.
+	uint8_t *current; //Newest state, in full
+	uint8_t *scratch; //State of the frame being pushed
+	uint8_t *delta; //Delta of the frame being pushed. Large enough for the delta of any two states.
+	bool hasCurrent; //Whether current holds a state yet
+
+	uint8_t *ring; //Delta storage
+	size_t capacity; //Size of ring in bytes
+	size_t head; //Offset into ring just past the newest delta
+
+	struct GB_RewindRecord records[GB_REWIND_MAX_FRAMES]; //Location of each delta, oldest first from index first
+	unsigned first; //Index of oldest record
+	unsigned count; //Number of records held
+
+	uint64_t pushes; //Total number of frames pushed
+	uint64_t pushedBytes; //Total size of deltas pushed, in bytes
+};
+
+/* Returns the 8-byte word at the given word index of the given state. */
+static inline uint64_t Load_Word( const uint8_t *state, size_t index ) {
+	uint64_t word; //Word loaded
+
+	memcpy( &word, state + index * 8, 8 );
+	return word;
+}//end function Load_Word
+
+/*	Encodes the XOR of two states of the given number of words into out, as runs of a 16-bit skipped word count,
+*	a 16-bit changed word count, then the XOR of each changed word. Trailing unchanged words are left out.
+*	Returns the length of the delta in bytes.
+*/
+static size_t Encode_Delta( const uint8_t *older, const uint8_t *newer, size_t words, uint8_t *out ) {
+	uint8_t *cursor = out; //Next byte of delta to be written
+	size_t i = 0; //Index of next word to be compared
+
+	while ( i < words ) {
+		uint16_t skipped = 0; //Number of unchanged words in run
+		uint16_t changed = 0; //Number of changed words in run
+		size_t runStart; //Index of first changed word in run
+
+		while ( i < words && skipped < REWIND_MAX_RUN && Load_Word( older, i ) == Load_Word( newer, i ) ) {
+			++skipped;
+			++i;
+		}//end while
+
+		runStart = i;
+		while ( i < words && changed < REWIND_MAX_RUN && Load_Word( older, i ) != Load_Word( newer, i ) ) {
+			++changed;
+			++i;
+		}//end while
+
+		if ( !changed && i == words ) break;
+
+		memcpy( cursor, &skipped, 2 );
+		memcpy( cursor + 2, &changed, 2 );
+		cursor += 4;
+		for ( size_t w = runStart; w < i; ++w ) {
+			uint64_t word = Load_Word( older, w ) ^ Load_Word( newer, w ); //Changed bits of word
+
+			memcpy( cursor, &word, 8 );
+			cursor += 8;
+		}//end for
+	}//end while
+
+	return (size_t)( cursor - out );
+}//end function Encode_Delta
+
+/* XORs the given delta into the given state. Applied to either of the two states it was encoded from, yields the other. */
+static void Apply_Delta( const uint8_t *delta, size_t length, uint8_t *state ) {
+	const uint8_t *cursor = delta; //Next byte of delta to be read
+	size_t i = 0; //Index of next word of state
+
+	while ( cursor < delta + length ) {
+		uint16_t skipped; //Number of unchanged words in run
+		uint16_t changed; //Number of changed words in run
+
+		memcpy( &skipped, cursor, 2 );
+		memcpy( &changed, cursor + 2, 2 );
+		cursor += 4;
+		i += skipped;
+
+		for ( ; changed; --changed, ++i, cursor += 8 ) {
+			uint64_t word; //Changed bits of word
+
+			memcpy( &word, cursor, 8 );
+			word ^= Load_Word( state, i );
+			memcpy( state + i * 8, &word, 8 );
+		}//end for
+	}//end while
+
+	return;
+}//end function Apply_Delta
+
+/* Returns the index of the record the given number of records after the oldest. */
+static unsigned Record_Index( const struct GB_Rewind *rewind, unsigned n ) {
+	return ( rewind->first + n ) & ( GB_REWIND_MAX_FRAMES - 1 );
+}//end function Record_Index
+
+/* Returns whether the given range of the ring overlaps any held delta. Held deltas span from the oldest delta's offset up to head, wrapping around the ring. */
+static bool Overlaps_History( const struct GB_Rewind *rewind, size_t offset, size_t length ) {
+	size_t oldest = rewind->records[rewind->first].offset; //Offset of oldest delta
+
+	if ( !( rewind->count ) ) return false;
+	if ( oldest < rewind->head ) return offset < rewind->head && oldest < offset + length;
+
+	return offset < rewind->head || offset + length > oldest;
+}//end function Overlaps_History
+
+/* Reserves a contiguous range of the ring of the given length, dropping the oldest deltas as needed. Returns the offset of the range. */
+static size_t Reserve_Ring( struct GB_Rewind *rewind, size_t length ) {
+	size_t offset = rewind->head + length <= rewind->capacity ? rewind->head : 0; //Offset of range, wrapped to the start of the ring if it would not fit at the end
+
+	while ( rewind->count && ( rewind->count == GB_REWIND_MAX_FRAMES || Overlaps_History( rewind, offset, length ) ) ) {
+		rewind->first = Record_Index( rewind, 1 );
+		rewind->count -= 1;
+	}//end while
+
+	rewind->head = offset + length;
+
+	return offset;
+}//end function Reserve_Ring
+
+/*	Allocates the system's rewind history, holding as many frames as fit in the given number of bytes of deltas.
+*	Must be called after the game is loaded, as the size of each state depends on the cartridge. Frames are recorded by GB_Run_Frame() from then on.
+*	Returns 0 if successful. Else, returns 1 if unable to allocate.
+*/
+int GB_Rewind_Init( GameBoy *gb, size_t capacity ) {
+	struct GB_Rewind *rewind; //New rewind history
+	size_t words = ( GB_State_Size( gb ) + 7 ) / 8; //Size of one state in words
+
+	rewind = calloc( 1, sizeof( struct GB_Rewind ) );
+	if ( !rewind ) {
+		GB_ERROR( gb, "Unable to allocate rewind history.\n" );
+		return 1;
+	}//end if
+
+	rewind->stateSize = GB_State_Size( gb );
+	rewind->words = words;
+	rewind->capacity = capacity;
+	rewind->current = calloc( words, 8 );
+	rewind->scratch = calloc( words, 8 );
+	rewind->delta = malloc( words * 12 ); //At worst, every word is changed and in a run of its own
+	rewind->ring = malloc( capacity );
+
+	gb->rewind = rewind;
+	if ( !( rewind->current ) || !( rewind->scratch ) || !( rewind->delta ) || !( rewind->ring ) || capacity > UINT32_MAX ) {
+		GB_ERROR( gb, "Unable to allocate rewind history.\n" );
+
+		GB_Rewind_Deinit( gb );
+		return 1;
+	}//end if
+
+	GB_DEBUG( gb, "Rewind history allocated (%zu bytes, %zu byte states).\n", capacity, rewind->stateSize );
+
+	return 0;
+}//end function GB_Rewind_Init
+
+/* Frees the system's rewind history, if allocated. */
+void GB_Rewind_Deinit( GameBoy *gb ) {
+	struct GB_Rewind *rewind = gb->rewind; //Rewind history being freed
+
+	if ( rewind ) {
+		free( rewind->current );
+		free( rewind->scratch );
+		free( rewind->delta );
+		free( rewind->ring );
+		free( rewind );
+	}//end if
+	gb->rewind = NULL;
+
+	return;
+}//end function GB_Rewind_Deinit
+
+/* Records the system's state at the end of a frame as the newest frame of its rewind history. */
+void GB_Rewind_Push( GameBoy *gb ) {
+	struct GB_Rewind *rewind = gb->rewind; //Rewind history being pushed to
+	struct GB_RewindRecord *record; //Record of the new delta
+	uint8_t *older; //Previous newest state
+	size_t length; //Length of the new delta in bytes
+
+	if ( !( rewind->hasCurrent ) ) {
+		GB_Save_State( gb, rewind->current, rewind->stateSize );
+		rewind->hasCurrent = true;
+		return;
+	}//end if
+
+	GB_Save_State( gb, rewind->scratch, rewind->stateSize );
+	length = Encode_Delta( rewind->current, rewind->scratch, rewind->words, rewind->delta );
+
+	rewind->pushes += 1;
+	rewind->pushedBytes += length;
+
+	//The new state becomes the one held in full
+	older = rewind->current;
+	rewind->current = rewind->scratch;
+	rewind->scratch = older;
+
+	//A delta larger than the whole ring cannot be held, and breaks the chain back to every older frame
+	if ( length > rewind->capacity ) {
+		rewind->count = 0;
+		return;
+	}//end if
+
+	record = &( rewind->records[Record_Index( rewind, rewind->count )] );
+	record->offset = (uint32_t)Reserve_Ring( rewind, length );
+	record->length = (uint32_t)length;
+	memcpy( rewind->ring + record->offset, rewind->delta, length );
+	rewind->count += 1;
+
+	return;
+}//end function GB_Rewind_Push
+
+/*	Restores the system to the frame before the newest frame of its rewind history, and drops the newest frame.
+*	Returns true if successful. Otherwise, returns false if there is no older frame, in which case the system is unchanged.
+*/
+bool GB_Rewind_Step( GameBoy *gb ) {
+	struct GB_Rewind *rewind = gb->rewind; //Rewind history being stepped back through
+	const struct GB_RewindRecord *record; //Record of the newest delta
+
+	if ( !( rewind->count ) ) return false;
+
+	record = &( rewind->records[Record_Index( rewind, rewind->count - 1 )] );
+	Apply_Delta( rewind->ring + record->offset, record->length, rewind->current );
+	rewind->head = record->offset;
+	rewind->count -= 1;
+
+	GB_Load_State( gb, rewind->current, rewind->stateSize );
+
+	return true;
+}//end function GB_Rewind_Step
+
+/* Writes a summary of the system's rewind history to the given stream. Writes nothing if no frames were pushed. */
+void GB_Rewind_Print_Stats( const GameBoy *gb, FILE *out ) {
+	const struct GB_Rewind *rewind = gb->rewind; //Rewind history being summarized
+	size_t heldBytes = 0; //Total size of held deltas
+
+	if ( !rewind || !( rewind->pushes ) ) return;
+
+	for ( unsigned n = 0; n < rewind->count; ++n )
+		heldBytes += rewind->records[Record_Index( rewind, n )].length;
+
+	fprintf( out, "Rewind history: %u frames in %zu bytes (%zu byte states)\n", rewind->count, heldBytes, rewind->stateSize );
+	fprintf( out, "Mean delta: %.0f bytes\n", (double)rewind->pushedBytes / rewind->pushes );
+
+	return;
+}//end function GB_Rewind_Print_Stats
@@ -0,0 +1,257 @@
+#define _DEFAULT_SOURCE //Exposes ftruncate(), msync() and fsync() when compiling as strict ISO C
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined( _WIN32 )
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+#include "GameBoy.h"
+
+/*	Battery-backed external RAM. The RAM of a battery-backed cartridge can be attached to a save file, which then holds a copy of the RAM.
+*	The emulated RAM itself stays private to the system, as states loaded for run-ahead and rewinding are written into it.
+*	At the end of every frame actually played, GB_Commit_Save() copies the parts of the RAM that have changed into the save image:
+*	the file mapped shared and writable, so the game never waits on the file system, and committed saves survive the emulator crashing.
+*	The kernel writes the mapping back to the disk on its own, and GB_Flush_Save() bounds how long it may stay unwritten.
+*	Where a file cannot be mapped, the save image is an in-memory copy, which GB_Flush_Save() writes back whole, in place, whenever it has changed.
+*/
+
+#define GB_SAVE_CHUNK_SIZE 0x100 //Bytes of external RAM compared and committed at once
+
+//Defines the state of a save file attached to a system's external RAM
+struct GB_Save {
+	uint8_t *image; //External RAM as of the last commit. The save file mapped shared if isMapped, else a copy written back by GB_Flush_Save().
+	bool isMapped; //Whether image is a shared mapping of the save file
+	char *path; //Path of the save file, if it could not be mapped. NULL otherwise.
+	uint8_t *flushCopy; //Consistent copy of image taken by GB_Flush_Save() to write back, if the save file could not be mapped. NULL otherwise.
+	atomic_uint sequence; //Commit sequence number. Odd while a commit is writing to image, and advanced by 2 by each commit changing it.
+	unsigned flushedSequence; //Sequence number of the image last written back. Only accessed by GB_Flush_Save() and GB_Detach_Save().
+};
+
+/* Attempts to map the given number of bytes of the save file at the given path shared and writable, creating or extending it with 0 as needed. Returns the mapping, or NULL if unable. */
+static uint8_t *Map_Save_File( const char *path, size_t size ) {
+#if !defined( _WIN32 )
+	int fd = open( path, O_RDWR | O_CREAT, 0644 ); //Save file descriptor
+	struct stat fileStat; //Status of save file
+	void *image = MAP_FAILED; //Mapping of save file
+
+	if ( fd < 0 ) return NULL;
+
+	if ( !fstat( fd, &fileStat ) && ( (size_t)fileStat.st_size >= size || !ftruncate( fd, (off_t)size ) ) )
+		image = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+	close( fd );
+
+	return image == MAP_FAILED ? NULL : image;
+#else
+	(void)path;
+	(void)size;
+
+	return NULL;
+#endif
+}//end function Map_Save_File
+
+/* Frees the given save, unmapping or freeing its image. */
+static void Free_Save( struct GB_Save *save, size_t size ) {
+#if !defined( _WIN32 )
+	if ( save->isMapped ) munmap( save->image, size );
+#else
+	(void)size;
+#endif
+	if ( !( save->isMapped ) ) free( save->image );
+	free( save->flushCopy );
+	free( save->path );
+	free( save );
+
+	return;
+}//end function Free_Save
+
+/*	Attaches the external RAM of the loaded cartridge to the save file at the given path, which is created if it does not exist.
+*	The RAM is replaced by the file's contents, and from then on committed to it at the end of every frame. Does nothing if the cartridge has no battery-backed RAM.
+*	Must be called after the game is loaded, and before it is run. Returns 0 if successful. Else, returns 1 if unable to use the file, in which case the RAM is unchanged.
+*/
+int GB_Attach_Save( GameBoy *gb, const char *path ) {
+	struct GB_GamePak *cart = &( gb->cart ); //Cartridge being attached
+	struct GB_Save *save; //New save
+	FILE *saveFile; //Save file, if unable to map it
+
+	if ( !( cart->hasBattery ) || !( cart->extramImage ) ) return 0;
+
+	GB_Detach_Save( gb );
+
+	save = calloc( 1, sizeof( struct GB_Save ) );
+	if ( !save ) {
+		GB_ERROR( gb, "Unable to allocate save.\n" );
+		return 1;
+	}//end if
+	atomic_init( &( save->sequence ), 0 );
+	save->flushedSequence = 0;
+
+	//Map save file as the save image, if able, and read RAM from it
+	save->image = Map_Save_File( path, cart->extramSize );
+	if ( save->image ) {
+		save->isMapped = true;
+		memcpy( cart->extramImage, save->image, cart->extramSize );
+
+		cart->save = save;
+		cart->isSaveStale = false;
+		GB_DEBUG( gb, "Mapped save file \"%s\" for external RAM.\n", path );
+
+		return 0;
+	}//end if
+
+	//Otherwise, make sure save file can be written, and keep the save image in memory, remembering where to write it back
+	saveFile = fopen( path, "ab" );
+	if ( !saveFile ) {
+		GB_ERROR( gb, "Unable to open save file \"%s\".\n", path );
+		Free_Save( save, cart->extramSize );
+		return 1;
+	}//end if
+	fclose( saveFile );
+
+	save->image = malloc( cart->extramSize );
+	save->flushCopy = malloc( cart->extramSize );
+	save->path = malloc( strlen( path ) + 1 );
+	if ( !( save->image ) || !( save->flushCopy ) || !( save->path ) ) {
+		GB_ERROR( gb, "Unable to allocate save image.\n" );
+		Free_Save( save, cart->extramSize );
+		return 1;
+	}//end if
+	strcpy( save->path, path );
+
+	saveFile = fopen( path, "rb" );
+	if ( saveFile ) {
+		if ( fread( cart->extramImage, 1, cart->extramSize, saveFile ) != cart->extramSize ) GB_DEBUG( gb, "Save file shorter than external RAM. Remainder left as is.\n" );
+		fclose( saveFile );
+	}//end if
+	memcpy( save->image, cart->extramImage, cart->extramSize );
+
+	cart->save = save;
+	cart->isSaveStale = false;
+	GB_DEBUG( gb, "Read save file \"%s\" into external RAM.\n", path );
+
+	return 0;
+}//end function GB_Attach_Save
+
+/*	Copies each chunk of external RAM that differs from the attached save image into it, if the RAM may have changed since last committed.
+*	Called by GB_Run_Frame() at the end of every frame not run ahead, so the save file only ever holds RAM of frames actually played.
+*	Only chunks that differ are written, so unchanged pages of a mapped save file are never dirtied, and are never written back.
+*/
+void GB_Commit_Save( GameBoy *gb ) {
+	struct GB_GamePak *cart = &( gb->cart ); //Cartridge being committed
+	struct GB_Save *save = cart->save; //Save being committed to
+	unsigned sequence = atomic_load_explicit( &( save->sequence ), memory_order_relaxed ); //Commit sequence number before this commit
+	bool isWriting = false; //Whether any chunk has been written by this commit
+
+	if ( !( cart->isSaveStale ) ) return;
+
+	//RAM cannot change again until it is enabled or restored, which marks it stale once more
+	if ( !( cart->extram ) ) cart->isSaveStale = false;
+
+	for ( size_t offset = 0; offset < cart->extramSize; offset += GB_SAVE_CHUNK_SIZE ) {
+		if ( !memcmp( save->image + offset, cart->extramImage + offset, GB_SAVE_CHUNK_SIZE ) ) continue;
+
+		//Mark image as being written, so GB_Flush_Save() discards any copy taken meanwhile
+		if ( !isWriting ) {
+			atomic_store_explicit( &( save->sequence ), sequence + 1, memory_order_relaxed );
+			atomic_thread_fence( memory_order_release );
+			isWriting = true;
+		}//end if
+
+		memcpy( save->image + offset, cart->extramImage + offset, GB_SAVE_CHUNK_SIZE );
+	}//end for
+
+	if ( isWriting ) atomic_store_explicit( &( save->sequence ), sequence + 2, memory_order_release );
+
+	return;
+}//end function GB_Commit_Save
+
+/*	Writes back the attached save image to the save file, if committed to since last written back, and waits for it to reach the disk.
+*	May be called from one thread other than the emulation thread while the system runs, as it never blocks the commits made by the emulation thread,
+*	so is safe to call periodically from a background thread, but not while the game is being loaded or unloaded, or a save file attached or detached.
+*	Returns 0 if successful, or if no save file is attached. Else, returns 1 if unable.
+*/
+int GB_Flush_Save( const GameBoy *gb ) {
+	struct GB_Save *save = gb->cart.save; //Save being written back
+	size_t size = gb->cart.extramSize; //Size of save image
+	unsigned sequence; //Commit sequence number of the image written back
+	FILE *saveFile; //Save file, if not mapped
+	bool didFail; //Whether writing the save file failed
+
+	if ( !save ) return 0;
+
+	sequence = atomic_load_explicit( &( save->sequence ), memory_order_acquire );
+	if ( sequence == save->flushedSequence ) return 0;
+
+#if !defined( _WIN32 )
+	//Mapped pages are written back by the kernel as they are committed to, so any commit under way is only written back early
+	if ( save->isMapped ) {
+		if ( msync( save->image, size, MS_SYNC ) ) {
+			GB_ERROR( gb, "Unable to write back mapped save file.\n" );
+			return 1;
+		}//end if
+
+		save->flushedSequence = sequence;
+		return 0;
+	}//end if
+#endif
+
+	//Take a copy of the image between commits, retrying if a commit was under way while copying
+	for ( ;; ) {
+		if ( !( sequence & 1 ) ) {
+			memcpy( save->flushCopy, save->image, size );
+			atomic_thread_fence( memory_order_acquire );
+			if ( atomic_load_explicit( &( save->sequence ), memory_order_relaxed ) == sequence ) break;
+		}//end if
+
+		sequence = atomic_load_explicit( &( save->sequence ), memory_order_acquire );
+	}//end for
+
+	saveFile = fopen( save->path, "r+b" ); //Overwritten in place, so the file is never left truncated
+	if ( !saveFile ) {
+		GB_ERROR( gb, "Unable to open save file \"%s\" for writing.\n", save->path );
+		return 1;
+	}//end if
+
+	didFail = fwrite( save->flushCopy, 1, size, saveFile ) != size || fflush( saveFile );
+#if !defined( _WIN32 )
+	if ( !didFail && fsync( fileno( saveFile ) ) ) didFail = true;
+#else
+	if ( !didFail && _commit( _fileno( saveFile ) ) ) didFail = true;
+#endif
+	if ( fclose( saveFile ) ) didFail = true;
+
+	if ( didFail ) GB_ERROR( gb, "Unable to write save file \"%s\".\n", save->path );
+	else save->flushedSequence = sequence;
+
+	return didFail ? 1 : 0;
+}//end function GB_Flush_Save
+
+/*	Commits and writes back the attached save file, if any, then detaches it. The external RAM is unchanged.
+*	Called by GB_Unload_Game(), so need only be called directly to stop saving a game which is still loaded.
+*/
+void GB_Detach_Save( GameBoy *gb ) {
+	struct GB_GamePak *cart = &( gb->cart ); //Cartridge being detached
+
+	if ( !( cart->save ) ) return;
+
+	GB_Commit_Save( gb );
+	GB_Flush_Save( gb );
+
+	Free_Save( cart->save, cart->extramSize );
+	cart->save = NULL;
+	cart->isSaveStale = false;
+
+	GB_DEBUG( gb, "Detached save file.\n" );
+
+	return;
+}//end function GB_Detach_Save
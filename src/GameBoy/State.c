@@ -0,0 +1,380 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "GameBoy.h"
+
+/*	Save states. A state is a flat, versioned binary blob of the whole emulated machine, independent of the host's byte order and struct layout.
+*	Multi-byte fields are stored little-endian and booleans as single bytes. Bulk memory follows the fixed fields, so saving is mostly a handful of block copies.
+*	Host pointers are never stored: the memory map and LCD framebuffer pointers are rebuilt on load, and ROM is expected to already be loaded.
+*	The layout below must only ever change together with GB_STATE_VERSION.
+*/
+
+#define STATE_MAGIC "EDBS" //First 4 bytes of every state
+#define STATE_EVENT_COUNT 5 //Number of scheduler deadlines stored in a state
+
+_Static_assert( GB_EVENT_COUNT == STATE_EVENT_COUNT, "Scheduler events changed: update the state layout and GB_STATE_VERSION" );
+
+#define STATE_HEADER_SIZE 16 //Magic, version, cartridge checksum, and external RAM size
+#define STATE_CPU_SIZE ( 6 * 2 + 4 + 0x80 ) //Register pairs, SP, PC, interrupt and halt flags, and HRAM
+#define STATE_PPU_SIZE ( 3 + 2 * 16 * 3 + 2 + 10 + 1 + 3 + 4 + 7 + 0xA0 ) //Fetcher, FIFOs, OAM scan, render progress, window, and OAM
+#define STATE_SYSTEM_SIZE ( 0x80 + 1 + STATE_EVENT_COUNT * 4 + 4 + 2 + 4 + 1 + 4 + 3 + 3 + 5 ) //I/O registers, buttons, scheduler, timing, blocking flags, and bank registers
+#define STATE_MEMORY_SIZE ( 0x2000 + 0x2000 + 2 * GB_LCD_HEIGHT * GB_LCD_WIDTH ) //WRAM, VRAM, and both LCD framebuffers
+#define STATE_FIXED_SIZE ( STATE_HEADER_SIZE + STATE_CPU_SIZE + STATE_PPU_SIZE + STATE_SYSTEM_SIZE + STATE_MEMORY_SIZE ) //Size of a state without external RAM
+
+/* Writes a 16-bit value at the cursor, little-endian, and advances the cursor. */
+static inline void Put_U16( uint8_t **cursor, uint16_t value ) {
+	( *cursor )[0] = (uint8_t)value;
+	( *cursor )[1] = (uint8_t)( value >> 8 );
+	*cursor += 2;
+
+	return;
+}//end function Put_U16
+
+/* Writes a 32-bit value at the cursor, little-endian, and advances the cursor. */
+static inline void Put_U32( uint8_t **cursor, uint32_t value ) {
+	( *cursor )[0] = (uint8_t)value;
+	( *cursor )[1] = (uint8_t)( value >> 8 );
+	( *cursor )[2] = (uint8_t)( value >> 16 );
+	( *cursor )[3] = (uint8_t)( value >> 24 );
+	*cursor += 4;
+
+	return;
+}//end function Put_U32
+
+/* Copies the given number of bytes to the cursor, and advances the cursor. */
+static inline void Put_Bytes( uint8_t **cursor, const void *bytes, size_t count ) {
+	memcpy( *cursor, bytes, count );
+	*cursor += count;
+
+	return;
+}//end function Put_Bytes
+
+/* Reads a 16-bit little-endian value at the cursor, and advances the cursor. */
+static inline uint16_t Get_U16( const uint8_t **cursor ) {
+	uint16_t value = (uint16_t)( ( *cursor )[0] | ( *cursor )[1] << 8 ); //Value read
+
+	*cursor += 2;
+	return value;
+}//end function Get_U16
+
+/* Reads a 32-bit little-endian value at the cursor, and advances the cursor. */
+static inline uint32_t Get_U32( const uint8_t **cursor ) {
+	uint32_t value = (uint32_t)( *cursor )[0] | (uint32_t)( *cursor )[1] << 8 | (uint32_t)( *cursor )[2] << 16 | (uint32_t)( *cursor )[3] << 24; //Value read
+
+	*cursor += 4;
+	return value;
+}//end function Get_U32
+
+/* Copies the given number of bytes from the cursor, and advances the cursor. */
+static inline void Get_Bytes( const uint8_t **cursor, void *bytes, size_t count ) {
+	memcpy( bytes, *cursor, count );
+	*cursor += count;
+
+	return;
+}//end function Get_Bytes
+
+/* Returns the cartridge's global checksum from its header, identifying which game a state belongs to. 0 if no cartridge is loaded. */
+static uint16_t Get_Cartridge_Checksum( const GameBoy *gb ) {
+	if ( !( gb->cart.romImage ) ) return 0;
+
+	return (uint16_t)( gb->cart.romImage[0x14E] << 8 | gb->cart.romImage[0x14F] );
+}//end function Get_Cartridge_Checksum
+
+/* Returns the size in bytes of a state of the given system, which depends only on its cartridge's external RAM. */
+size_t GB_State_Size( const GameBoy *gb ) {
+	return STATE_FIXED_SIZE + gb->cart.extramSize;
+}//end function GB_State_Size
+
+/*	Saves the total state of the given system into the given buffer, which must hold at least GB_State_Size() bytes.
+*	Must be called between frames. Takes a few microseconds, so may be called every frame.
+*	Returns 0 if successful. Else, returns 1 if the buffer is too small.
+*/
+int GB_Save_State( const GameBoy *gb, uint8_t *buffer, size_t size ) {
+	const struct GB_Processor *cpu = &( gb->cpu ); //CPU being saved
+	const struct GB_PictureProcessor *ppu = &( gb->cpu.ppu ); //PPU being saved
+	uint8_t *cursor = buffer; //Next byte of the state to be written
+
+	if ( size < GB_State_Size( gb ) ) {
+		GB_ERROR( gb, "Save state buffer too small (%zu of %zu bytes).\n", size, GB_State_Size( gb ) );
+		return 1;
+	}//end if
+
+	//Header
+	Put_Bytes( &cursor, STATE_MAGIC, 4 );
+	Put_U16( &cursor, GB_STATE_VERSION );
+	Put_U16( &cursor, 0 );
+	Put_U16( &cursor, Get_Cartridge_Checksum( gb ) );
+	Put_U16( &cursor, 0 );
+	Put_U32( &cursor, (uint32_t)( gb->cart.extramSize ) );
+
+	//CPU
+	Put_U16( &cursor, cpu->af );
+	Put_U16( &cursor, cpu->bc );
+	Put_U16( &cursor, cpu->de );
+	Put_U16( &cursor, cpu->hl );
+	Put_U16( &cursor, cpu->sp );
+	Put_U16( &cursor, cpu->pc );
+	*cursor++ = cpu->ime;
+	*cursor++ = cpu->isIMEPending;
+	*cursor++ = cpu->isHalted;
+	*cursor++ = cpu->isHaltBug;
+	Put_Bytes( &cursor, cpu->hram, 0x80 );
+
+	//PPU
+	*cursor++ = ppu->isOAMBlocked;
+	*cursor++ = ppu->fetcherX;
+	*cursor++ = ppu->fetcherY;
+	for ( int i = 0; i < 16; ++i ) {
+		*cursor++ = ppu->bgFIFO[i].colorIndex;
+		*cursor++ = ppu->bgFIFO[i].palette;
+		*cursor++ = ppu->bgFIFO[i].priority;
+	}//end for
+	for ( int i = 0; i < 16; ++i ) {
+		*cursor++ = ppu->oamFIFO[i].colorIndex;
+		*cursor++ = ppu->oamFIFO[i].palette;
+		*cursor++ = ppu->oamFIFO[i].priority;
+	}//end for
+	*cursor++ = ppu->bgFIFOTail;
+	*cursor++ = ppu->oamFIFOTail;
+	Put_Bytes( &cursor, ppu->oamScanResults, 10 );
+	*cursor++ = ppu->oamScanCount;
+	*cursor++ = ppu->completedLines;
+	*cursor++ = ppu->renderedLines;
+	*cursor++ = ppu->line;
+	Put_U32( &cursor, ppu->lineStart );
+	*cursor++ = ppu->isLineInFIFO;
+	*cursor++ = ppu->lcdX;
+	*cursor++ = ppu->discardCount;
+	*cursor++ = ppu->nextSprite;
+	*cursor++ = ppu->isFetchingWindow;
+	*cursor++ = ppu->windowLine;
+	*cursor++ = ppu->isWindowYTriggered;
+	Put_Bytes( &cursor, ppu->oam, 0xA0 );
+
+	//I/O registers, scheduler and timing
+	Put_Bytes( &cursor, gb->io, 0x80 );
+	*cursor++ = gb->buttons;
+	for ( int i = 0; i < STATE_EVENT_COUNT; ++i )
+		Put_U32( &cursor, gb->scheduler.deadlines[i] );
+	Put_U32( &cursor, gb->scheduler.nextDeadline );
+	Put_U16( &cursor, gb->scheduler.dmaSource );
+	Put_U32( &cursor, gb->cycles );
+	*cursor++ = gb->isFrameOver;
+	Put_U32( &cursor, gb->frameCount );
+
+	//Blocking flags
+	*cursor++ = gb->isWRAMBlocked;
+	*cursor++ = gb->isVRAMBlocked;
+	*cursor++ = gb->lcdBlankThisFrame;
+	*cursor++ = gb->cart.isROM0Blocked;
+	*cursor++ = gb->cart.isROM1Blocked;
+	*cursor++ = gb->cart.isExtRAMBlocked;
+
+	//Bank registers
+	Put_U16( &cursor, gb->cart.romBank );
+	*cursor++ = gb->cart.ramBank;
+	*cursor++ = gb->cart.bankMode;
+	*cursor++ = gb->cart.isExtRAMEnabled;
+
+	//Bulk memory. The framebuffer being drawn is stored first, then the complete frame.
+	Put_Bytes( &cursor, gb->wram, 0x2000 );
+	Put_Bytes( &cursor, gb->vram, 0x2000 );
+	for ( int y = 0; y < GB_LCD_HEIGHT; ++y )
+		Put_Bytes( &cursor, gb->lcd + y * GB_LCD_PITCH, GB_LCD_WIDTH );
+	for ( int y = 0; y < GB_LCD_HEIGHT; ++y )
+		Put_Bytes( &cursor, gb->frame + y * GB_LCD_PITCH, GB_LCD_WIDTH );
+	if ( gb->cart.extramSize ) Put_Bytes( &cursor, gb->cart.extramImage, gb->cart.extramSize );
+
+	return 0;
+}//end function GB_Save_State
+
+/*	Restores the total state of the given system from the given state, saved by GB_Save_State() with the same game loaded.
+*	Must be called between frames. The system is left unchanged if the state is invalid, of another version, or of another game.
+*	Returns 0 if successful. Else, returns 1 if the state cannot be loaded.
+*/
+int GB_Load_State( GameBoy *gb, const uint8_t *buffer, size_t size ) {
+	struct GB_Processor *cpu = &( gb->cpu ); //CPU being restored
+	struct GB_PictureProcessor *ppu = &( gb->cpu.ppu ); //PPU being restored
+	const uint8_t *cursor = buffer; //Next byte of the state to be read
+	uint16_t version; //Layout version of the state
+	uint16_t checksum; //Cartridge checksum of the state
+	uint32_t extramSize; //External RAM size of the state
+
+	//Validate the whole header before touching the system
+	if ( size < STATE_HEADER_SIZE || memcmp( cursor, STATE_MAGIC, 4 ) ) {
+		GB_ERROR( gb, "Not a save state.\n" );
+		return 1;
+	}//end if
+	cursor += 4;
+
+	version = Get_U16( &cursor );
+	cursor += 2;
+	checksum = Get_U16( &cursor );
+	cursor += 2;
+	extramSize = Get_U32( &cursor );
+
+	if ( version != GB_STATE_VERSION ) {
+		GB_ERROR( gb, "Unsupported save state version %u (expected %u).\n", version, GB_STATE_VERSION );
+		return 1;
+	}//end if
+	if ( checksum != Get_Cartridge_Checksum( gb ) || extramSize != gb->cart.extramSize ) {
+		GB_ERROR( gb, "Save state belongs to a different game.\n" );
+		return 1;
+	}//end if
+	if ( size != GB_State_Size( gb ) ) {
+		GB_ERROR( gb, "Save state is %zu bytes (expected %zu).\n", size, GB_State_Size( gb ) );
+		return 1;
+	}//end if
+
+	//CPU
+	cpu->af = Get_U16( &cursor );
+	cpu->bc = Get_U16( &cursor );
+	cpu->de = Get_U16( &cursor );
+	cpu->hl = Get_U16( &cursor );
+	cpu->sp = Get_U16( &cursor );
+	cpu->pc = Get_U16( &cursor );
+	cpu->ime = *cursor++;
+	cpu->isIMEPending = *cursor++;
+	cpu->isHalted = *cursor++;
+	cpu->isHaltBug = *cursor++;
+	Get_Bytes( &cursor, cpu->hram, 0x80 );
+
+	//PPU
+	ppu->isOAMBlocked = *cursor++;
+	ppu->fetcherX = *cursor++;
+	ppu->fetcherY = *cursor++;
+	for ( int i = 0; i < 16; ++i ) {
+		ppu->bgFIFO[i].colorIndex = *cursor++;
+		ppu->bgFIFO[i].palette = *cursor++;
+		ppu->bgFIFO[i].priority = *cursor++;
+	}//end for
+	for ( int i = 0; i < 16; ++i ) {
+		ppu->oamFIFO[i].colorIndex = *cursor++;
+		ppu->oamFIFO[i].palette = *cursor++;
+		ppu->oamFIFO[i].priority = *cursor++;
+	}//end for
+	ppu->bgFIFOTail = *cursor++;
+	ppu->oamFIFOTail = *cursor++;
+	Get_Bytes( &cursor, ppu->oamScanResults, 10 );
+	ppu->oamScanCount = *cursor++;
+	ppu->completedLines = *cursor++;
+	ppu->renderedLines = *cursor++;
+	ppu->line = *cursor++;
+	ppu->lineStart = Get_U32( &cursor );
+	ppu->isLineInFIFO = *cursor++;
+	ppu->lcdX = *cursor++;
+	ppu->discardCount = *cursor++;
+	ppu->nextSprite = *cursor++;
+	ppu->isFetchingWindow = *cursor++;
+	ppu->windowLine = *cursor++;
+	ppu->isWindowYTriggered = *cursor++;
+	Get_Bytes( &cursor, ppu->oam, 0xA0 );
+
+	//I/O registers, scheduler and timing
+	Get_Bytes( &cursor, gb->io, 0x80 );
+	gb->buttons = *cursor++;
+	for ( int i = 0; i < STATE_EVENT_COUNT; ++i )
+		gb->scheduler.deadlines[i] = Get_U32( &cursor );
+	gb->scheduler.nextDeadline = Get_U32( &cursor );
+	gb->scheduler.dmaSource = Get_U16( &cursor );
+	gb->cycles = Get_U32( &cursor );
+	gb->isFrameOver = *cursor++;
+	gb->frameCount = Get_U32( &cursor );
+
+	//Blocking flags
+	gb->isWRAMBlocked = *cursor++;
+	gb->isVRAMBlocked = *cursor++;
+	gb->lcdBlankThisFrame = *cursor++;
+	gb->cart.isROM0Blocked = *cursor++;
+	gb->cart.isROM1Blocked = *cursor++;
+	gb->cart.isExtRAMBlocked = *cursor++;
+
+	//Bank registers
+	gb->cart.romBank = Get_U16( &cursor );
+	gb->cart.ramBank = *cursor++;
+	gb->cart.bankMode = *cursor++;
+	gb->cart.isExtRAMEnabled = *cursor++;
+
+	//Bulk memory. The framebuffer being drawn always becomes the first buffer.
+	gb->lcd = gb->lcdBuffers[0];
+	gb->frame = gb->lcdBuffers[1];
+	Get_Bytes( &cursor, gb->wram, 0x2000 );
+	Get_Bytes( &cursor, gb->vram, 0x2000 );
+	for ( int y = 0; y < GB_LCD_HEIGHT; ++y )
+		Get_Bytes( &cursor, gb->lcd + y * GB_LCD_PITCH, GB_LCD_WIDTH );
+	for ( int y = 0; y < GB_LCD_HEIGHT; ++y )
+		Get_Bytes( &cursor, gb->frame + y * GB_LCD_PITCH, GB_LCD_WIDTH );
+	if ( gb->cart.extramSize ) Get_Bytes( &cursor, gb->cart.extramImage, gb->cart.extramSize );
+	gb->cart.isSaveStale = true;
+
+	//Rebuild the memory map for the restored boot ROM, blocking and bank state. ROM is unchanged, and blocks are tagged by host address, so decoded and compiled blocks stay valid.
+	GB_Map_Memory( gb );
+
+	return 0;
+}//end function GB_Load_State
+
+/*	Saves the total state of the given system to a file at the given path, replacing any existing file.
+*	Returns 0 if successful. Else, returns 1 if unable.
+*/
+int GB_Save_State_File( const GameBoy *gb, const char *path ) {
+	size_t size = GB_State_Size( gb ); //Size of state in bytes
+	uint8_t *buffer = malloc( size ); //State being written
+	FILE *stateFile; //Points to state file, if successfully opened
+	int result = 1; //Whether the state could not be written
+
+	if ( !buffer ) {
+		GB_ERROR( gb, "Unable to allocate memory for save state.\n" );
+		return 1;
+	}//end if
+
+	GB_Save_State( gb, buffer, size );
+
+	stateFile = fopen( path, "wb" );
+	if ( stateFile ) {
+		if ( fwrite( buffer, 1, size, stateFile ) == size ) result = 0;
+		if ( fclose( stateFile ) ) result = 1;
+	}//end if
+	if ( result ) GB_ERROR( gb, "Unable to write save state file %s.\n", path );
+	else GB_DEBUG( gb, "Saved state to %s (%zu bytes).\n", path, size );
+
+	free( buffer );
+	return result;
+}//end function GB_Save_State_File
+
+/*	Restores the total state of the given system from a file at the given path, saved by GB_Save_State_File() with the same game loaded.
+*	Returns 0 if successful. Else, returns 1 if unable to read the file or load its state.
+*/
+int GB_Load_State_File( GameBoy *gb, const char *path ) {
+	FILE *stateFile = fopen( path, "rb" ); //Points to state file, if successfully opened
+	uint8_t *buffer; //State read from file
+	long fileSize; //Size of state file in bytes
+	int result; //Whether the state could not be loaded
+
+	if ( !stateFile ) {
+		GB_ERROR( gb, "Unable to open save state file %s.\n", path );
+		return 1;
+	}//end if
+
+	fseek( stateFile, 0, SEEK_END );
+	fileSize = ftell( stateFile );
+	rewind( stateFile );
+
+	buffer = fileSize > 0 ? malloc( (size_t)fileSize ) : NULL;
+	if ( !buffer || fread( buffer, 1, (size_t)fileSize, stateFile ) != (size_t)fileSize ) {
+		GB_ERROR( gb, "Unable to read save state file %s.\n", path );
+
+		free( buffer );
+		fclose( stateFile );
+		return 1;
+	}//end if
+	fclose( stateFile );
+
+	result = GB_Load_State( gb, buffer, (size_t)fileSize );
+	if ( !result ) GB_DEBUG( gb, "Loaded state from %s.\n", path );
+
+	free( buffer );
+	return result;
+}//end function GB_Load_State_File
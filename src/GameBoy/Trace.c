@@ -0,0 +1,116 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "GameBoy.h"
+
+//Defines the text format of each trace category. Takes the address and value of a record, in that order.
+static const char *const TRACE_FORMATS[GB_TRACE_KIND_COUNT] = {
+	"Read @ 0x%04X -> 0x%02X", //GB_TRACE_READ
+	"Write @ 0x%04X <- 0x%02X", //GB_TRACE_WRITE
+	"Access to Unusable Area or unused I/O register @ 0x%04X (0x%02X)", //GB_TRACE_INVALID
+	"Register @ 0x%04X now 0x%02X", //GB_TRACE_REGISTER
+	"Interrupt requested in IF @ 0x%04X, bit 0x%02X", //GB_TRACE_INTERRUPT
+	"PPU mode change at LY @ 0x%04X to Mode %d", //GB_TRACE_PPU_MODE
+	"OAM DMA from 0x%04X %s", //GB_TRACE_DMA
+	"Executing @ 0x%04X opcode 0x%02X" //GB_TRACE_OPCODE
+};
+
+/*	Allocates the system's trace ring buffer and enables the trace categories in the given mask.
+*	Returns 0 if successful. Else, returns 1 if unable to allocate.
+*/
+int GB_Trace_Init( GameBoy *gb, uint32_t mask ) {
+	gb->trace = malloc( sizeof( struct GB_Trace ) );
+	if ( !( gb->trace ) ) {
+		GB_ERROR( gb, "Unable to allocate trace buffer.\n" );
+		return 1;
+	}//end if
+
+	atomic_init( &( gb->trace->head ), 0 );
+	atomic_init( &( gb->trace->tail ), 0 );
+	gb->trace->dropped = 0;
+	gb->trace->mask = mask;
+	GB_DEBUG( gb, "Trace buffer allocated (%d records, mask 0x%02X).\n", GB_TRACE_CAPACITY, mask );
+
+	return 0;
+}//end function GB_Trace_Init
+
+/* Frees the system's trace ring buffer, if allocated. Any consumer must have stopped beforehand. */
+void GB_Trace_Deinit( GameBoy *gb ) {
+	if ( gb->trace ) {
+		if ( gb->trace->dropped ) GB_ERROR( gb, "%u trace records were dropped.\n", gb->trace->dropped );
+		free( gb->trace );
+	}//end if
+	gb->trace = NULL;
+
+	return;
+}//end function GB_Trace_Deinit
+
+/*	Appends one record to the system's trace ring buffer. Only called by the emulation thread, via GB_TRACE.
+*	Never blocks. If the consumer has fallen behind and the buffer is full, the record is dropped and counted.
+*/
+void GB_Trace_Record( GameBoy *gb, enum GB_TraceKind kind, uint16_t addr, uint8_t value ) {
+	struct GB_Trace *trace = gb->trace; //Trace ring buffer to append to
+	struct GB_TraceRecord *record; //Slot of the new record
+	unsigned head; //Index of the new record
+
+	head = atomic_load_explicit( &( trace->head ), memory_order_relaxed );
+	if ( head - atomic_load_explicit( &( trace->tail ), memory_order_acquire ) >= GB_TRACE_CAPACITY ) {
+		trace->dropped += 1;
+		return;
+	}//end if
+
+	record = &( trace->records[head & ( GB_TRACE_CAPACITY - 1 )] );
+	record->frame = gb->frameCount;
+	record->cycles = gb->cycles;
+	record->pc = gb->cpu.pc;
+	record->addr = addr;
+	record->value = value;
+	record->kind = (uint8_t)kind;
+
+	//Publish record to consumer
+	atomic_store_explicit( &( trace->head ), head + 1, memory_order_release );
+
+	return;
+}//end function GB_Trace_Record
+
+/*	Removes up to the given number of records from the trace ring buffer, oldest first, and copies them into the given array.
+*	Only called by the single consumer thread.
+*	Returns the number of records copied.
+*/
+size_t GB_Trace_Drain( struct GB_Trace *trace, struct GB_TraceRecord *records, size_t maxRecords ) {
+	unsigned tail; //Index of the oldest unread record
+	unsigned available; //Number of unread records
+	size_t count = 0; //Number of records copied
+
+	tail = atomic_load_explicit( &( trace->tail ), memory_order_relaxed );
+	available = atomic_load_explicit( &( trace->head ), memory_order_acquire ) - tail;
+
+	while ( count < available && count < maxRecords ) {
+		records[count] = trace->records[( tail + count ) & ( GB_TRACE_CAPACITY - 1 )];
+		++count;
+	}//end while
+
+	//Release slots back to producer
+	atomic_store_explicit( &( trace->tail ), tail + (unsigned)count, memory_order_release );
+
+	return count;
+}//end function GB_Trace_Drain
+
+/*	Decodes a binary trace record into one line of text, without a trailing newline, in the given buffer.
+*	Returns the number of characters that the full line would contain, as snprintf does.
+*/
+int GB_Trace_Format( const struct GB_TraceRecord *record, char *buffer, size_t size ) {
+	int prefixLength; //Number of characters in the timestamp prefix
+
+	prefixLength = snprintf( buffer, size, "[%6u:%5u PC=0x%04X] ", record->frame, record->cycles, record->pc );
+	if ( prefixLength < 0 || (size_t)prefixLength >= size ) return prefixLength;
+
+	if ( record->kind >= GB_TRACE_KIND_COUNT )
+		return prefixLength + snprintf( buffer + prefixLength, size - prefixLength, "Unknown trace record kind %d", record->kind );
+
+	if ( record->kind == GB_TRACE_DMA )
+		return prefixLength + snprintf( buffer + prefixLength, size - prefixLength, TRACE_FORMATS[GB_TRACE_DMA], record->addr, record->value ? "started" : "complete" );
+
+	return prefixLength + snprintf( buffer + prefixLength, size - prefixLength, TRACE_FORMATS[record->kind], record->addr, record->value );
+}//end function GB_Trace_Format
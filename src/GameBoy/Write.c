@@ -0,0 +1,29 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "GameBoy.h"
+
+/*	Performs write operation of a byte to the specified 16-bit address in the corresponding place in the emulated Game Boy's memory.
+*	Iterates cycle count for current frame by 4 T-States for the write op.
+*/
+void GB_Write( GameBoy *gb, uint16_t addr, uint8_t value ) {
+	GB_Write_Untimed( gb, addr, value );
+	GB_TRACE( gb, GB_TRACE_WRITE, addr, value );
+
+	//Increment cycles for write
+	GB_Cycle_T_States( gb, 4 );
+
+	return;
+}//end function GB_Write
+
+/*	Performs write operation of a byte to the specified 16-bit address without taking any time.
+*	Plain memory pages are written directly through the memory map. ROM, I/O, OAM, blocked, and unmapped pages are written through their page's handler.
+*/
+void GB_Write_Untimed( GameBoy *gb, uint16_t addr, uint8_t value ) {
+	const struct GB_MemoryPage *page = &( gb->memoryMap[addr >> 8] ); //Memory map entry of the page containing the address
+
+	if ( page->writeMemory ) page->writeMemory[addr & 0xFF] = value;
+	else page->write( gb, addr, value );
+
+	return;
+}//end function GB_Write_Untimed
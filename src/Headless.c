@@ -0,0 +1,224 @@
+#include <SDL.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "EdBoy.h"
+
+/*	Runs the emulated Game Boy system without any windows or SDL subsystems for the given number of frames.
+*	Frames are run back-to-back with no pacing, then throughput statistics are reported to stdout.
+*	The EDBOY_SPEED environment variable, if "1", "2" or "4", instead paces frames at that multiple of the DMG's frame rate, and also reports frame-time jitter.
+*	The EDBOY_PPU environment variable, if "fifo", renders every scanline through the dot-accurate Pixel FIFO.
+*	The EDBOY_TIMING environment variable, if "instruction", runs the interpreter with per-instruction rather than per-access timing.
+*	The EDBOY_JIT environment variable, if "1", enables the x86-64 recompiler, or if "check", also checks every compiled block against the interpreter.
+*	The EDBOY_RUNAHEAD environment variable, if a nonzero number, runs that many frames ahead of each counted frame, as full-speed mode does when displaying.
+*	The EDBOY_REWIND environment variable, if a nonzero number, records rewind history into a buffer of that many megabytes, and reports its size.
+*	The EDBOY_BOOT_CACHE environment variable, if set, names a directory of boot snapshots. The boot ROM is then run, or restored from a snapshot, before any frame is counted.
+*	Returns 0 on success. Otherwise, returns 1 if unable to initialize the system or load the game.
+*/
+int Run_Headless( char *romPath, char *bootromPath, unsigned long frameCount ) {
+	GameBoy gb; //Contains the total state of the emulated Game Boy system
+	uint64_t startTicks; //Performance counter value when the first frame started
+	uint64_t endTicks; //Performance counter value when the last frame finished
+	double seconds; //Host wall-clock time spent running frames
+	double tStates; //Total number of T-States emulated
+	unsigned long framesRun = 0; //Number of frames actually run
+	struct GB_TraceLogger *traceLogger; //Decodes trace records into text on stdout. NULL if not tracing.
+	const char *jitMode; //Value of EDBOY_JIT environment variable
+	const char *ppuMode; //Value of EDBOY_PPU environment variable
+	const char *timingMode; //Value of EDBOY_TIMING environment variable
+	const char *speedText; //Value of EDBOY_SPEED environment variable
+	const char *rewindText; //Value of EDBOY_REWIND environment variable
+	const char *runAheadText; //Value of EDBOY_RUNAHEAD environment variable
+	const char *bootCache; //Value of EDBOY_BOOT_CACHE environment variable
+	unsigned runAhead; //Number of frames run ahead of each counted frame
+	uint8_t *aheadState = NULL; //Snapshot restored after running frames ahead
+	uint8_t aheadFrame[GB_LCD_HEIGHT * GB_LCD_PITCH]; //LCD frame of the last frame run ahead
+	struct FramePacer pacer; //Paces frames, if requested
+
+	//Initialize Game Boy system
+	if ( GB_Init( &gb ) ) {
+		eprintf( "An error occurred during emulated Game Boy system initialization.\n" );
+
+		GB_Deinit( &gb );
+		return 1;
+	}//end if
+
+	//Render through the Pixel FIFO only, if requested
+	ppuMode = getenv( "EDBOY_PPU" );
+	if ( ppuMode && !strcmp( ppuMode, "fifo" ) ) gb.doRenderPerDot = true;
+
+	//Tick once per instruction, if requested
+	timingMode = getenv( "EDBOY_TIMING" );
+	if ( timingMode && !strcmp( timingMode, "instruction" ) ) GB_Set_Timing( &gb, GB_TIMING_PER_INSTRUCTION );
+
+	//Enable recompiler, if requested
+	jitMode = getenv( "EDBOY_JIT" );
+	if ( jitMode && ( !strcmp( jitMode, "1" ) || !strcmp( jitMode, "check" ) ) ) {
+		if ( GB_JIT_Init( &gb, !strcmp( jitMode, "check" ) ) ) eprintf( "Continuing without JIT.\n" );
+	}//end if
+
+	//Load Boot ROM or no-boot ROM alternative setup
+	GB_Load_BootROM( &gb, bootromPath );
+
+	//Load Game
+	if ( GB_Load_Game( &gb, romPath ) ) {
+		eprintf( "An error occurred while loading the game ROM file.\n" );
+
+		GB_Deinit( &gb );
+		return 1;
+	}//end if
+
+	//Boot through snapshot cache, if requested
+	bootCache = getenv( "EDBOY_BOOT_CACHE" );
+	if ( bootCache ) GB_Boot( &gb, bootCache );
+
+	//Record rewind history, if requested
+	rewindText = getenv( "EDBOY_REWIND" );
+	if ( rewindText && strtoul( rewindText, NULL, 10 ) ) {
+		if ( GB_Rewind_Init( &gb, (size_t)strtoul( rewindText, NULL, 10 ) << 20 ) ) eprintf( "Continuing without rewind.\n" );
+	}//end if
+
+	//Run ahead, if requested
+	runAheadText = getenv( "EDBOY_RUNAHEAD" );
+	runAhead = runAheadText ? (unsigned)strtoul( runAheadText, NULL, 10 ) : 0;
+	if ( runAhead ) {
+		aheadState = malloc( GB_State_Size( &gb ) );
+		if ( !aheadState ) {
+			eprintf( "Unable to allocate run-ahead state. Continuing without run-ahead.\n" );
+			runAhead = 0;
+		}//end if
+	}//end if
+
+	//Start decoding trace records, if tracing
+	traceLogger = Start_Trace_Logger( &gb, stdout );
+
+	//Pace frames, if requested
+	speedText = getenv( "EDBOY_SPEED" );
+	Reset_Frame_Pacer_Stats( &pacer );
+	Reset_Frame_Pacer( &pacer, speedText ? (unsigned)strtoul( speedText, NULL, 10 ) : 0 );
+	if ( pacer.speed != 0 && pacer.speed != 1 && pacer.speed != 2 && pacer.speed != 4 ) {
+		eprintf( "Unsupported speed \"%s\". Running unlimited.\n", speedText );
+		Reset_Frame_Pacer( &pacer, 0 );
+	}//end if
+
+	//Run frames in a tight loop, unless paced
+	startTicks = SDL_GetPerformanceCounter();
+	while ( framesRun < frameCount ) {
+		if ( runAhead ? GB_Run_Frame_Ahead( &gb, 0, runAhead, aheadState, aheadFrame ) : GB_Run_Frame( &gb, 0 ) ) break;
+		++framesRun;
+		Pace_Frame( &pacer );
+	}//end while
+	endTicks = SDL_GetPerformanceCounter();
+
+	//Finish decoding trace records before reporting
+	Stop_Trace_Logger( traceLogger );
+
+	//Report throughput
+	seconds = (double)( endTicks - startTicks ) / (double)SDL_GetPerformanceFrequency();
+	tStates = (double)framesRun * ( 1 + runAhead ) * GB_CYCLES_PER_FRAME; //Frames run ahead are emulated too
+	if ( seconds <= 0.0 ) seconds = 1e-9;
+
+	printf( "Ran %lu frames in %.3f s\n", framesRun, seconds );
+	printf( "Frames per second: %.2f\n", framesRun / seconds );
+	printf( "T-States per second: %.0f\n", tStates / seconds );
+	printf( "Real-time multiple: %.2fx\n", ( tStates / GB_CLOCK_RATE ) / seconds );
+	Print_Frame_Pacer_Stats( &pacer, stdout );
+	GB_Rewind_Print_Stats( &gb, stdout );
+
+	//Deinitialize Game Boy system and loaded game
+	free( aheadState );
+	GB_Deinit( &gb );
+
+	return 0;
+}//end function Run_Headless
+
+/* Writes a message logged by a batch instance to stdio, prefixed with the instance's index, which is passed as the user data. */
+static void Log_Batch_Message( void *userData, enum GB_LogLevel level, const char *message ) {
+	fprintf( level == GB_LOG_ERROR ? stderr : stdout, "Instance %u: %s", (unsigned)(uintptr_t)userData, message );
+
+	return;
+}//end function Log_Batch_Message
+
+/*	Runs the given number of independent instances of the emulated Game Boy system, each for the given number of frames, across a pool of worker threads.
+*	Every instance loads the same game, with no buttons pressed, and reports through its own log callback. Aggregate throughput is reported to stdout.
+*	The EDBOY_WORKERS environment variable, if a nonzero number, sets the number of worker threads. Otherwise, one is started per logical CPU.
+*	The EDBOY_PPU environment variable, if "fifo", renders every scanline of every instance through the dot-accurate Pixel FIFO.
+*	The EDBOY_TIMING environment variable, if "instruction", runs every instance with per-instruction rather than per-access timing.
+*	The EDBOY_BOOT_CACHE environment variable, if set, names a directory of boot snapshots. Every instance is then booted before the batch is run,
+*	the first by running the boot ROM if no snapshot is cached, and the rest by restoring the snapshot it saved.
+*	Returns 0 on success. Otherwise, returns 1 if unable to initialize an instance, load the game, or start the workers.
+*/
+int Run_Headless_Batch( char *romPath, char *bootromPath, unsigned instanceCount, unsigned long frameCount ) {
+	struct BatchInstance *instances; //Instances run, each with its own system
+	struct BatchExecutor *batch = NULL; //Runs the instances
+	struct BatchStats stats; //Aggregate throughput of the batch
+	const char *workersText; //Value of EDBOY_WORKERS environment variable
+	const char *ppuMode; //Value of EDBOY_PPU environment variable
+	const char *timingMode; //Value of EDBOY_TIMING environment variable
+	const char *bootCache; //Value of EDBOY_BOOT_CACHE environment variable
+	unsigned quitCount = 0; //Number of instances which quit before running every frame
+	bool didFail = false; //Whether an instance could not be set up, or the batch could not be run
+
+	instances = calloc( instanceCount, sizeof( struct BatchInstance ) );
+	if ( !instances ) {
+		eprintf( "Unable to allocate batch instances.\n" );
+		return 1;
+	}//end if
+
+	//Initialize every instance, load its game, and boot it through the snapshot cache, if requested
+	ppuMode = getenv( "EDBOY_PPU" );
+	timingMode = getenv( "EDBOY_TIMING" );
+	bootCache = getenv( "EDBOY_BOOT_CACHE" );
+	for ( unsigned i = 0; i < instanceCount && !didFail; ++i ) {
+		GameBoy *gb = GB_Create(); //System of instance
+
+		if ( !gb ) {
+			eprintf( "An error occurred during initialization of batch instance %u.\n", i );
+			didFail = true;
+			break;
+		}//end if
+		instances[i].gb = gb;
+		instances[i].frameCount = (unsigned)frameCount;
+
+		gb->callbacks.log = Log_Batch_Message;
+		gb->callbacks.userData = (void *)(uintptr_t)i;
+		if ( ppuMode && !strcmp( ppuMode, "fifo" ) ) gb->doRenderPerDot = true;
+		if ( timingMode && !strcmp( timingMode, "instruction" ) ) GB_Set_Timing( gb, GB_TIMING_PER_INSTRUCTION );
+
+		GB_Load_BootROM( gb, bootromPath );
+		if ( GB_Load_Game( gb, romPath ) ) {
+			eprintf( "An error occurred while loading the game ROM file for batch instance %u.\n", i );
+			didFail = true;
+		}//end if
+		else if ( bootCache ) GB_Boot( gb, bootCache );
+	}//end for
+
+	//Run every instance to completion
+	if ( !didFail ) {
+		workersText = getenv( "EDBOY_WORKERS" );
+		batch = Start_Batch_Executor( workersText ? (unsigned)strtoul( workersText, NULL, 10 ) : 0 );
+		didFail = !batch || Run_Batch( batch, instances, instanceCount, &stats );
+	}//end if
+
+	//Report aggregate throughput
+	if ( !didFail ) {
+		for ( unsigned i = 0; i < instanceCount; ++i )
+			if ( instances[i].didQuit ) ++quitCount;
+
+		printf( "Ran %u instances for %lu frames each in %.3f s\n", instanceCount, frameCount, stats.seconds );
+		printf( "Frames: %llu (%u instances quit early)\n", (unsigned long long)stats.frames, quitCount );
+		printf( "Aggregate frames per second: %.2f\n", stats.framesPerSecond );
+		printf( "Aggregate real-time multiple: %.2fx\n", stats.framesPerSecond * GB_CYCLES_PER_FRAME / GB_CLOCK_RATE );
+		printf( "Tasks: %llu (%llu stolen)\n", (unsigned long long)stats.tasks, (unsigned long long)stats.steals );
+	}//end if
+
+	//Deinitialize every instance
+	Stop_Batch_Executor( batch );
+	for ( unsigned i = 0; i < instanceCount && instances[i].gb; ++i )
+		GB_Destroy( instances[i].gb );
+	free( instances );
+
+	return didFail ? 1 : 0;
+}//end function Run_Headless_Batch
@@ -0,0 +1,122 @@
+#include <SDL.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "EdBoy.h"
+
+/*	Frame pacing. Frames are released on an absolute schedule at the DMG's frame rate (4194304 / 70224 = ~59.7275 Hz) times a speed multiplier.
+*	Each deadline is derived from the last, not from when the last frame was released, so wake-up errors never accumulate into drift.
+*	Waits sleep until shortly before the deadline, then spin for the remainder, as sleeps alone overshoot by up to a scheduler quantum.
+*/
+
+#define PACER_SPIN_MS 2 //Milliseconds before a deadline at which the pacer stops sleeping and starts spinning
+#define PACER_MAX_LAG_FRAMES 4 //Number of frame periods the pacer may fall behind before giving up on catching up and restarting its schedule
+
+/* Restarts the given pacer's schedule from now, at the given speed multiplier. 0 is unlimited. */
+void Reset_Frame_Pacer( struct FramePacer *pacer, unsigned speed ) {
+	uint64_t frequency = SDL_GetPerformanceFrequency(); //Performance counter ticks per second
+
+	pacer->speed = speed;
+	if ( speed ) {
+		//Period is frequency * 70224 / ( 4194304 * speed ) ticks, kept as a whole part plus a fraction of periodDenominator
+		pacer->periodDenominator = (uint64_t)GB_CLOCK_RATE * speed;
+		pacer->periodTicks = frequency * GB_CYCLES_PER_FRAME / pacer->periodDenominator;
+		pacer->periodRemainder = frequency * GB_CYCLES_PER_FRAME % pacer->periodDenominator;
+	}//end if
+
+	pacer->deadline = SDL_GetPerformanceCounter();
+	pacer->deadlineRemainder = 0;
+	pacer->lastRelease = 0;
+
+	dprintf( "Frame pacer set to %ux speed.\n", speed );
+
+	return;
+}//end function Reset_Frame_Pacer
+
+/* Clears the given pacer's jitter counters. */
+void Reset_Frame_Pacer_Stats( struct FramePacer *pacer ) {
+	pacer->stats.frames = 0;
+	pacer->stats.lateFrames = 0;
+	pacer->stats.resyncs = 0;
+	pacer->stats.totalJitter = 0;
+	pacer->stats.maxJitter = 0;
+	pacer->stats.totalBusy = 0;
+	pacer->stats.maxBusy = 0;
+
+	return;
+}//end function Reset_Frame_Pacer_Stats
+
+/*	Waits until the given pacer's next frame is due, then schedules the one after it. Returns immediately at unlimited speed.
+*	Frame-time jitter, the difference between each interval between releases and the frame period, is added to the pacer's counters,
+*	as is the time spent producing the frame since the previous release, which must stay under the period for the speed to be sustained.
+*/
+void Pace_Frame( struct FramePacer *pacer ) {
+	uint64_t frequency; //Performance counter ticks per second
+	uint64_t now; //Current performance counter value
+	uint64_t interval; //Ticks since previous release
+	uint64_t jitter; //Absolute difference between interval and frame period, in ticks
+	uint64_t busy; //Microseconds spent producing the frame since previous release
+
+	if ( !( pacer->speed ) ) return;
+
+	frequency = SDL_GetPerformanceFrequency();
+	pacer->deadline += pacer->periodTicks;
+	pacer->deadlineRemainder += pacer->periodRemainder;
+	if ( pacer->deadlineRemainder >= pacer->periodDenominator ) {
+		pacer->deadlineRemainder -= pacer->periodDenominator;
+		pacer->deadline += 1;
+	}//end if
+
+	now = SDL_GetPerformanceCounter();
+
+	busy = pacer->lastRelease ? ( now - pacer->lastRelease ) * 1000000 / frequency : 0;
+
+	//Too far behind, such as after a stall: start over from now, rather than rushing frames out to catch up
+	if ( now > pacer->deadline + PACER_MAX_LAG_FRAMES * pacer->periodTicks ) {
+		pacer->deadline = now;
+		pacer->deadlineRemainder = 0;
+		pacer->lastRelease = 0;
+		pacer->stats.resyncs += 1;
+		return;
+	}//end if
+
+	if ( now > pacer->deadline ) pacer->stats.lateFrames += 1;
+
+	//Sleep until shortly before the deadline, then spin
+	while ( now < pacer->deadline ) {
+		uint64_t remainingMs = ( pacer->deadline - now ) * 1000 / frequency; //Whole milliseconds until deadline
+
+		if ( remainingMs > PACER_SPIN_MS ) SDL_Delay( (uint32_t)( remainingMs - PACER_SPIN_MS ) );
+		now = SDL_GetPerformanceCounter();
+	}//end while
+
+	//Count jitter and production time against the previous release
+	if ( pacer->lastRelease ) {
+		interval = now - pacer->lastRelease;
+		jitter = interval > pacer->periodTicks ? interval - pacer->periodTicks : pacer->periodTicks - interval;
+
+		pacer->stats.frames += 1;
+		pacer->stats.totalJitter += jitter * 1000000 / frequency;
+		if ( jitter * 1000000 / frequency > pacer->stats.maxJitter ) pacer->stats.maxJitter = jitter * 1000000 / frequency;
+		pacer->stats.totalBusy += busy;
+		if ( busy > pacer->stats.maxBusy ) pacer->stats.maxBusy = busy;
+	}//end if
+	pacer->lastRelease = now;
+
+	return;
+}//end function Pace_Frame
+
+/* Writes a summary of the given pacer's jitter and production time counters to the given stream. Writes nothing if no frames were paced. */
+void Print_Frame_Pacer_Stats( const struct FramePacer *pacer, FILE *out ) {
+	const struct FramePacerStats *stats = &( pacer->stats ); //Counters being summarized
+
+	if ( !( stats->frames ) ) return;
+
+	fprintf( out, "Paced frames: %llu (%llu late, %llu resyncs)\n", (unsigned long long)stats->frames, (unsigned long long)stats->lateFrames, (unsigned long long)stats->resyncs );
+	fprintf( out, "Frame-time jitter: %.1f us mean, %llu us max\n", (double)stats->totalJitter / stats->frames, (unsigned long long)stats->maxJitter );
+	fprintf( out, "Frame production time: %.1f us mean, %llu us max (%.0f%% of period)\n", (double)stats->totalBusy / stats->frames, (unsigned long long)stats->maxBusy,
+		100.0 * stats->totalBusy / stats->frames / ( pacer->periodTicks * 1000000.0 / SDL_GetPerformanceFrequency() ) );
+
+	return;
+}//end function Print_Frame_Pacer_Stats
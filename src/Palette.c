@@ -0,0 +1,137 @@
+#include <SDL.h>
+#include <stdint.h>
+
+#include "EdBoy.h"
+
+/*	Conversion of complete LCD frames from shades into 32-bit display pixels.
+*	Each shade is looked up in a palette built once for the display's pixel format, so converting a frame costs one pass over its shades.
+*	With AVX2, the palette is applied by byte shuffles, 32 pixels at a time. With SSE2, by compare-and-select, 16 pixels at a time.
+*/
+
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#elif defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+
+//Defines the color displayed for each LCD shade, from 0 (white) to 3 (black)
+static const SDL_Color LCD_SHADE_COLORS[4] = {
+	{ 0xFF, 0xFF, 0xFF, 0xFF },
+	{ 0xAA, 0xAA, 0xAA, 0xFF },
+	{ 0x55, 0x55, 0x55, 0xFF },
+	{ 0x00, 0x00, 0x00, 0xFF }
+};
+
+_Static_assert( GB_LCD_WIDTH % 32 == 0, "LCD rows must be a whole number of vectors" );
+
+/*	Builds the given palette for the given SDL pixel format, which must be 32 bits per pixel.
+*	Must be called again only if the display's pixel format changes.
+*	Returns 0 if successful. Else, returns 1 if the pixel format is unsupported.
+*/
+int Build_LCD_Palette( struct LCDPalette *palette, uint32_t format ) {
+	SDL_PixelFormat *pixelFormat = SDL_AllocFormat( format ); //Details of the given pixel format
+
+	if ( !pixelFormat ) return 1;
+	if ( pixelFormat->BytesPerPixel != 4 ) {
+		eprintf( "Unsupported display pixel format %s.\n", SDL_GetPixelFormatName( format ) );
+		SDL_FreeFormat( pixelFormat );
+		return 1;
+	}//end if
+
+	for ( int s = 0; s < 4; ++s ) {
+		const SDL_Color *color = &( LCD_SHADE_COLORS[s] ); //Color of shade
+
+		palette->pixels[s] = SDL_MapRGBA( pixelFormat, color->r, color->g, color->b, color->a );
+
+		//Each byte of the pixel, in memory order, goes in its own shuffle table, repeated in both 128-bit lanes
+		for ( int b = 0; b < 4; ++b ) {
+			uint8_t byte = ( (const uint8_t *)&( palette->pixels[s] ) )[b]; //Byte b of the pixel in memory
+
+			palette->bytes[b][s] = byte;
+			palette->bytes[b][16 + s] = byte;
+		}//end for
+	}//end for
+
+	SDL_FreeFormat( pixelFormat );
+	dprintf( "LCD palette built for %s.\n", SDL_GetPixelFormatName( format ) );
+
+	return 0;
+}//end function Build_LCD_Palette
+
+#if !defined( __AVX2__ ) && defined( __SSE2__ )
+/* Selects the pixels of 4 shades widened to 32 bits, by flipping the bits of shade 0's pixel which differ in each lane's shade's pixel. */
+static inline __m128i Select_Pixels( __m128i shade, __m128i base, __m128i delta1, __m128i delta2, __m128i delta3 ) {
+	__m128i flip1 = _mm_and_si128( _mm_cmpeq_epi32( shade, _mm_set1_epi32( 1 ) ), delta1 ); //Bits flipped in lanes of shade 1
+	__m128i flip2 = _mm_and_si128( _mm_cmpeq_epi32( shade, _mm_set1_epi32( 2 ) ), delta2 ); //Bits flipped in lanes of shade 2
+	__m128i flip3 = _mm_and_si128( _mm_cmpeq_epi32( shade, _mm_set1_epi32( 3 ) ), delta3 ); //Bits flipped in lanes of shade 3
+
+	return _mm_xor_si128( _mm_xor_si128( base, flip1 ), _mm_xor_si128( flip2, flip3 ) );
+}//end function Select_Pixels
+#endif
+
+/* Converts the given number of shades, a whole number of vectors, into pixels through the given palette. */
+static void Convert_Shades( const struct LCDPalette *palette, const uint8_t *shades, uint32_t *out, int count ) {
+#if defined( __AVX2__ )
+	__m256i table0 = _mm256_load_si256( (const __m256i *)( palette->bytes[0] ) ); //Shuffle table of pixel byte 0
+	__m256i table1 = _mm256_load_si256( (const __m256i *)( palette->bytes[1] ) ); //Shuffle table of pixel byte 1
+	__m256i table2 = _mm256_load_si256( (const __m256i *)( palette->bytes[2] ) ); //Shuffle table of pixel byte 2
+	__m256i table3 = _mm256_load_si256( (const __m256i *)( palette->bytes[3] ) ); //Shuffle table of pixel byte 3
+
+	for ( int x = 0; x < count; x += 32 ) {
+		__m256i shade = _mm256_loadu_si256( (const __m256i *)( shades + x ) ); //Shades of 32 pixels
+		__m256i b0 = _mm256_shuffle_epi8( table0, shade ); //Byte 0 of 32 pixels
+		__m256i b1 = _mm256_shuffle_epi8( table1, shade ); //Byte 1 of 32 pixels
+		__m256i b2 = _mm256_shuffle_epi8( table2, shade ); //Byte 2 of 32 pixels
+		__m256i b3 = _mm256_shuffle_epi8( table3, shade ); //Byte 3 of 32 pixels
+		__m256i lo01 = _mm256_unpacklo_epi8( b0, b1 ), hi01 = _mm256_unpackhi_epi8( b0, b1 ); //Bytes 0-1 of pixels 0-7 and 16-23, 8-15 and 24-31
+		__m256i lo23 = _mm256_unpacklo_epi8( b2, b3 ), hi23 = _mm256_unpackhi_epi8( b2, b3 ); //Bytes 2-3 of pixels 0-7 and 16-23, 8-15 and 24-31
+		__m256i p0 = _mm256_unpacklo_epi16( lo01, lo23 ); //Pixels 0-3 and 16-19
+		__m256i p1 = _mm256_unpackhi_epi16( lo01, lo23 ); //Pixels 4-7 and 20-23
+		__m256i p2 = _mm256_unpacklo_epi16( hi01, hi23 ); //Pixels 8-11 and 24-27
+		__m256i p3 = _mm256_unpackhi_epi16( hi01, hi23 ); //Pixels 12-15 and 28-31
+
+		//Gather each lane's pixels back into order
+		_mm256_storeu_si256( (__m256i *)( out + x ), _mm256_permute2x128_si256( p0, p1, 0x20 ) );
+		_mm256_storeu_si256( (__m256i *)( out + x + 8 ), _mm256_permute2x128_si256( p2, p3, 0x20 ) );
+		_mm256_storeu_si256( (__m256i *)( out + x + 16 ), _mm256_permute2x128_si256( p0, p1, 0x31 ) );
+		_mm256_storeu_si256( (__m256i *)( out + x + 24 ), _mm256_permute2x128_si256( p2, p3, 0x31 ) );
+	}//end for
+#elif defined( __SSE2__ )
+	__m128i base = _mm_set1_epi32( (int)palette->pixels[0] ); //Pixel for shade 0
+	__m128i delta1 = _mm_set1_epi32( (int)( palette->pixels[1] ^ palette->pixels[0] ) ); //Bits differing between shade 1's and shade 0's pixels
+	__m128i delta2 = _mm_set1_epi32( (int)( palette->pixels[2] ^ palette->pixels[0] ) ); //Bits differing between shade 2's and shade 0's pixels
+	__m128i delta3 = _mm_set1_epi32( (int)( palette->pixels[3] ^ palette->pixels[0] ) ); //Bits differing between shade 3's and shade 0's pixels
+	__m128i zero = _mm_setzero_si128();
+
+	for ( int x = 0; x < count; x += 16 ) {
+		__m128i shade = _mm_loadu_si128( (const __m128i *)( shades + x ) ); //Shades of 16 pixels
+		__m128i lo = _mm_unpacklo_epi8( shade, zero ); //Shades of pixels 0-7, widened to 16 bits
+		__m128i hi = _mm_unpackhi_epi8( shade, zero ); //Shades of pixels 8-15, widened to 16 bits
+
+		_mm_storeu_si128( (__m128i *)( out + x ), Select_Pixels( _mm_unpacklo_epi16( lo, zero ), base, delta1, delta2, delta3 ) );
+		_mm_storeu_si128( (__m128i *)( out + x + 4 ), Select_Pixels( _mm_unpackhi_epi16( lo, zero ), base, delta1, delta2, delta3 ) );
+		_mm_storeu_si128( (__m128i *)( out + x + 8 ), Select_Pixels( _mm_unpacklo_epi16( hi, zero ), base, delta1, delta2, delta3 ) );
+		_mm_storeu_si128( (__m128i *)( out + x + 12 ), Select_Pixels( _mm_unpackhi_epi16( hi, zero ), base, delta1, delta2, delta3 ) );
+	}//end for
+#else
+	for ( int x = 0; x < count; ++x )
+		out[x] = palette->pixels[shades[x] & 3];
+#endif
+
+	return;
+}//end function Convert_Shades
+
+/*	Converts the given complete LCD frame of shades into 32-bit pixels through the given palette.
+*	Pixels are written in rows of the given pitch in bytes. If rows are packed on both sides, the whole frame is converted as one run.
+*/
+void Convert_LCD_Frame( const struct LCDPalette *palette, const uint8_t *frame, void *pixels, int pitch ) {
+	if ( GB_LCD_PITCH == GB_LCD_WIDTH && pitch == GB_LCD_WIDTH * 4 ) {
+		Convert_Shades( palette, frame, pixels, GB_LCD_WIDTH * GB_LCD_HEIGHT );
+		return;
+	}//end if
+
+	for ( int y = 0; y < GB_LCD_HEIGHT; ++y )
+		Convert_Shades( palette, frame + y * GB_LCD_PITCH, (uint32_t *)( (uint8_t *)pixels + y * pitch ), GB_LCD_WIDTH );
+
+	return;
+}//end function Convert_LCD_Frame
@@ -4,15 +4,15 @@
 
 #include "EdBoy.h"
 
-/*	Does frame-stepping mode logic.
+/*	Does frame-stepping mode input logic.
 *	Handles toggling frame-stepped emulator input for the next frame.
-*	Runs emulated Game Boy system for one frame upon pressing the frame-advance key.
-*	Returns true if termination requested prematurely mid-frame. Otherwise, returns false.
+*	Requests one frame be run, with the toggled buttons pressed, upon pressing the frame-advance key.
+*	The resulting input snapshot is written to input.
 */
-bool Do_FrameStep_Frame( GameBoy *gb, const uint8_t *keyStates, bool *isPressed, bool *justPressed, bool *faJustPressed ) {
+void Get_FrameStep_Input( const uint8_t *keyStates, bool *isPressed, bool *justPressed, bool *faJustPressed, struct EmulatorInput *input ) {
 
 	//Update frame-step control toggles
-	for ( int i = GB_UP; i < GB_SELECT; ++i ) {
+	for ( int i = GB_UP; i <= GB_SELECT; ++i ) {
 		if ( keyStates[CTRL_SCANCODES[i]] ) {
 
 			if ( !justPressed[i] ) {
@@ -26,68 +26,62 @@ bool Do_FrameStep_Frame( GameBoy *gb, const uint8_t *keyStates, bool *isPressed,
 		else justPressed[i] = false;
 	}//end for
 
-	//If frame-advance button pressed, do frame
+	input->buttons = 0;
+	for ( int i = GB_UP; i <= GB_SELECT; ++i )
+		if ( isPressed[i] ) input->buttons |= 1 << i;
+	input->isFrameStep = true;
+	input->doAdvance = false;
+	input->isAdvanceHeld = keyStates[CTRL_FRAMESTEP_ADVANCE];
+	input->speed = 0;
+	input->isRewinding = false;
+	input->runAhead = 0;
+
+	//If frame-advance button pressed, request frame
 	if ( keyStates[CTRL_FRAMESTEP_ADVANCE] ) {
 		if ( !*faJustPressed ) {
-			dprintf( "\nDoing frame-stepped frame:\n" );
-			if ( GB_Run_Frame( gb, isPressed ) ) return true;
+			input->doAdvance = true;
 			*faJustPressed = true;
 		}//end if
 	}//end if
 	else *faJustPressed = false;
 
-	return false;
-}//end function Do_FrameStep_Frame
+	return;
+}//end function Get_FrameStep_Input
 
-/*	Does full-speed mode logic.
-*	Handles setting emulator input for the next frame.
-*	Runs emulated Game Boy system for one frame, then delays execution to ensure proper emulation speed.
-*	Returns true if termination requested prematurely mid-frame. Otherwise, returns false.
+/*	Does full-speed mode input logic.
+*	Handles setting emulator input for the next frame, from the buttons currently held, selecting the speed frames are paced at,
+*	cycling the number of frames run ahead, and rewinding.
+*	The speed and run-ahead frame count are kept in speed and runAhead between calls. The resulting input snapshot is written to input.
 */
-bool Do_FullSpeed_Frame( GameBoy *gb, const uint8_t *keyStates ) {
-	bool isPressed[8]; //Stores whether a given key is pressed corresponding to a given button on the emulated Game Boy for the next frame
+void Get_FullSpeed_Input( const uint8_t *keyStates, uint8_t *speed, uint8_t *runAhead, bool *raJustPressed, struct EmulatorInput *input ) {
 
-	//Get input for next frame
-	for ( int i = GB_UP; i < GB_SELECT; ++i )
-		isPressed[i] = keyStates[CTRL_SCANCODES[i]];
-
-	//Do frame
-	dprintf( "Doing full-speed frame.\n" );
-	if( GB_Run_Frame( gb, isPressed ) ) return true;
-
-	return false;
-}//end function Do_FullSpeed_Frame
-
-/*	Pauses mid-frame and waits for the frame-advance key to be pressed.
-*	Does not accept other input, including closing the application windows.
-*	Meant for temporary testing only.
-*	Returns true if request was made to abort program via closing window mid-pause. Otherwise, returns false.
-*/
-bool Pause_On_Unknown_Opcode() {
-	SDL_Event tempEvent; //Temporary pause event handler
-	const uint8_t *currKeyStates; //Current keyboard key states during pause
-	bool didContinue = false; //Set to true when user wants to continue executing frame
-	bool alreadyPressing = false; //Whether the frame-advance key is already being pressed. Prevents premature advancing
-
-	//Check status of frame-advance key
-	currKeyStates = SDL_GetKeyboardState( NULL );
-	if ( currKeyStates[CTRL_FRAMESTEP_ADVANCE] ) alreadyPressing = true;
+	//Select speed
+	if ( keyStates[CTRL_SPEED_1X] ) *speed = 1;
+	else if ( keyStates[CTRL_SPEED_2X] ) *speed = 2;
+	else if ( keyStates[CTRL_SPEED_4X] ) *speed = 4;
+	else if ( keyStates[CTRL_SPEED_UNLIMITED] ) *speed = 0;
 
-	//Loop with no logging until told to break
-	while ( !didContinue ) {
+	//Cycle run-ahead frame count
+	if ( keyStates[CTRL_RUNAHEAD] ) {
+		if ( !*raJustPressed ) {
+			*runAhead = *runAhead < RUNAHEAD_MAX_FRAMES ? *runAhead + 1 : 0;
+			*raJustPressed = true;
 
-		//Poll for quit events until event queue is empty or told to quit mid-pause
-		while ( SDL_PollEvent( &tempEvent ) )
-			if ( tempEvent.type == SDL_WINDOWEVENT && tempEvent.window.event == SDL_WINDOWEVENT_CLOSE )
-				return true;
-
-		//Get state of keyboard
-		currKeyStates = SDL_GetKeyboardState( NULL );
-
-		//Update alreadyPressing if no longer pressing frame-advance key, and otherwise check if is now pressing frame-advance key
-		if ( currKeyStates[CTRL_FRAMESTEP_ADVANCE] && !alreadyPressing ) didContinue = true;
-		else if ( !currKeyStates[CTRL_FRAMESTEP_ADVANCE] && alreadyPressing ) alreadyPressing = false;
-	}//end while
+			dprintf( "Running %d frames ahead\n", *runAhead );
+		}//end if
+	}//end if
+	else *raJustPressed = false;
 
-	return false;
-}//end function Pause_On_Unknown_Opcode
\ No newline at end of file
+	//Get input for next frame
+	input->buttons = 0;
+	for ( int i = GB_UP; i <= GB_SELECT; ++i )
+		if ( keyStates[CTRL_SCANCODES[i]] ) input->buttons |= 1 << i;
+	input->isFrameStep = false;
+	input->doAdvance = false;
+	input->isAdvanceHeld = keyStates[CTRL_FRAMESTEP_ADVANCE];
+	input->speed = *speed;
+	input->isRewinding = keyStates[CTRL_REWIND];
+	input->runAhead = *runAhead;
+
+	return;
+}//end function Get_FullSpeed_Input
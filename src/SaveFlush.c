@@ -0,0 +1,108 @@
+#include <SDL.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "EdBoy.h"
+
+//Defines the state of a background thread periodically writing back an emulated system's save file
+struct SaveFlusher {
+	const GameBoy *gb; //System whose save file is written back
+	SDL_Thread *thread; //Flusher thread
+	SDL_atomic_t isStopping; //Set to 1 when the flusher should exit
+};
+
+/* Writes back the save file every SAVE_FLUSH_INTERVAL milliseconds, checking for a stop request in between. The emulation thread never waits on it. */
+static int Save_Flusher_Thread( void *data ) {
+	struct SaveFlusher *flusher = data; //Flusher being run
+	unsigned waited = 0; //Milliseconds waited since last write back
+
+	while ( !SDL_AtomicGet( &( flusher->isStopping ) ) ) {
+		SDL_Delay( EVENT_WAIT_TIMEOUT );
+		waited += EVENT_WAIT_TIMEOUT;
+
+		if ( waited >= SAVE_FLUSH_INTERVAL ) {
+			GB_Flush_Save( flusher->gb );
+			waited = 0;
+		}//end if
+	}//end while
+
+	return 0;
+}//end function Save_Flusher_Thread
+
+/*	Attaches the given system's battery-backed external RAM, if any, to the save file beside the given ROM file: its path with the extension replaced by ".sav".
+*	Returns 0 if successful, or if the cartridge has no battery. Else, returns 1 if unable, in which case the game runs without saving.
+*/
+int Attach_Save_File( GameBoy *gb, const char *romPath ) {
+	size_t stemLength = strlen( romPath ); //Length of ROM path without its extension
+	char *savePath; //Path of save file
+	int result; //Result of attaching save file
+
+	if ( !( gb->cart.hasBattery ) ) return 0;
+
+	for ( size_t i = stemLength; i > 0 && romPath[i - 1] != '/' && romPath[i - 1] != '\\'; --i ) {
+		if ( romPath[i - 1] == '.' ) {
+			stemLength = i - 1;
+			break;
+		}//end if
+	}//end for
+
+	savePath = malloc( stemLength + sizeof( ".sav" ) );
+	if ( !savePath ) {
+		eprintf( "Unable to allocate save file path.\n" );
+		return 1;
+	}//end if
+	memcpy( savePath, romPath, stemLength );
+	strcpy( savePath + stemLength, ".sav" );
+
+	result = GB_Attach_Save( gb, savePath );
+	if ( result ) eprintf( "Unable to use save file \"%s\". Continuing without saving.\n", savePath );
+	else dprintf( "Saving to \"%s\".\n", savePath );
+
+	free( savePath );
+
+	return result;
+}//end function Attach_Save_File
+
+/*	Starts a background thread which writes back the given system's attached save file every SAVE_FLUSH_INTERVAL milliseconds,
+*	so at most that much saving is lost if the host goes down. Where the save file is mapped, saving survives the emulator itself crashing regardless.
+*	Returns the flusher, or NULL if the cartridge has no battery or the thread could not be started.
+*/
+struct SaveFlusher *Start_Save_Flusher( const GameBoy *gb ) {
+	struct SaveFlusher *flusher; //New flusher
+
+	if ( !( gb->cart.hasBattery ) ) return NULL;
+
+	flusher = malloc( sizeof( struct SaveFlusher ) );
+	if ( !flusher ) {
+		eprintf( "Unable to allocate save flusher.\n" );
+		return NULL;
+	}//end if
+
+	flusher->gb = gb;
+	SDL_AtomicSet( &( flusher->isStopping ), 0 );
+
+	flusher->thread = SDL_CreateThread( Save_Flusher_Thread, "EdBoy Save Flusher", flusher );
+	if ( !( flusher->thread ) ) {
+		eprintf( "Unable to start save flusher thread: %s\n", SDL_GetError() );
+
+		free( flusher );
+		return NULL;
+	}//end if
+
+	dprintf( "Save flusher started.\n" );
+
+	return flusher;
+}//end function Start_Save_Flusher
+
+/* Stops the given save flusher, then frees it. The save file is written back once more when the game is unloaded. Must be called before the system is deinitialized. */
+void Stop_Save_Flusher( struct SaveFlusher *flusher ) {
+	if ( !flusher ) return;
+
+	SDL_AtomicSet( &( flusher->isStopping ), 1 );
+	SDL_WaitThread( flusher->thread, NULL );
+	free( flusher );
+
+	return;
+}//end function Stop_Save_Flusher
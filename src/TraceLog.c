@@ -0,0 +1,91 @@
+#include <SDL.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "EdBoy.h"
+
+#define TRACE_LOGGER_BATCH 256 //Maximum number of records decoded per drain of the trace buffer
+
+//Defines the state of a background thread decoding an emulated system's trace records into text
+struct GB_TraceLogger {
+	struct GB_Trace *trace; //Trace ring buffer being consumed
+	FILE *out; //Stream decoded text is written to
+	SDL_Thread *thread; //Logger thread
+	SDL_atomic_t isStopping; //Set to 1 when the logger should drain remaining records and exit
+};
+
+/* Repeatedly drains the trace buffer and writes each record as a line of text, sleeping briefly whenever the buffer is empty. */
+static int Trace_Logger_Thread( void *data ) {
+	struct GB_TraceLogger *logger = data; //Logger being run
+	struct GB_TraceRecord records[TRACE_LOGGER_BATCH]; //Records drained from the trace buffer
+	char line[128]; //Decoded text of one record
+	size_t count; //Number of records drained
+
+	while ( true ) {
+		bool isStopping = SDL_AtomicGet( &( logger->isStopping ) ); //Checked before draining, so no records written before stopping are missed
+
+		count = GB_Trace_Drain( logger->trace, records, TRACE_LOGGER_BATCH );
+		for ( size_t i = 0; i < count; ++i ) {
+			GB_Trace_Format( &( records[i] ), line, sizeof( line ) );
+			fputs( line, logger->out );
+			fputc( '\n', logger->out );
+		}//end for
+
+		if ( count == 0 ) {
+			if ( isStopping ) break;
+			SDL_Delay( 1 );
+		}//end if
+	}//end while
+
+	fflush( logger->out );
+
+	return 0;
+}//end function Trace_Logger_Thread
+
+/*	Starts a background thread which decodes the given system's trace records into text on the given stream.
+*	The EDBOY_TRACE_MASK environment variable, if set, replaces the system's trace category mask (hexadecimal, bits indexed by GB_TraceKind).
+*	Returns the logger, or NULL if the system has no trace buffer or the thread could not be started.
+*/
+struct GB_TraceLogger *Start_Trace_Logger( GameBoy *gb, FILE *out ) {
+	struct GB_TraceLogger *logger; //New logger
+	const char *maskText; //Value of EDBOY_TRACE_MASK environment variable
+
+	if ( !( gb->trace ) ) return NULL;
+
+	maskText = getenv( "EDBOY_TRACE_MASK" );
+	if ( maskText ) gb->trace->mask = (uint32_t)strtoul( maskText, NULL, 16 );
+
+	logger = malloc( sizeof( struct GB_TraceLogger ) );
+	if ( !logger ) {
+		eprintf( "Unable to allocate trace logger.\n" );
+		return NULL;
+	}//end if
+
+	logger->trace = gb->trace;
+	logger->out = out;
+	SDL_AtomicSet( &( logger->isStopping ), 0 );
+
+	logger->thread = SDL_CreateThread( Trace_Logger_Thread, "EdBoy Trace Logger", logger );
+	if ( !( logger->thread ) ) {
+		eprintf( "Unable to start trace logger thread: %s\n", SDL_GetError() );
+
+		free( logger );
+		return NULL;
+	}//end if
+
+	dprintf( "Trace logger started.\n" );
+
+	return logger;
+}//end function Start_Trace_Logger
+
+/* Stops the given trace logger after it has decoded all remaining records, then frees it. Must be called before the traced system is deinitialized. */
+void Stop_Trace_Logger( struct GB_TraceLogger *logger ) {
+	if ( !logger ) return;
+
+	SDL_AtomicSet( &( logger->isStopping ), 1 );
+	SDL_WaitThread( logger->thread, NULL );
+	free( logger );
+
+	return;
+}//end function Stop_Trace_Logger
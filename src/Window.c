@@ -59,4 +59,72 @@ void Deinit_Emulator_Windows( SDL_Window **windows ) {
 	}//end if
 
 	return;
-}//end function DeinitEmuWindows
\ No newline at end of file
+}//end function DeinitEmuWindows
+
+/*	Creates the renderer and streaming texture used to present the emulated LCD in the given window.
+*	Returns 0 on successful full initialization. Otherwise, returns 1 on error.
+*/
+int Init_Emulator_Screen( SDL_Window *window, struct EmulatorScreen *screen ) {
+	screen->renderer = NULL;
+	screen->texture = NULL;
+
+	screen->renderer = SDL_CreateRenderer( window, -1, 0 );
+	if ( screen->renderer == NULL ) {
+		eprintf( "Renderer could not be created.\n" );
+		return 1;
+	}//end if
+
+	screen->texture = SDL_CreateTexture(
+		screen->renderer,
+		SDL_PIXELFORMAT_ARGB8888,
+		SDL_TEXTUREACCESS_STREAMING,
+		GB_LCD_WIDTH,
+		GB_LCD_HEIGHT
+	);
+
+	if ( screen->texture == NULL ) {
+		eprintf( "LCD texture could not be created.\n" );
+		return 1;
+	}//end if
+
+	if ( Build_LCD_Palette( &( screen->palette ), SDL_PIXELFORMAT_ARGB8888 ) ) {
+		eprintf( "LCD palette could not be built.\n" );
+		return 1;
+	}//end if
+
+	dprintf( "Emulator screen created.\n" );
+
+	return 0;
+}//end function Init_Emulator_Screen
+
+/*	Destroys the renderer and texture used to present the emulated LCD, if created.	*/
+void Deinit_Emulator_Screen( struct EmulatorScreen *screen ) {
+	if ( screen->texture != NULL ) SDL_DestroyTexture( screen->texture );
+	if ( screen->renderer != NULL ) SDL_DestroyRenderer( screen->renderer );
+
+	screen->texture = NULL;
+	screen->renderer = NULL;
+	dprintf( "Emulator screen destroyed.\n" );
+
+	return;
+}//end function Deinit_Emulator_Screen
+
+/*	Presents the given complete LCD frame of shades in the emulator window.
+*	The frame is converted straight into the locked texture memory, so it is read once and never copied through an intermediate surface.
+*/
+void Present_Emulator_Screen( struct EmulatorScreen *screen, const uint8_t *frame ) {
+	void *pixels; //Locked texture memory
+	int pitch; //Bytes between the starts of consecutive rows of locked texture memory
+
+	if ( SDL_LockTexture( screen->texture, NULL, &pixels, &pitch ) ) {
+		eprintf( "Unable to lock LCD texture: %s\n", SDL_GetError() );
+		return;
+	}//end if
+
+	Convert_LCD_Frame( &( screen->palette ), frame, pixels, pitch );
+	SDL_UnlockTexture( screen->texture );
+	SDL_RenderCopy( screen->renderer, screen->texture, NULL, NULL );
+	SDL_RenderPresent( screen->renderer );
+
+	return;
+}//end function Present_Emulator_Screen